@@ -8,6 +8,12 @@ struct ExperimentConfig{
   bool useSimdHash = false;
   bool useSimdSel = false;
   bool useSimdProj = false;
+  bool useDictionaries = false;
+  bool useZoneMaps = false;
+  bool useJoinFilters = false;
+  /// Whether the queries apply their order by and limit, the benchmarks
+  /// skip them by default
+  bool useOrderBy = false;
   vectorwise::primitives::F2 hash_int32_t_col();
   vectorwise::primitives::F3 hash_sel_int32_t_col();
   vectorwise::primitives::F2 rehash_int32_t_col();
@@ -29,6 +29,7 @@ struct Q11Builder : public vectorwise::QueryBuilder {
           types::Numeric<18, 2>::castString("3.00");
       types::Integer quantity_max = types::Integer(25);
       int64_t aggregator = 0;
+      std::unique_ptr<runtime::BlockFilter> blocks;
       std::unique_ptr<vectorwise::Operator> rootOp;
    };
    Q11Builder(runtime::Database& db, vectorwise::SharedStateManager& shared,
@@ -37,6 +38,8 @@ struct Q11Builder : public vectorwise::QueryBuilder {
    std::unique_ptr<Q11> getQuery();
 };
 
+/// lineorder blocks which may contain tuples qualifying for q1.1
+runtime::BlockFilter q11_blocks(runtime::Database& db);
 std::unique_ptr<runtime::Query>
 q11_hyper(runtime::Database& db,
           size_t nrThreads = std::thread::hardware_concurrency());
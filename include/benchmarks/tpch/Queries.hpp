@@ -13,6 +13,7 @@
 struct Q1Builder : public Query, private vectorwise::QueryBuilder {
    enum {
       sel_date,
+      bm_date,
       sel_date_grouped,
       selScat,
       result_proj_minus,
@@ -69,6 +70,7 @@ struct Q3Builder : private vectorwise::QueryBuilder {
       std::string building = "BUILDING";
       types::Char<10> c1 =
           types::Char<10>::castString(building.data(), building.size());
+      int8_t c1_code = -1;
       types::Date c2 = types::Date::castString("1995-03-15");
       types::Date c3 = types::Date::castString("1995-03-15");
       types::Numeric<12, 2> one = types::Numeric<12, 2>::castString("1.00");
@@ -176,8 +178,11 @@ class Q6Builder : public vectorwise::QueryBuilder {
       types::Numeric<12, 2> c3 = types::Numeric<12, 2>::castString("0.05");
       types::Numeric<12, 2> c4 = types::Numeric<12, 2>::castString("0.07");
       types::Numeric<12, 2> c5 = types::Numeric<12, 2>(types::Integer(24));
+      /// c3, c4 and c5 in the narrow representation of their attribute
+      int64_t n3, n4, n5;
       size_t n;
       int64_t aggregator = 0;
+      std::unique_ptr<runtime::BlockFilter> blocks;
       std::unique_ptr<vectorwise::Operator> rootOp;
    };
 
@@ -187,6 +192,8 @@ class Q6Builder : public vectorwise::QueryBuilder {
        : QueryBuilder(db, shared, size) {}
 };
 
+/// lineitem blocks which may contain tuples qualifying for q6
+runtime::BlockFilter q6_blocks(runtime::Database& db);
 runtime::Relation
 q6_hyper(runtime::Database& db,
          size_t nrThreads = std::thread::hardware_concurrency());
@@ -0,0 +1,85 @@
+#pragma once
+#include "common/runtime/Cpu.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <immintrin.h>
+
+namespace runtime {
+
+/// Values are packed in chunks of packChunkSize values, so every chunk starts
+/// at a byte boundary and chunks can be packed in parallel
+static const size_t packChunkSize = 64;
+
+/// Number of bits needed to store values in [0, range]
+inline unsigned bitsFor(uint64_t range) {
+   unsigned bits = 1;
+   while (bits < 64 && (range >> bits)) bits++;
+   return bits;
+}
+
+/// Bytes needed for n packed values with bits bits, including the padding
+/// read by unpack behind the last value
+inline size_t packedSize(size_t n, unsigned bits) {
+   return (n + packChunkSize - 1) / packChunkSize * bits * 8 + 8;
+}
+
+/// Packs the frame of reference deltas in[i] - base of n <= packChunkSize
+/// values with bits bits each to out, which receives 8 * bits bytes
+inline void packChunk(const int32_t* in, size_t n, int32_t base,
+                      unsigned bits, uint8_t* out) {
+   uint64_t words[33] = {};
+   for (size_t i = 0; i < n; i++) {
+      uint64_t delta = uint64_t(int64_t(in[i]) - base);
+      size_t pos = i * bits;
+      words[pos / 64] |= delta << (pos % 64);
+      if (pos % 64 + bits > 64) words[pos / 64 + 1] |= delta >> (64 - pos % 64);
+   }
+   memcpy(out, words, 8 * bits);
+}
+
+/// Unpacks the first n - n % 4 values like unpack with AVX2, four values per
+/// step: gathers the 64 bit words containing them
+SIMD_AVX2 inline size_t unpackAvx2(const uint8_t* in, size_t begin, size_t n,
+                                   unsigned bits, int32_t base, int32_t* out) {
+   const uint64_t mask = (uint64_t(1) << bits) - 1;
+   uint64_t pos = begin * bits;
+   const __m256i vmask = _mm256_set1_epi64x(mask);
+   const __m256i seven = _mm256_set1_epi64x(7);
+   const __m256i step = _mm256_set1_epi64x(4 * bits);
+   const __m256i narrow = _mm256_setr_epi32(0, 2, 4, 6, 0, 2, 4, 6);
+   const __m128i vbase = _mm_set1_epi32(base);
+   __m256i vpos =
+       _mm256_add_epi64(_mm256_set1_epi64x(pos),
+                        _mm256_setr_epi64x(0, bits, 2 * bits, 3 * bits));
+   size_t i = 0;
+   for (; i + 4 <= n; i += 4) {
+      auto words =
+          _mm256_i64gather_epi64(reinterpret_cast<const long long*>(in),
+                                 _mm256_srli_epi64(vpos, 3), 1);
+      auto values = _mm256_and_si256(
+          _mm256_srlv_epi64(words, _mm256_and_si256(vpos, seven)), vmask);
+      auto packed = _mm256_castsi256_si128(
+          _mm256_permutevar8x32_epi32(values, narrow));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i),
+                       _mm_add_epi32(packed, vbase));
+      vpos = _mm256_add_epi64(vpos, step);
+   }
+   return i;
+}
+
+/// Unpacks the n values starting at value begin from in to out, bits <= 32
+inline void unpack(const uint8_t* in, size_t begin, size_t n, unsigned bits,
+                   int32_t base, int32_t* out) {
+   const uint64_t mask = (uint64_t(1) << bits) - 1;
+   size_t i = 0;
+   if (cpu::isa() >= cpu::Isa::AVX2)
+      i = unpackAvx2(in, begin, n, bits, base, out);
+   uint64_t pos = (begin + i) * bits;
+   for (; i < n; i++, pos += bits) {
+      uint64_t word;
+      memcpy(&word, in + pos / 8, sizeof(word));
+      out[i] = base + int32_t((word >> (pos % 8)) & mask);
+   }
+}
+} // namespace runtime
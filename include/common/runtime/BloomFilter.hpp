@@ -0,0 +1,69 @@
+#pragma once
+#include "common/defs.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace runtime {
+
+class BloomFilter
+/// Cache line blocked Bloom filter over the hashes of the build side of a
+/// join. Every hash sets bitsPerHash bits within a single cache line, so a
+/// lookup costs at most one cache miss. Probes which are not contained are
+/// rejected before they touch the hashtable.
+{
+ public:
+   using hash_t = defs::hash_t;
+   static constexpr unsigned bitsPerHash = 3;
+   /// Filter bits per inserted hash, for a false positive rate of about 1%
+   static constexpr size_t bitsPerEntry = 16;
+
+ private:
+   struct alignas(64) Block {
+      uint64_t words[8];
+   };
+   std::unique_ptr<Block[]> blocks;
+   size_t nrBlocks = 0;
+   /// Number of blocks is 1 << blockBits
+   unsigned blockBits = 0;
+
+   /// Block of hash, taken from the high bits of a multiplicative remix, so
+   /// that it does not correlate with the hashtable slot of the hash
+   Block& block(hash_t hash) const {
+      auto mixed = uint64_t(hash) * 0x9e3779b97f4a7c15ull;
+      // two shifts, as shifting by 64 for a single block is undefined
+      return blocks[(mixed >> 1) >> (63 - blockBits)];
+   }
+
+ public:
+   /// Sizes the filter for n hashes and clears it
+   void setSize(size_t n) {
+      blockBits = 0;
+      while ((size_t(512) << blockBits) < n * bitsPerEntry) blockBits++;
+      nrBlocks = size_t(1) << blockBits;
+      blocks.reset(new Block[nrBlocks]());
+   }
+   /// Whether the filter was sized, an unsized filter contains everything
+   bool active() const { return nrBlocks; }
+   /// Adds hash, may be called concurrently
+   void insert(hash_t hash) {
+      auto& b = block(hash);
+      for (unsigned i = 0; i < bitsPerHash; i++) {
+         auto bit = (hash >> (9 * i)) & 511;
+         __atomic_fetch_or(&b.words[bit / 64], uint64_t(1) << (bit % 64),
+                           __ATOMIC_RELAXED);
+      }
+   }
+   /// False if hash was certainly not inserted
+   bool contains(hash_t hash) const {
+      if (!nrBlocks) return true;
+      auto& b = block(hash);
+      bool found = true;
+      for (unsigned i = 0; i < bitsPerHash; i++) {
+         auto bit = (hash >> (9 * i)) & 511;
+         found &= (b.words[bit / 64] >> (bit % 64)) & 1;
+      }
+      return found;
+   }
+};
+} // namespace runtime
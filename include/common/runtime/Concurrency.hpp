@@ -55,6 +55,18 @@ class Worker
    std::function<void()> function;
 };
 
+class WorkerScope
+/// Restores the worker of the calling thread at the end of the scope, also
+/// when an exception leaves it
+{
+   Worker* previous;
+
+ public:
+   WorkerScope() : previous(this_worker) {}
+   WorkerScope(const WorkerScope&) = delete;
+   ~WorkerScope() { this_worker = previous; }
+};
+
 class WorkerGroup
 /// Group of worker threads which work on the same task, share a barrier etc.
 {
@@ -0,0 +1,68 @@
+#pragma once
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+/// A (member) function with SIMD_AVX2 or SIMD_AVX512 is compiled for that
+/// instruction set, independent of -march. It may only run if
+/// runtime::cpu::isa() permits it. AVX-512 code may call AVX2 code. Lambdas
+/// do not inherit the attribute, so intrinsics belong into named functions.
+#define SIMD_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt,fma")))
+#define SIMD_AVX512                                                            \
+   __attribute__((target("avx2,bmi,bmi2,popcnt,fma,avx512f,avx512dq,"         \
+                         "avx512vl,avx512bw,avx512cd")))
+
+namespace runtime {
+namespace cpu {
+
+/// Instruction sets of the SIMD primitives, ordered by capability
+enum class Isa { Scalar, AVX2, AVX512 };
+
+inline const char* name(Isa isa) {
+   switch (isa) {
+   case Isa::AVX512: return "avx512";
+   case Isa::AVX2: return "avx2";
+   default: return "scalar";
+   }
+}
+
+/// Best instruction set the cpu supports, detected with cpuid
+inline Isa detected() {
+   __builtin_cpu_init();
+   if (__builtin_cpu_supports("avx512f") &&
+       __builtin_cpu_supports("avx512dq") &&
+       __builtin_cpu_supports("avx512vl") &&
+       __builtin_cpu_supports("avx512bw") &&
+       __builtin_cpu_supports("avx512cd"))
+      return Isa::AVX512;
+   if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("bmi2") &&
+       __builtin_cpu_supports("fma"))
+      return Isa::AVX2;
+   return Isa::Scalar;
+}
+
+/// Instruction set the SIMD primitives are dispatched to, decided once at
+/// startup. The environment variable simdIsa (scalar, avx2, avx512) can
+/// lower it below the detected one, e.g. to compare the implementations.
+inline Isa isa() {
+   static const Isa selected = [] {
+      auto best = detected();
+      if (auto v = std::getenv("simdIsa"))
+         for (auto requested : {Isa::Scalar, Isa::AVX2, Isa::AVX512})
+            if (!std::strcmp(v, name(requested)))
+               return std::min(best, requested);
+      return best;
+   }();
+   return selected;
+}
+
+/// The variant of a primitive for isa()
+template <typename F> F dispatch(F avx512, F avx2, F scalar) {
+   switch (isa()) {
+   case Isa::AVX512: return avx512;
+   case Isa::AVX2: return avx2;
+   default: return scalar;
+   }
+}
+} // namespace cpu
+} // namespace runtime
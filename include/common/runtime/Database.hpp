@@ -1,10 +1,16 @@
 #pragma once
 #include "common/algebra/Types.hpp"
+#include "common/runtime/BitPacking.hpp"
 #include "common/runtime/MemoryPool.hpp"
 #include "common/runtime/Mmap.hpp"
+#include "common/runtime/String.hpp"
 #include "common/runtime/Util.hpp"
+#include <algorithm>
 #include <deque>
 #include <exception>
+#include <functional>
+#include <initializer_list>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -15,6 +21,184 @@ using algebra::Type;
 
 namespace runtime {
 
+class Dictionary
+/// Dictionary encoding of a fixed size string attribute. The distinct values
+/// are sorted, so the codes preserve the order of the values.
+{
+ public:
+   runtime::Vector<void*> values_;
+   runtime::Vector<void*> codes_;
+   /// int8_t codes for up to 128 values, int16_t otherwise
+   size_t codeSize;
+
+   /// codes of all tuples of the attribute
+   void* codes() { return codes_.data(); }
+   template <typename C> C* codes() {
+      assert(sizeof(C) == codeSize);
+      return reinterpret_cast<C*>(codes_.data());
+   }
+   template <typename T> const runtime::Vector<T>& values() {
+      return typedValuesForChange<T>();
+   }
+   template <typename T> runtime::Vector<T>& typedValuesForChange() {
+#pragma GCC diagnostic ignored "-Wstrict-aliasing"
+      return reinterpret_cast<runtime::Vector<T>&>(values_);
+#pragma GCC diagnostic pop
+   }
+   template <typename C> runtime::Vector<C>& typedCodesForChange() {
+#pragma GCC diagnostic ignored "-Wstrict-aliasing"
+      return reinterpret_cast<runtime::Vector<C>&>(codes_);
+#pragma GCC diagnostic pop
+   }
+   /// Code of value, -1 if the value does not occur
+   template <typename T> int16_t code(const T& value) {
+      auto& v = values<T>();
+      auto it = std::lower_bound(v.begin(), v.end(), value);
+      return (it != v.end() && *it == value) ? it - v.begin() : -1;
+   }
+   /// Smallest code with a value not less than value, for range predicates
+   template <typename T> int16_t lowerBound(const T& value) {
+      auto& v = values<T>();
+      return std::lower_bound(v.begin(), v.end(), value) - v.begin();
+   }
+};
+
+class PackedColumn
+/// Frame of reference and bit packing encoding of a 32 bit integer
+/// attribute. The data starts with the base and the number of bits,
+/// followed by the packed deltas.
+{
+ public:
+   runtime::Vector<uint8_t> data_;
+
+   int32_t base() const { return reinterpret_cast<int32_t*>(data_.data())[0]; }
+   unsigned bits() const {
+      return reinterpret_cast<uint32_t*>(data_.data())[1];
+   }
+   const uint8_t* packed() const { return data_.data() + 8; }
+   /// Bytes used by the encoded attribute
+   size_t memory() const { return data_.size(); }
+   /// Unpacks the n values starting at tuple begin to out
+   void unpack(size_t begin, size_t n, int32_t* out) const {
+      runtime::unpack(packed(), begin, n, bits(), base(), out);
+   }
+};
+
+class StringColumn
+/// Variable length encoding of a Varchar attribute. The strings are stored
+/// back to back in a heap, tuple i spans [offsets[i], offsets[i + 1]).
+{
+ public:
+   runtime::Vector<uint64_t> offsets_;
+   runtime::Vector<char> heap_;
+
+   const char* data(size_t i) const { return heap_.data() + offsets_[i]; }
+   uint32_t size(size_t i) const { return offsets_[i + 1] - offsets_[i]; }
+   /// View of tuple i, which keeps short strings and a prefix of long strings
+   /// inline. Views are built on access, the mapped offsets and heap are the
+   /// only resident data.
+   SmallStringView view(size_t i) const {
+      return SmallStringView(data(i), size(i));
+   }
+   /// Bytes used by the offsets and the heap
+   size_t memory() const {
+      return offsets_.size() * sizeof(uint64_t) + heap_.size();
+   }
+};
+
+class ZoneMap
+/// Minimum and maximum value of every block of blockSize consecutive tuples
+/// of an attribute
+{
+ public:
+   static constexpr size_t blockSize = 16384;
+   /// (min, max) pairs, one per block
+   runtime::Vector<void*> bounds_;
+
+   size_t nrBlocks() const { return bounds_.size(); }
+   template <typename T> const std::pair<T, T>* bounds() {
+      return typedBoundsForChange<T>().data();
+   }
+   template <typename T>
+   runtime::Vector<std::pair<T, T>>& typedBoundsForChange() {
+#pragma GCC diagnostic ignored "-Wstrict-aliasing"
+      return reinterpret_cast<runtime::Vector<std::pair<T, T>>&>(bounds_);
+#pragma GCC diagnostic pop
+   }
+};
+
+class ColumnStatistics
+/// Import time statistics of an attribute: number of values, estimated number
+/// of distinct values and, for numbers and dates, the value range and an
+/// equi-depth histogram. Values are compared by their int64_t key.
+{
+ public:
+   static constexpr size_t histogramBuckets = 64;
+   enum Slot { Min, Max, Count, Distinct, Buckets };
+   /// Slots of the statistics followed by the largest value of every bucket,
+   /// each bucket holds count / histogramBuckets values
+   static constexpr size_t size = Buckets + histogramBuckets;
+   runtime::Vector<int64_t> data_;
+
+   int64_t min() const { return data_.data()[Min]; }
+   int64_t max() const { return data_.data()[Max]; }
+   /// Number of values, attributes have no NULLs
+   size_t count() const { return data_.data()[Count]; }
+   /// HyperLogLog estimate of the number of distinct values
+   size_t distinct() const { return data_.data()[Distinct]; }
+   const int64_t* buckets() const { return data_.data() + Buckets; }
+   template <typename T> static int64_t key(const T& value) {
+      return value.value;
+   }
+   /// Estimated number of values in [lower, upper], assuming the values are
+   /// uniformly distributed within each bucket
+   double estimate(int64_t lower, int64_t upper) const {
+      double found = 0;
+      auto perBucket = double(count()) / histogramBuckets;
+      auto bucketMin = min();
+      for (size_t b = 0; b < histogramBuckets; b++) {
+         auto bucketMax = buckets()[b];
+         auto from = std::max(lower, bucketMin), to = std::min(upper, bucketMax);
+         if (from <= to)
+            found += perBucket * (double(to) - from + 1) /
+                     (double(bucketMax) - bucketMin + 1);
+         bucketMin = bucketMax;
+      }
+      return std::min(found, double(count()));
+   }
+};
+
+class NarrowColumn
+/// Narrow physical representation of an integer, decimal or date attribute,
+/// chosen from its statistics: the values minus a base with 1, 2 or 4 bytes
+/// each. The data starts with the base and the width, followed by the values.
+{
+ public:
+   static constexpr size_t headerSize = 16;
+   runtime::Vector<uint8_t> data_;
+
+   int64_t base() const { return reinterpret_cast<int64_t*>(data_.data())[0]; }
+   /// Bytes per value
+   unsigned width() const {
+      return reinterpret_cast<uint64_t*>(data_.data())[1];
+   }
+   void* values() const { return data_.data() + headerSize; }
+   template <typename N> const N* values() const {
+      assert(sizeof(N) == width());
+      return reinterpret_cast<const N*>(values());
+   }
+   /// Bytes used by the encoded attribute
+   size_t memory() const { return data_.size(); }
+   /// value in the narrow representation, for comparisons with the narrow
+   /// values. Values outside of the range of N saturate: the stored values
+   /// stay strictly within it, so the comparisons keep their result.
+   template <typename N, typename T> N narrow(const T& value) const {
+      auto key = ColumnStatistics::key(value) - base();
+      key = std::max<int64_t>(key, std::numeric_limits<N>::min());
+      return std::min<int64_t>(key, std::numeric_limits<N>::max());
+   }
+};
+
 class Attribute {
  public:
    // Attribute() = default;
@@ -24,6 +208,13 @@ class Attribute {
    runtime::Vector<void*> data_;
    std::string name;
    std::unique_ptr<Type> type;
+   /// codes of the values if the importer dictionary encoded the attribute
+   std::unique_ptr<Dictionary> dictionary;
+   std::unique_ptr<ZoneMap> zoneMap;
+   std::unique_ptr<PackedColumn> packed;
+   std::unique_ptr<StringColumn> strings;
+   std::unique_ptr<ColumnStatistics> statistics;
+   std::unique_ptr<NarrowColumn> narrow;
 
    template <typename T> T* data() { return typedAccess<T>().data(); }
    void* data() { return data_.data(); }
@@ -54,8 +245,129 @@ struct Relation {
    std::unordered_map<std::string, Attribute> attributes;
    std::string name;
    size_t nrTuples;
+   /// Tuples [nodeBounds[i], nodeBounds[i + 1]) are placed on NUMA node i,
+   /// empty if the importer did not place the relation
+   std::vector<size_t> nodeBounds;
+   /// Attribute the tuples are sorted by, empty if they are in .tbl order
+   std::string sortKey;
    Attribute& operator[](std::string key);
    Attribute& insert(std::string name, std::unique_ptr<Type> t);
+   /// Moves the columns into anonymous memory which is split into one
+   /// partition per NUMA node, see nodeBounds. The columns of the attributes
+   /// selected by hugePages are backed by huge pages.
+   void placeOnNodes(const std::function<bool(const std::string&)>& hugePages);
+   /// Estimated number of distinct values of attribute attr, nrTuples if the
+   /// importer did not collect statistics for it
+   size_t distinct(const std::string& attr) {
+      auto& stats = (*this)[attr].statistics;
+      return stats ? std::min(stats->distinct(), nrTuples) : nrTuples;
+   }
+   /// Estimated number of tuples with values of attribute attr in
+   /// [lower, upper], nrTuples without statistics
+   template <typename T>
+   size_t estimate(const std::string& attr, const T& lower, const T& upper) {
+      auto& stats = (*this)[attr].statistics;
+      if (!stats) return nrTuples;
+      return stats->estimate(ColumnStatistics::key(lower),
+                             ColumnStatistics::key(upper));
+   }
+   /// Tuples [first, second) which may have values of attribute attr in
+   /// [lower, upper]: found by binary search if the relation is sorted by
+   /// attr, all tuples otherwise
+   template <typename T>
+   std::pair<size_t, size_t> sortedRange(const std::string& attr,
+                                         const T& lower, const T& upper) {
+      if (attr != sortKey) return {0, nrTuples};
+      auto values = (*this)[attr].data<T>();
+      auto begin = std::lower_bound(values, values + nrTuples, lower);
+      auto end = std::upper_bound(begin, values + nrTuples, upper);
+      return {begin - values, end - values};
+   }
+   /// Whether the tuples are ordered by attribute attr, because the
+   /// importer sorted them by it or they were generated in its order. Reads
+   /// the column unless attr is the sort key.
+   template <typename T> bool orderedBy(const std::string& attr) {
+      if (attr == sortKey) return true;
+      auto values = (*this)[attr].data<T>();
+      return std::is_sorted(values, values + nrTuples);
+   }
+
+ private:
+   friend class Database;
+   /// Appends n tuples, given as an array of n values for every attribute.
+   /// The tuples are kept in memory behind the imported ones, so scans see
+   /// them right away, until mergeDelta writes them to the cached columns.
+   /// Drops the encodings of the attributes, which no longer cover all tuples,
+   /// and places a relation which was placed on NUMA nodes again.
+   void append(const std::unordered_map<std::string, const void*>& values,
+               size_t n);
+};
+
+class BlockFilter
+/// Zone map blocks of a relation which may contain tuples satisfying the
+/// range predicates added with restrict
+{
+   std::vector<uint8_t> candidates;
+   /// Tuples which may qualify at all, see restrictRows
+   size_t firstRow = 0;
+   size_t nrTuples;
+
+ public:
+   BlockFilter(Relation& rel)
+       : candidates((rel.nrTuples + ZoneMap::blockSize - 1) /
+                        ZoneMap::blockSize,
+                    true),
+         nrTuples(rel.nrTuples) {}
+   /// Drops all tuples outside of [begin, end), e.g. the slice of a sorted
+   /// relation found by Relation::sortedRange
+   BlockFilter& restrictRows(size_t begin, size_t end) {
+      firstRow = std::max(firstRow, begin);
+      nrTuples = std::max(firstRow, std::min(nrTuples, end));
+      for (size_t b = 0; b < candidates.size(); b++)
+         if ((b + 1) * ZoneMap::blockSize <= firstRow ||
+             b * ZoneMap::blockSize >= nrTuples)
+            candidates[b] = false;
+      return *this;
+   }
+   /// First tuple which may qualify
+   size_t rowsBegin() const { return firstRow; }
+   /// Behind the last tuple which may qualify
+   size_t rowsEnd() const { return nrTuples; }
+   /// Drops all blocks without values of attr in [lower, upper], a no-op for
+   /// attributes without zone map
+   template <typename T>
+   BlockFilter& restrict(Attribute& attr, const T& lower, const T& upper) {
+      if (!attr.zoneMap) return *this;
+      auto bounds = attr.zoneMap->bounds<T>();
+      for (size_t b = 0; b < candidates.size(); b++)
+         if (upper < bounds[b].first || bounds[b].second < lower)
+            candidates[b] = false;
+      return *this;
+   }
+   size_t nrBlocks() const { return candidates.size(); }
+   bool candidate(size_t block) const { return candidates[block]; }
+   /// First tuple of block
+   size_t begin(size_t block) const {
+      return std::max(firstRow, block * ZoneMap::blockSize);
+   }
+   /// Behind the last tuple of block
+   size_t end(size_t block) const {
+      return std::min(nrTuples, (block + 1) * ZoneMap::blockSize);
+   }
+   /// Whether any of the tuples in [begin, end) may qualify
+   bool mayMatch(size_t begin, size_t end) const {
+      begin = std::max(begin, firstRow);
+      end = std::min(end, nrTuples);
+      if (begin >= end) return false;
+      for (auto b = begin / ZoneMap::blockSize;
+           b < candidates.size() && b * ZoneMap::blockSize < end; b++)
+         if (candidates[b]) return true;
+      return false;
+   }
+   /// Number of blocks that are skipped
+   size_t skipped() const {
+      return std::count(candidates.begin(), candidates.end(), false);
+   }
 };
 
 class BlockRelation {
@@ -172,16 +484,58 @@ inline BlockRelation::Attribute BlockRelation::getAttribute(std::string name) {
    return attrIter->second;
 }
 
+class KeyIndex
+/// Dense index from the integer keys of a relation to their row ids. Row
+/// ids are 32 bit if the relation fits.
+{
+ public:
+   runtime::Vector<void*> rows_;
+   size_t rowIdSize = sizeof(uint64_t);
+   /// Relation and integer key attribute the index is built over
+   std::string relation, key;
+
+   /// Number of keys, i.e. the maximum key + 1
+   size_t size() const { return rows_.size(); }
+   /// Row id of the tuple with key
+   size_t operator[](size_t key) const {
+      if (rowIdSize == sizeof(uint32_t))
+         return reinterpret_cast<uint32_t*>(rows_.data())[key];
+      return reinterpret_cast<uint64_t*>(rows_.data())[key];
+   }
+   template <typename R> runtime::Vector<R>& typedRowsForChange() {
+#pragma GCC diagnostic ignored "-Wstrict-aliasing"
+      return reinterpret_cast<runtime::Vector<R>&>(rows_);
+#pragma GCC diagnostic pop
+   }
+};
+
 class Database {
    std::unordered_map<std::string, Relation> relations;
    std::unordered_map<std::string, std::vector<size_t>> indexes;
+   std::unordered_map<std::string, KeyIndex> keyIndexes;
 
  public:
+   /// How warmUp loads the columns of a query after the OS caches were
+   /// dropped: Advise starts asynchronous readahead, Populate faults the
+   /// pages in with all threads before the query runs
+   enum class WarmUpMode { Off, Advise, Populate };
+   WarmUpMode warmUpMode = WarmUpMode::Off;
+
    Database() = default;
    Database(Database&&) = default;
    Database(const Database&) = delete;
    Relation& operator[](std::string key);
    std::vector<size_t>& getindex(std::string key);
+   KeyIndex& getKeyIndex(std::string key);
    bool hasRelation(std::string name);
+   /// Appends n tuples to relation, see Relation::append, and adds them to
+   /// the key indexes over it
+   void append(std::string relation,
+               const std::unordered_map<std::string, const void*>& values,
+               size_t n);
+   /// Loads the columns of relation which a query is about to scan
+   /// according to warmUpMode
+   void warmUp(std::string relation,
+               std::initializer_list<std::string> columns);
 };
 } // namespace runtime
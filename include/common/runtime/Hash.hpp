@@ -223,9 +223,7 @@ class MurMurHash : public Hash<MurMurHash> {
       return h;
    }
 
-  //#ifdef __AVX512F__
-#ifdef __AVX512DQ__
-   inline Vec8u hashKey(Vec8u k, Vec8u seed) const {
+   SIMD_AVX512 inline Vec8u hashKey(Vec8u k, Vec8u seed) const {
       // MurmurHash64A
       const Vec8u m(0xc6a4a7935bd1e995);
       const Vec8u r(47);
@@ -240,7 +238,21 @@ class MurMurHash : public Hash<MurMurHash> {
       h = h ^ (h >> r);
       return h;
    }
-#endif
+   SIMD_AVX2 inline Vec4u hashKey(Vec4u k, Vec4u seed) const {
+      // MurmurHash64A
+      const Vec4u m(0xc6a4a7935bd1e995);
+      const unsigned r = 47;
+      Vec4u h = seed ^ Vec4u(0x8445d61a4e774912 ^ (8 * 0xc6a4a7935bd1e995));
+      k = k * m;
+      k = k ^ (k >> r);
+      k = k * m;
+      h = h ^ k;
+      h = h * m;
+      h = h ^ (h >> r);
+      h = h * m;
+      h = h ^ (h >> r);
+      return h;
+   }
 
 };
 
@@ -266,8 +278,7 @@ FORCE_INLINE uint32_t fmix32 ( uint32_t h ) {
     h ^= h >> 16;
     return h;
 }
-#ifdef __AVX512F__
-FORCE_INLINE Vec16u fmix32 ( Vec16u h ) {
+SIMD_AVX512 FORCE_INLINE Vec16u fmix32 ( Vec16u h ) {
     h = h ^ (h >> 16);
     h = h * Vec16u(0x85ebca6b);
     h = h ^ (h >> 13);
@@ -275,7 +286,6 @@ FORCE_INLINE Vec16u fmix32 ( Vec16u h ) {
     h = h ^ (h >> 16);
     return h;
 }
-#endif
 FORCE_INLINE uint32_t getblock32 ( const uint32_t * p, int i ) {
     return p[i];
 }
@@ -397,10 +407,7 @@ class MurMurHash3 : public Hash<MurMurHash3> {
      return h1;
    }
 
-#ifdef __AVX512F__
-
-  //#ifdef __AVX512DQ__
-   inline Vec16u hashKey(Vec16u k, Vec16u seed) const {
+   SIMD_AVX512 inline Vec16u hashKey(Vec16u k, Vec16u seed) const {
      auto h1 = seed;
      Vec16u c1(0xcc9e2d51);
      Vec16u c2(0x1b873593);
@@ -418,7 +425,6 @@ class MurMurHash3 : public Hash<MurMurHash3> {
 
      return fmix32(h1);
    }
-#endif
 
 };
 
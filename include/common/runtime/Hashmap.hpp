@@ -3,6 +3,7 @@
 #include "common/runtime/Memory.hpp"
 #include "common/runtime/SIMD.hpp"
 #include "common/runtime/Stack.hpp"
+#include <algorithm>
 #include <assert.h>
 #include <atomic>
 #include <cassert>
@@ -10,10 +11,59 @@
 #include <cstdint>
 #include <deque>
 #include <memory>
+#include <unistd.h>
 #include <vector>
 
 namespace runtime {
 
+namespace grouping {
+/// Size of the pre-aggregation tables without an estimate of the groups
+static const size_t defaultGroups = 1024;
+/// Pre-aggregation tables stay cache resident up to this many groups
+static const size_t maxPreAggGroups = 16 * 1024;
+/// Groups per spill partition, so that a partition aggregates in cache
+static const size_t partitionGroups = 16 * 1024;
+
+/// Size of the thread local pre-aggregation tables for about groups groups,
+/// with headroom for underestimates
+inline size_t preAggSize(size_t groups) {
+   return std::max(size_t(64), std::min(2 * groups, maxPreAggGroups));
+}
+/// Number of spill partitions for about groups groups and the given number
+/// of workers
+inline size_t partitions(size_t groups, size_t workers) {
+   return std::max(workers * 4, groups / partitionGroups);
+}
+} // namespace grouping
+
+namespace partitioning {
+/// Bytes of hashtable slots and entries per partition of a radix partitioned
+/// join, so that a partition stays resident in the L2 cache
+static const size_t partitionBytes = 256 * 1024;
+/// Radix bits per partitioning pass, more partitions would thrash the TLB
+static const unsigned maxPassBits = 8;
+
+/// Size of the last level cache, build sides up to it are not partitioned
+inline size_t cacheBytes() {
+   static const size_t bytes = [] {
+      long l3 = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+      // glibc only, other platforms take the default
+      l3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+#endif
+      return l3 > 0 ? size_t(l3) : size_t(8) << 20;
+   }();
+   return bytes;
+}
+/// Number of radix bits which split a build side of bytes bytes into
+/// partitions of at most partitionBytes, up to two passes
+inline unsigned radixBits(size_t bytes) {
+   unsigned bits = 0;
+   while (bits < 2 * maxPassBits && (bytes >> bits) > partitionBytes) bits++;
+   return bits;
+}
+} // namespace partitioning
+
 class Hashmap {
 
  public:
@@ -34,7 +84,8 @@ class Hashmap {
    /// Uses pointer tagging as a filter to quickly determine whether hash is
    /// contained
    inline EntryHeader* find_chain_tagged(hash_t hash);
-   inline Vec8uM find_chain_tagged(Vec8u hashes);
+   SIMD_AVX512 inline Vec8uM find_chain_tagged(Vec8u hashes);
+   SIMD_AVX2 inline Vec4uM find_chain_tagged(Vec4u hashes);
    /// Insert entry into chain for the given hash
    template <bool concurrentInsert = true>
    inline void insert(EntryHeader* entry, hash_t hash);
@@ -68,7 +119,8 @@ class Hashmap {
  private:
    inline Hashmap::EntryHeader* ptr(Hashmap::EntryHeader* p);
    inline ptr_t tag(hash_t p);
-   inline Vec8u tag(Vec8u p);
+   SIMD_AVX512 inline Vec8u tag(Vec8u p);
+   SIMD_AVX2 inline Vec4u tag(Vec4u p);
    inline Hashmap::EntryHeader* update(Hashmap::EntryHeader* old,
                                        Hashmap::EntryHeader* p, hash_t hash);
 };
@@ -87,11 +139,16 @@ inline Hashmap::ptr_t Hashmap::tag(Hashmap::hash_t hash) {
    return ((size_t)1) << (tagPos + (sizeof(ptr_t) * 8 - 16));
 }
 
-inline Vec8u Hashmap::tag(Vec8u hashes) {
+SIMD_AVX512 inline Vec8u Hashmap::tag(Vec8u hashes) {
    auto tagPos = hashes >> (sizeof(hash_t) * 8 - 4);
    return Vec8u(1) << (tagPos + Vec8u(sizeof(ptr_t) * 8 - 16));
 }
 
+SIMD_AVX2 inline Vec4u Hashmap::tag(Vec4u hashes) {
+   auto tagPos = hashes >> (sizeof(hash_t) * 8 - 4);
+   return Vec4u(1) << (tagPos + Vec4u(sizeof(ptr_t) * 8 - 16));
+}
+
 inline Hashmap::EntryHeader* Hashmap::ptr(Hashmap::EntryHeader* p) {
    return (EntryHeader*)((ptr_t)p & maskPointer);
 }
@@ -141,7 +198,7 @@ inline Hashmap::EntryHeader* Hashmap::find_chain_tagged(hash_t hash) {
       return end();
 }
 
-inline Vec8uM Hashmap::find_chain_tagged(Vec8u hashes) {
+SIMD_AVX512 inline Vec8uM Hashmap::find_chain_tagged(Vec8u hashes) {
    auto pos = hashes & Vec8u(mask);
    Vec8u candidates = _mm512_i64gather_epi64(pos, (const long long int*)entries, 8);
    Vec8u filterMatch = candidates & tag(hashes);
@@ -150,6 +207,17 @@ inline Vec8uM Hashmap::find_chain_tagged(Vec8u hashes) {
    return {candidates, matches};
 }
 
+SIMD_AVX2 inline Vec4uM Hashmap::find_chain_tagged(Vec4u hashes) {
+   auto pos = hashes & Vec4u(mask);
+   Vec4u candidates =
+       _mm256_i64gather_epi64((const long long int*)entries, pos, 8);
+   Vec4u filterMatch = candidates & tag(hashes);
+   auto noMatch = _mm256_cmpeq_epi64(filterMatch, _mm256_setzero_si256());
+   auto matches = _mm256_xor_si256(noMatch, _mm256_set1_epi64x(-1));
+   candidates = candidates & Vec4u(maskPointer);
+   return {candidates, matches};
+}
+
 template <bool concurrentInsert>
 void inline Hashmap::insert_tagged(EntryHeader* entry, hash_t hash) {
    const size_t pos = hash & mask;
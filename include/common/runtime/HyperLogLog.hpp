@@ -0,0 +1,62 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace runtime {
+
+class HyperLogLog
+/// Sketch of the number of distinct values of a multiset. Values are added as
+/// uniformly distributed 64 bit hashes, sketches of disjoint parts can be
+/// merged. The standard error of the estimate is about 1.6%.
+{
+ public:
+   static constexpr unsigned precision = 12;
+   static constexpr size_t nrRegisters = size_t(1) << precision;
+
+ private:
+   /// Maximum rank (position of the first 1 bit) per register
+   std::array<uint8_t, nrRegisters> registers;
+
+ public:
+   HyperLogLog() { registers.fill(0); }
+
+   /// Spreads the bits of key over the hash, for keys which are not hashes
+   /// already
+   static uint64_t hash(uint64_t key) {
+      // finalizer of MurmurHash3
+      key ^= key >> 33;
+      key *= 0xff51afd7ed558ccdull;
+      key ^= key >> 33;
+      key *= 0xc4ceb9fe1a85ec53ull;
+      key ^= key >> 33;
+      return key;
+   }
+   void add(uint64_t hash) {
+      auto& r = registers[hash >> (64 - precision)];
+      auto rest = hash << precision;
+      uint8_t rank = rest ? __builtin_clzll(rest) + 1 : 64 - precision + 1;
+      r = std::max(r, rank);
+   }
+   void merge(const HyperLogLog& other) {
+      for (size_t i = 0; i < nrRegisters; i++)
+         registers[i] = std::max(registers[i], other.registers[i]);
+   }
+   /// Estimated number of distinct values added
+   uint64_t estimate() const {
+      double sum = 0;
+      size_t zeros = 0;
+      for (auto r : registers) {
+         sum += std::ldexp(1.0, -r);
+         zeros += r == 0;
+      }
+      const double m = nrRegisters;
+      double e = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+      // linear counting is more precise for small cardinalities
+      if (e <= 2.5 * m && zeros) e = m * std::log(m / zeros);
+      return uint64_t(e + 0.5);
+   }
+};
+} // namespace runtime
@@ -1,11 +1,29 @@
 #pragma once
 #include "Database.hpp"
+#include <future>
 #include <string>
+#include <vector>
 
 namespace runtime {
-   /// imports tpch relations from CSVs in dir into db
-   void importTPCH(std::string dir, Database& db);
+   /// Loading time of a table or index build, reported by the imports
+   struct TableLoad {
+      std::string name;
+      double time;
+      /// Bytes of cached columns and encodings mapped
+      size_t bytesMapped;
+      /// Bytes of the .tbl file parsed, 0 if all columns were cached
+      size_t bytesParsed;
+   };
+
+   /// imports tpch relations from CSVs in dir into db. The tables are loaded
+   /// concurrently, the indexes once the tables they read are loaded.
+   std::vector<TableLoad> importTPCH(std::string dir, Database& db);
 
    /// imports star schema benchmark from CSVs in dir into db
-   void importSSB(std::string dir, Database& db);
+   std::vector<TableLoad> importSSB(std::string dir, Database& db);
+
+   /// Writes the tuples appended to rel into its cached columns in the
+   /// background, so that the next import maps them. Appends to rel have to
+   /// wait for the returned future.
+   std::future<void> mergeDelta(Relation& rel);
 }
@@ -38,8 +38,9 @@ class GlobalPool {
 };
 
 class Allocator {
-   size_t allocSize =
-       1024 * 1024 * 2; // start with a multiple of the huge page size
+   // start with a multiple of the huge page size
+   static constexpr size_t initialAllocSize = 1024 * 1024 * 2;
+   size_t allocSize = initialAllocSize;
    uint8_t* start = nullptr;
    size_t free = 0;
 
@@ -5,6 +5,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -138,47 +139,232 @@ class Vector {
   uint64_t count;
   T* data_ = nullptr;
   size_t dataSize;
+  size_t headerSize = 0;
   int fd;
   bool persistent;
+  /// Bytes mapped at header(), including the room for appended elements
+  size_t mappedLength = 0;
+  /// Number of elements there is room for
+  size_t capacity = 0;
+  /// File the elements were read from and how many of them are still
+  /// mapped from it, the others are in anonymous memory
+  std::string path_;
+  size_t fileElements = 0;
+  /// Whether the elements were moved to memory backed by huge pages
+  bool hugePages_ = false;
 
- public:
-  Vector() : count(0), data_(nullptr), persistent(false) {}
-  Vector(const char* pathname) : count(0), data_(nullptr), persistent(true) {
-    readBinary(pathname);
+  /// Maps at least length bytes of anonymous memory backed by 2 MiB pages:
+  /// from the hugetlbfs pool if pages are reserved there, transparent huge
+  /// pages otherwise. length is rounded up to whole huge pages.
+  static uint8_t* mapHuge(size_t& length) {
+    const size_t huge = 2 * 1024 * 1024;
+    length = (length + huge - 1) / huge * huge;
+#ifdef MAP_HUGETLB
+    auto pool = mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                     MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (pool != MAP_FAILED) return reinterpret_cast<uint8_t*>(pool);
+#endif
+    // align to a huge page, so that all of it can be backed by huge pages
+    auto raw = reinterpret_cast<uint8_t*>(
+        mmap(nullptr, length + huge, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    check(raw != MAP_FAILED);
+    auto aligned = raw + (huge - reinterpret_cast<uintptr_t>(raw) % huge) % huge;
+    if (aligned != raw) check(munmap(raw, aligned - raw) == 0);
+    check(munmap(aligned + length, raw + huge - aligned) == 0);
+#ifdef MADV_HUGEPAGE
+    madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+    return aligned;
   }
-  Vector(Vector&&) = default;
-  Vector(const Vector&) = delete;
-  ~Vector() noexcept(false) {
+  void release() {
     if (data_) {
       if (persistent) {
-        check(munmap(data_, count * dataSize) == 0);
+        check(munmap(header(), mappedLength) == 0);
       } else {
         free(data_);
       }
       data_ = nullptr;
     }
+    hugePages_ = false;
+  }
+  /// Moves the elements to memory with room for n elements of elementSize
+  void grow(size_t n, size_t elementSize) {
+    if (!persistent) {
+      auto bytes = (n * elementSize + 15) / 16 * 16;
+      auto data = compat::aligned_alloc(16, bytes);
+      if (data_) memcpy(data, data_, count * elementSize);
+      free(data_);
+      data_ = reinterpret_cast<T*>(data);
+      capacity = n;
+      return;
+    }
+    auto page = size_t(sysconf(_SC_PAGESIZE));
+    auto length = (headerSize + n * elementSize + page - 1) / page * page;
+    uint8_t* memory;
+    if (hugePages_) {
+      // moved to anonymous memory before, there is no file part to map
+      memory = mapHuge(length);
+    } else {
+      memory = reinterpret_cast<uint8_t*>(
+          mmap(nullptr, length, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      check(memory != MAP_FAILED);
+    }
+    size_t copied = 0;
+    if (fileElements) {
+      // map the file part again, private and writable so that the elements
+      // appended to its last page are not written back
+      fd = open(path_.c_str(), O_RDONLY);
+      check(fd != -1);
+      auto file = mmap(memory, headerSize + fileElements * elementSize,
+                       PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0);
+      check(file == memory);
+      check(close(fd) == 0);
+      copied = fileElements;
+    } else if (data_) {
+      memcpy(memory, header(), headerSize);
+    }
+    memcpy(memory + headerSize + copied * elementSize,
+           reinterpret_cast<uint8_t*>(data_) + copied * elementSize,
+           (count - copied) * elementSize);
+    if (mappedLength) check(munmap(header(), mappedLength) == 0);
+    data_ = reinterpret_cast<T*>(memory + headerSize);
+    mappedLength = length;
+    capacity = n;
   }
 
+ public:
+  Vector() : count(0), data_(nullptr), persistent(false) {}
+  Vector(const char* pathname) : count(0), data_(nullptr), persistent(true) {
+    readBinary(pathname);
+  }
+  Vector(Vector&&) = default;
+  Vector(const Vector&) = delete;
+  ~Vector() noexcept(false) { release(); }
+
   static void writeBinary(const char* pathname, std::vector<T>& v);
-  void readBinary(const char* pathname) {
+  /// Creates pathname with room for a header of headerBytes followed by n
+  /// elements and maps it writable, so that the file can be filled in place.
+  /// The mapping is released on destruction.
+  void createBinary(const char* pathname, size_t n, size_t headerBytes = 0) {
+    assert(!data_);
+    fd = open(pathname, O_RDWR | O_CREAT | O_TRUNC,
+              S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+    check(fd != -1);
+    count = n;
+    dataSize = sizeof(T);
+    headerSize = headerBytes;
+    persistent = true;
+    size_t length = headerSize + n * sizeof(T);
+    mappedLength = length;
+    capacity = n;
+    if (length) {
+      check(compat::posix_fallocate(fd, 0, length) == 0);
+      auto file = reinterpret_cast<uint8_t*>(
+          mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+      check(file != MAP_FAILED);
+      data_ = reinterpret_cast<T*>(file + headerSize);
+    }
+    check(close(fd) == 0);
+  }
+  /// Maps pathname read-only, the elements start after headerBytes
+  void readBinary(const char* pathname, size_t headerBytes = 0) {
+    release();
     fd = open(pathname, O_RDONLY);
     check(fd != -1);
     struct stat sb;
     check(fstat(fd, &sb) != -1);
-    count = static_cast<uint64_t>(sb.st_size) / sizeof(T);
-    if (data_) {
-      if (persistent) {
-        check(munmap(data_, count * sizeof(T)) == 0);
-      } else {
-        free(data_);
-      }
-      data_ = nullptr;
-    }
-    data_ = reinterpret_cast<T*>(
-        mmap(nullptr, count * sizeof(T), PROT_READ, MAP_PRIVATE, fd, 0));
+    size_t length = static_cast<uint64_t>(sb.st_size);
+    check(length >= headerBytes);
+    count = (length - headerBytes) / sizeof(T);
     dataSize = sizeof(T);
-    check(data_ != MAP_FAILED);
+    headerSize = headerBytes;
     persistent = true;
+    length = headerSize + count * sizeof(T);
+    mappedLength = length;
+    capacity = count;
+    path_ = pathname;
+    fileElements = count;
+    if (length) {
+      auto file = reinterpret_cast<uint8_t*>(
+          mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0));
+      check(file != MAP_FAILED);
+      data_ = reinterpret_cast<T*>(file + headerSize);
+    }
+    check(close(fd) == 0);
+  }
+  /// Replaces the mapping by an anonymous copy of the elements without the
+  /// header. place(data, elementSize) is called on the untouched memory
+  /// before the copy, e.g. to bind its pages to NUMA nodes. With hugePages
+  /// the copy is backed by 2 MiB pages, see mapHuge.
+  template <typename F>
+  void moveToAnonymous(F place, bool hugePages = false) {
+    if (!persistent || !data_) return;
+    size_t bytes = count * dataSize;
+    size_t length = bytes;
+    uint8_t* memory;
+    if (hugePages) {
+      memory = mapHuge(length);
+    } else {
+      memory = reinterpret_cast<uint8_t*>(
+          mmap(nullptr, length, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+      check(memory != MAP_FAILED);
+    }
+    place(memory, dataSize);
+    memcpy(memory, data_, bytes);
+    auto n = count;
+    release();
+    data_ = reinterpret_cast<T*>(memory);
+    count = n;
+    capacity = n;
+    headerSize = 0;
+    mappedLength = length;
+    fileElements = 0;
+    hugePages_ = hugePages;
+  }
+  /// Appends the n elements of elementSize bytes at values. Mapped files
+  /// keep their mapping and get anonymous memory behind it, so the elements
+  /// stay contiguous. Invalidates data() if the vector has to grow.
+  void append(const void* values, size_t n, size_t elementSize) {
+    if (count + n > capacity)
+      grow(std::max(count + n, 2 * capacity), elementSize);
+    memcpy(reinterpret_cast<uint8_t*>(data_) + count * elementSize, values,
+           n * elementSize);
+    count += n;
+  }
+  /// Whether moveToAnonymous backed the elements by huge pages, appends
+  /// keep them there
+  bool onHugePages() const { return hugePages_; }
+  /// Whether elements are still mapped from the file they were read from
+  bool mapped() const { return fileElements > 0; }
+  /// File the elements were read from, empty if they were not
+  const std::string& path() const { return path_; }
+  /// Bytes loaded from the file the elements were read from
+  size_t mappedBytes() const { return path_.empty() ? 0 : mappedLength; }
+  /// Starts asynchronous readahead of the pages holding the elements
+  /// [begin, end) of a mapped file
+  void willNeed(size_t begin, size_t end) const {
+    if (!persistent || begin >= end) return;
+    auto page = size_t(sysconf(_SC_PAGESIZE));
+    auto first = reinterpret_cast<uintptr_t>(data_) + begin * dataSize;
+    auto last = reinterpret_cast<uintptr_t>(data_) + end * dataSize;
+    first -= first % page;
+    madvise(reinterpret_cast<void*>(first), last - first, MADV_WILLNEED);
+  }
+  /// Faults in the pages holding the elements [begin, end) of a mapped file
+  void populate(size_t begin, size_t end) const {
+    if (!persistent || begin >= end) return;
+    auto page = size_t(sysconf(_SC_PAGESIZE));
+    auto bytes = reinterpret_cast<const volatile uint8_t*>(data_);
+    for (auto pos = begin * dataSize; pos < end * dataSize; pos += page)
+      bytes[pos];
+    bytes[end * dataSize - 1];
+  }
+  /// Start of the mapped file, i.e. the header preceding the elements
+  void* header() const {
+    return reinterpret_cast<uint8_t*>(data_) - headerSize;
   }
 
   uint64_t size() const { return count; }
@@ -190,6 +376,7 @@ class Vector {
     if (data_) free(data_);
     data_ = reinterpret_cast<T*>(compat::aligned_alloc(16, sizeof(T) * n));
     count = 0;
+    capacity = n;
   }
   void push_back(T& el) {
     assert(!persistent);
@@ -0,0 +1,108 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+#ifdef __linux__
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace runtime {
+namespace numa {
+
+static const size_t maxNodes = 64;
+/// Partitions of placed relations start at multiples of this many tuples, so
+/// that they are page aligned for every column type
+static const size_t partitionAlignment = 64 * 1024;
+
+/// Number of NUMA nodes, 1 on systems without NUMA
+inline size_t nodes() {
+   static const size_t n = [] {
+      size_t found = 0;
+      struct stat sb;
+      while (found < maxNodes &&
+             stat(("/sys/devices/system/node/node" + std::to_string(found))
+                      .c_str(),
+                  &sb) == 0)
+         found++;
+      return std::max(found, size_t(1));
+   }();
+   return n;
+}
+
+/// NUMA node of the cpu the calling thread runs on
+inline unsigned currentNode() {
+#ifdef SYS_getcpu
+   unsigned cpu, node;
+   if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0)
+      return std::min<unsigned>(node, nodes() - 1);
+#endif
+   return 0;
+}
+
+/// Binds the pages of [begin, begin + size), begin page aligned, to node.
+/// Must be called before the pages are first touched. Returns false if the
+/// system does not support it, the pages are then placed on first touch.
+inline bool bind(void* begin, size_t size, unsigned node) {
+#ifdef SYS_mbind
+   const int bindPolicy = 2; // MPOL_BIND
+   unsigned long mask[maxNodes / 64] = {};
+   mask[node / 64] |= 1ul << (node % 64);
+   return syscall(SYS_mbind, begin, size, bindPolicy, mask, maxNodes + 1,
+                  0) == 0;
+#else
+   (void)begin, (void)size, (void)node;
+   return false;
+#endif
+}
+
+/// Splits n tuples into one partition per node, partition i is
+/// [bounds[i], bounds[i + 1])
+inline std::vector<size_t> partitionBounds(size_t n) {
+   auto parts = nodes();
+   auto perNode = (n / parts + partitionAlignment - 1) / partitionAlignment *
+                  partitionAlignment;
+   std::vector<size_t> bounds;
+   for (size_t i = 0; i < parts; i++) bounds.push_back(std::min(n, i * perNode));
+   bounds.push_back(n);
+   return bounds;
+}
+} // namespace numa
+
+class NodeMorsels
+/// Hands out morsels of a relation which is partitioned across NUMA nodes.
+/// Workers take morsels of the partition on their own node first and steal
+/// from the other partitions once it is exhausted.
+{
+   /// Next unit of each partition, relative to its begin
+   std::array<std::atomic<size_t>, numa::maxNodes> cursors;
+
+ public:
+   NodeMorsels() {
+      for (auto& c : cursors) c = 0;
+   }
+   /// Takes the next morsel of up to size units out of the partitions
+   /// [bounds[i], bounds[i + 1]) into [begin, end), preferring partition node.
+   /// Returns false when all partitions are exhausted.
+   bool next(const std::vector<size_t>& bounds, unsigned node, size_t size,
+             size_t& begin, size_t& end) {
+      auto parts = bounds.size() - 1;
+      for (size_t i = 0; i < parts; i++) {
+         auto part = (node + i) % parts;
+         auto partSize = bounds[part + 1] - bounds[part];
+         if (cursors[part].load() >= partSize) continue;
+         auto pos = cursors[part].fetch_add(size);
+         if (pos >= partSize) continue;
+         begin = bounds[part] + pos;
+         end = bounds[part] + std::min(partSize, pos + size);
+         return true;
+      }
+      return false;
+   }
+};
+} // namespace runtime
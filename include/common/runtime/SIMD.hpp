@@ -1,10 +1,80 @@
 #pragma once
+#include "common/runtime/Cpu.hpp"
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <immintrin.h>
 #include <iostream>
 #include <ostream>
 #include <vector>
 
+struct Vec4u {
+   union {
+      __m256i reg;
+      uint64_t entry[4];
+   };
+
+   // constructor
+   SIMD_AVX2 explicit Vec4u(uint64_t x) { reg = _mm256_set1_epi64x(x); };
+   SIMD_AVX2 explicit Vec4u(const void* p) {
+      reg = _mm256_loadu_si256(static_cast<const __m256i*>(p));
+   };
+   SIMD_AVX2 Vec4u(__m256i x) { reg = x; };
+
+   // implicit conversion to register
+   SIMD_AVX2 operator __m256i() { return reg; }
+};
+
+SIMD_AVX2 inline Vec4u operator+ (const Vec4u& a, const Vec4u& b) { return _mm256_add_epi64(a.reg, b.reg); }
+SIMD_AVX2 inline Vec4u operator- (const Vec4u& a, const Vec4u& b) { return _mm256_sub_epi64(a.reg, b.reg); }
+/// AVX2 has no 64 bit multiplication, the product is combined from the 32 bit
+/// products of the halves
+SIMD_AVX2 inline Vec4u operator* (const Vec4u& a, const Vec4u& b) {
+   auto low = _mm256_mul_epu32(a.reg, b.reg);
+   auto cross = _mm256_add_epi64(
+       _mm256_mul_epu32(_mm256_srli_epi64(a.reg, 32), b.reg),
+       _mm256_mul_epu32(a.reg, _mm256_srli_epi64(b.reg, 32)));
+   return _mm256_add_epi64(low, _mm256_slli_epi64(cross, 32));
+}
+SIMD_AVX2 inline Vec4u operator^ (const Vec4u& a, const Vec4u& b) { return _mm256_xor_si256(a.reg, b.reg); }
+SIMD_AVX2 inline Vec4u operator>> (const Vec4u& a, const unsigned shift) { return _mm256_srli_epi64(a.reg, shift); }
+SIMD_AVX2 inline Vec4u operator<< (const Vec4u& a, const unsigned shift) { return _mm256_slli_epi64(a.reg, shift); }
+SIMD_AVX2 inline Vec4u operator>> (const Vec4u& a, const Vec4u& shift) { return _mm256_srlv_epi64(a.reg, shift.reg); }
+SIMD_AVX2 inline Vec4u operator<< (const Vec4u& a, const Vec4u& shift) { return _mm256_sllv_epi64(a.reg, shift.reg); }
+SIMD_AVX2 inline Vec4u operator& (const Vec4u& a, const Vec4u& b) { return _mm256_and_si256(a.reg, b.reg); }
+
+/// Permutation of 8 32 bit lanes which moves the lanes set in mask to the
+/// front, AVX2 lacks the compress store of AVX-512
+SIMD_AVX2 inline __m256i compressLanes(uint32_t mask) {
+   static const auto permutations = [] {
+      std::array<std::array<uint32_t, 8>, 256> table{};
+      for (uint32_t m = 0; m < 256; m++) {
+         uint32_t pos = 0;
+         for (uint32_t lane = 0; lane < 8; lane++)
+            if (m & (1u << lane)) table[m][pos++] = lane;
+      }
+      return table;
+   }();
+   return _mm256_loadu_si256(
+       reinterpret_cast<const __m256i*>(permutations[mask].data()));
+}
+
+/// Permutation of 4 64 bit lanes which moves the lanes set in mask to the
+/// front, see compressLanes
+SIMD_AVX2 inline __m256i compressLanes64(uint32_t mask) {
+   // each 64 bit lane is a pair of 32 bit lanes
+   uint32_t pairs = 0;
+   for (uint32_t lane = 0; lane < 4; lane++)
+      if (mask & (1u << lane)) pairs |= 3u << (2 * lane);
+   return compressLanes(pairs);
+}
+
+struct Vec4uM {
+   Vec4u vec;
+   /// All bits set in the lanes which are valid
+   __m256i mask;
+};
+
 struct Vec8u {
    union {
       __m512i reg;
@@ -12,13 +82,13 @@ struct Vec8u {
    };
 
    // constructor
-   explicit Vec8u(uint64_t x) { reg = _mm512_set1_epi64(x); };
-   explicit Vec8u(void* p) { reg = _mm512_loadu_si512(p); };
-   Vec8u(__m512i x) { reg = x; };
-   Vec8u(uint64_t x0, uint64_t x1, uint64_t x2, uint64_t x3, uint64_t x4, uint64_t x5, uint64_t x6, uint64_t x7) { reg = _mm512_set_epi64(x0, x1, x2, x3, x4, x5, x6, x7); };
+   SIMD_AVX512 explicit Vec8u(uint64_t x) { reg = _mm512_set1_epi64(x); };
+   SIMD_AVX512 explicit Vec8u(void* p) { reg = _mm512_loadu_si512(p); };
+   SIMD_AVX512 Vec8u(__m512i x) { reg = x; };
+   SIMD_AVX512 Vec8u(uint64_t x0, uint64_t x1, uint64_t x2, uint64_t x3, uint64_t x4, uint64_t x5, uint64_t x6, uint64_t x7) { reg = _mm512_set_epi64(x0, x1, x2, x3, x4, x5, x6, x7); };
 
    // implicit conversion to register
-   operator __m512i() { return reg; }
+   SIMD_AVX512 operator __m512i() { return reg; }
 
    // print vector (for debugging)
    friend std::ostream& operator<< (std::ostream& stream, const Vec8u& v) {
@@ -33,21 +103,21 @@ struct Vec8uM{
    __mmask8 mask;
 };
 
-inline Vec8u operator+ (const Vec8u& a, const Vec8u& b) { return _mm512_add_epi64(a.reg, b.reg); }
-inline Vec8u operator- (const Vec8u& a, const Vec8u& b) { return _mm512_sub_epi64(a.reg, b.reg); }
-inline Vec8u operator* (const Vec8u& a, const Vec8u& b) { return _mm512_mullo_epi64(a.reg, b.reg); }
-inline Vec8u operator^ (const Vec8u& a, const Vec8u& b) { return _mm512_xor_epi64(a.reg, b.reg); }
-inline Vec8u operator>> (const Vec8u& a, const unsigned shift) { return _mm512_srli_epi64(a.reg, shift); }
-inline Vec8u operator<< (const Vec8u& a, const unsigned shift) { return _mm512_slli_epi64(a.reg, shift); }
-inline Vec8u operator>> (const Vec8u& a, const Vec8u& shift) { return _mm512_srlv_epi64(a.reg, shift.reg); }
-inline Vec8u operator<< (const Vec8u& a, const Vec8u& shift) { return _mm512_sllv_epi64(a.reg, shift.reg); }
-inline Vec8u operator& (const Vec8u& a, const Vec8u& b) { return _mm512_and_epi64(a.reg, b.reg); }
-inline __mmask8 operator== (const Vec8u& a, const Vec8u& b) { return _mm512_cmpeq_epi64_mask(a.reg, b.reg); }
-inline __mmask8 operator!= (const Vec8u& a, const Vec8u& b) { return _mm512_cmpneq_epi64_mask(a.reg, b.reg); }
-inline __mmask8 operator< (const Vec8u& a, const Vec8u& b) { return _mm512_cmplt_epi64_mask(a.reg, b.reg); }
-inline __mmask8 operator<= (const Vec8u& a, const Vec8u& b) { return _mm512_cmple_epi64_mask(a.reg, b.reg); }
-inline __mmask8 operator> (const Vec8u& a, const Vec8u& b) { return _mm512_cmpgt_epi64_mask(a.reg, b.reg); }
-inline __mmask8 operator>= (const Vec8u& a, const Vec8u& b) { return _mm512_cmpge_epi64_mask(a.reg, b.reg); }
+SIMD_AVX512 inline Vec8u operator+ (const Vec8u& a, const Vec8u& b) { return _mm512_add_epi64(a.reg, b.reg); }
+SIMD_AVX512 inline Vec8u operator- (const Vec8u& a, const Vec8u& b) { return _mm512_sub_epi64(a.reg, b.reg); }
+SIMD_AVX512 inline Vec8u operator* (const Vec8u& a, const Vec8u& b) { return _mm512_mullo_epi64(a.reg, b.reg); }
+SIMD_AVX512 inline Vec8u operator^ (const Vec8u& a, const Vec8u& b) { return _mm512_xor_epi64(a.reg, b.reg); }
+SIMD_AVX512 inline Vec8u operator>> (const Vec8u& a, const unsigned shift) { return _mm512_srli_epi64(a.reg, shift); }
+SIMD_AVX512 inline Vec8u operator<< (const Vec8u& a, const unsigned shift) { return _mm512_slli_epi64(a.reg, shift); }
+SIMD_AVX512 inline Vec8u operator>> (const Vec8u& a, const Vec8u& shift) { return _mm512_srlv_epi64(a.reg, shift.reg); }
+SIMD_AVX512 inline Vec8u operator<< (const Vec8u& a, const Vec8u& shift) { return _mm512_sllv_epi64(a.reg, shift.reg); }
+SIMD_AVX512 inline Vec8u operator& (const Vec8u& a, const Vec8u& b) { return _mm512_and_epi64(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask8 operator== (const Vec8u& a, const Vec8u& b) { return _mm512_cmpeq_epi64_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask8 operator!= (const Vec8u& a, const Vec8u& b) { return _mm512_cmpneq_epi64_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask8 operator< (const Vec8u& a, const Vec8u& b) { return _mm512_cmplt_epi64_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask8 operator<= (const Vec8u& a, const Vec8u& b) { return _mm512_cmple_epi64_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask8 operator> (const Vec8u& a, const Vec8u& b) { return _mm512_cmpgt_epi64_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask8 operator>= (const Vec8u& a, const Vec8u& b) { return _mm512_cmpge_epi64_mask(a.reg, b.reg); }
 
 
 struct Vec16u {
@@ -57,19 +127,19 @@ struct Vec16u {
    };
 
    // constructor
-   explicit Vec16u(uint32_t x) { reg = _mm512_set1_epi32(x); };
-   explicit Vec16u(void* p) { reg = _mm512_loadu_si512(p); };
-   Vec16u(__m512i x) { reg = x; };
-   Vec16u(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3, uint32_t x4,
-          uint32_t x5, uint32_t x6, uint32_t x7, uint32_t x8, uint32_t x9,
-          uint32_t x10, uint32_t x11, uint32_t x12, uint32_t x13, uint32_t x14,
-          uint32_t x15) {
+   SIMD_AVX512 explicit Vec16u(uint32_t x) { reg = _mm512_set1_epi32(x); };
+   SIMD_AVX512 explicit Vec16u(void* p) { reg = _mm512_loadu_si512(p); };
+   SIMD_AVX512 Vec16u(__m512i x) { reg = x; };
+   SIMD_AVX512 Vec16u(uint32_t x0, uint32_t x1, uint32_t x2, uint32_t x3,
+                      uint32_t x4, uint32_t x5, uint32_t x6, uint32_t x7,
+                      uint32_t x8, uint32_t x9, uint32_t x10, uint32_t x11,
+                      uint32_t x12, uint32_t x13, uint32_t x14, uint32_t x15) {
       reg = _mm512_set_epi32(x0, x1, x2, x3, x4, x5, x6, x7, x8, x9, x10, x11,
                              x12, x13, x14, x15);
    };
 
    // implicit conversion to register
-   operator __m512i() { return reg; }
+   SIMD_AVX512 operator __m512i() { return reg; }
 
    // print vector (for debugging)
    friend std::ostream& operator<< (std::ostream& stream, const Vec16u& v) {
@@ -84,18 +154,18 @@ struct Vec16uM{
    __mmask8 mask;
 };
 
-inline Vec16u operator+ (const Vec16u& a, const Vec16u& b) { return _mm512_add_epi32(a.reg, b.reg); }
-inline Vec16u operator- (const Vec16u& a, const Vec16u& b) { return _mm512_sub_epi32(a.reg, b.reg); }
-inline Vec16u operator* (const Vec16u& a, const Vec16u& b) { return _mm512_mullo_epi32(a.reg, b.reg); }
-inline Vec16u operator^ (const Vec16u& a, const Vec16u& b) { return _mm512_xor_epi32(a.reg, b.reg); }
-inline Vec16u operator>> (const Vec16u& a, const unsigned shift) { return _mm512_srli_epi32(a.reg, shift); }
-inline Vec16u operator<< (const Vec16u& a, const unsigned shift) { return _mm512_slli_epi32(a.reg, shift); }
-inline Vec16u operator>> (const Vec16u& a, const Vec16u& shift) { return _mm512_srlv_epi32(a.reg, shift.reg); }
-inline Vec16u operator<< (const Vec16u& a, const Vec16u& shift) { return _mm512_sllv_epi32(a.reg, shift.reg); }
-inline Vec16u operator& (const Vec16u& a, const Vec16u& b) { return _mm512_and_epi32(a.reg, b.reg); }
-inline __mmask16 operator== (const Vec16u& a, const Vec16u& b) { return _mm512_cmpeq_epi32_mask(a.reg, b.reg); }
-inline __mmask16 operator!= (const Vec16u& a, const Vec16u& b) { return _mm512_cmpneq_epi32_mask(a.reg, b.reg); }
-inline __mmask16 operator< (const Vec16u& a, const Vec16u& b) { return _mm512_cmplt_epi32_mask(a.reg, b.reg); }
-inline __mmask16 operator<= (const Vec16u& a, const Vec16u& b) { return _mm512_cmple_epi32_mask(a.reg, b.reg); }
-inline __mmask16 operator> (const Vec16u& a, const Vec16u& b) { return _mm512_cmpgt_epi32_mask(a.reg, b.reg); }
-inline __mmask16 operator>= (const Vec16u& a, const Vec16u& b) { return _mm512_cmpge_epi32_mask(a.reg, b.reg); }
+SIMD_AVX512 inline Vec16u operator+ (const Vec16u& a, const Vec16u& b) { return _mm512_add_epi32(a.reg, b.reg); }
+SIMD_AVX512 inline Vec16u operator- (const Vec16u& a, const Vec16u& b) { return _mm512_sub_epi32(a.reg, b.reg); }
+SIMD_AVX512 inline Vec16u operator* (const Vec16u& a, const Vec16u& b) { return _mm512_mullo_epi32(a.reg, b.reg); }
+SIMD_AVX512 inline Vec16u operator^ (const Vec16u& a, const Vec16u& b) { return _mm512_xor_epi32(a.reg, b.reg); }
+SIMD_AVX512 inline Vec16u operator>> (const Vec16u& a, const unsigned shift) { return _mm512_srli_epi32(a.reg, shift); }
+SIMD_AVX512 inline Vec16u operator<< (const Vec16u& a, const unsigned shift) { return _mm512_slli_epi32(a.reg, shift); }
+SIMD_AVX512 inline Vec16u operator>> (const Vec16u& a, const Vec16u& shift) { return _mm512_srlv_epi32(a.reg, shift.reg); }
+SIMD_AVX512 inline Vec16u operator<< (const Vec16u& a, const Vec16u& shift) { return _mm512_sllv_epi32(a.reg, shift.reg); }
+SIMD_AVX512 inline Vec16u operator& (const Vec16u& a, const Vec16u& b) { return _mm512_and_epi32(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask16 operator== (const Vec16u& a, const Vec16u& b) { return _mm512_cmpeq_epi32_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask16 operator!= (const Vec16u& a, const Vec16u& b) { return _mm512_cmpneq_epi32_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask16 operator< (const Vec16u& a, const Vec16u& b) { return _mm512_cmplt_epi32_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask16 operator<= (const Vec16u& a, const Vec16u& b) { return _mm512_cmple_epi32_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask16 operator> (const Vec16u& a, const Vec16u& b) { return _mm512_cmpgt_epi32_mask(a.reg, b.reg); }
+SIMD_AVX512 inline __mmask16 operator>= (const Vec16u& a, const Vec16u& b) { return _mm512_cmpge_epi32_mask(a.reg, b.reg); }
@@ -20,7 +20,7 @@ class SmallStringView {
   inline friend bool operator==(const SmallStringView& lhs,
                                 const SmallStringView& rhs);
 
-  bool isInlined() const;
+  inline bool isInlined() const;
 
   inline friend bool operator==(const SmallStringView& lhs,
                                 const std::string_view& rhs);
@@ -39,6 +39,10 @@ class SmallStringView {
 
   inline const char* data() const;
 
+  /// Whether the string starts with prefix. Only reads the heap for prefixes
+  /// of heap strings which are longer than the 4 byte inline prefix.
+  inline bool startsWith(const char* prefix, uint32_t len) const;
+
  private:
   union {
     struct {
@@ -64,3 +68,60 @@ class SmallStringView {
 
   inline void setStrPtr(const char* str);
 };
+
+inline bool fmemcmp(const char* __restrict__ left,
+                    const char* __restrict__ right, uint32_t size) {
+  for (uint32_t i = 0; i < size; ++i)
+    if (left[i] != right[i]) {
+      return false;
+    }
+  return true;
+}
+
+inline bool operator==(const SmallStringView& lhs,
+                       const SmallStringView& rhs) {
+  // size and prefix
+  if (lhs.raw.first != rhs.raw.first) return false;
+  if (lhs.isInlined()) return lhs.raw.second == rhs.raw.second;
+  return fmemcmp(lhs.data(), rhs.data(), lhs.size());
+}
+
+inline bool operator==(const SmallStringView& lhs,
+                       const std::string_view& rhs) {
+  auto size = lhs.size();
+  if (size != rhs.size()) return false;
+  return fmemcmp(lhs.data(), rhs.data(), size);
+}
+
+inline bool SmallStringView::isInlined() const {
+  return size() <= foldCapacity;
+}
+
+inline void SmallStringView::assign(std::string& data) {
+  assign(data.data(), data.size());
+}
+
+inline void SmallStringView::assign(std::string_view& data) {
+  assign(data.data(), data.size());
+}
+
+inline uint32_t SmallStringView::size() const { return inlined.size; }
+inline const char* SmallStringView::data() const {
+  if (isInlined())
+    return inlined.data;
+  else
+    return heap.data;
+}
+
+inline bool SmallStringView::startsWith(const char* prefix,
+                                        uint32_t len) const {
+  if (len > size()) return false;
+  // inlined strings and the prefix of heap strings start at the same offset
+  uint32_t local = isInlined() ? len : std::min(len, 4u);
+  if (!fmemcmp(inlined.data, prefix, local)) return false;
+  return len == local ||
+         fmemcmp(heap.data + local, prefix + local, len - local);
+}
+
+inline void SmallStringView::setSize(uint32_t s) { inlined.size = s; }
+inline void SmallStringView::setStrPtr(const char* str) { heap.data = str; }
@@ -0,0 +1,42 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace runtime {
+
+/// Structural index of a .tbl block: writes the offsets (relative to begin)
+/// of all field delimiters and line ends in [begin, end) to out and returns
+/// their number. out needs room for end - begin entries in the worst case.
+inline size_t findDelimiters(const char* begin, const char* end,
+                             uint32_t* out, char delimiter = '|') {
+   size_t found = 0;
+   size_t pos = 0, size = end - begin;
+#ifdef __AVX2__
+   const __m256i delim = _mm256_set1_epi8(delimiter);
+   const __m256i newline = _mm256_set1_epi8('\n');
+   // one bitmap per 64 byte block, walked with tzcnt
+   for (; pos + 64 <= size; pos += 64) {
+      auto block = reinterpret_cast<const __m256i*>(begin + pos);
+      auto lo = _mm256_loadu_si256(block);
+      auto hi = _mm256_loadu_si256(block + 1);
+      uint64_t maskLo = static_cast<uint32_t>(_mm256_movemask_epi8(
+          _mm256_or_si256(_mm256_cmpeq_epi8(lo, delim),
+                          _mm256_cmpeq_epi8(lo, newline))));
+      uint64_t maskHi = static_cast<uint32_t>(_mm256_movemask_epi8(
+          _mm256_or_si256(_mm256_cmpeq_epi8(hi, delim),
+                          _mm256_cmpeq_epi8(hi, newline))));
+      uint64_t mask = maskLo | (maskHi << 32);
+      while (mask) {
+         out[found++] = pos + __builtin_ctzll(mask);
+         mask &= mask - 1;
+      }
+   }
+#endif
+   for (; pos < size; pos++)
+      if (begin[pos] == delimiter || begin[pos] == '\n') out[found++] = pos;
+   return found;
+}
+} // namespace runtime
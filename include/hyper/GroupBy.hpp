@@ -22,10 +22,23 @@ class GroupBy {
    V init;
 
    size_t nrThreads;
+   /// Estimated number of groups, 0 if unknown
+   size_t expectedGroups;
+
+   size_t preAggSize() const {
+      return expectedGroups ? runtime::grouping::preAggSize(expectedGroups)
+                            : runtime::grouping::defaultGroups;
+   }
+   size_t nrPartitions() const {
+      return runtime::grouping::partitions(expectedGroups, nrThreads);
+   }
 
  public:
-   GroupBy(UPDATE u, V i, size_t nrThreads_)
-       : update(u), init(i), nrThreads(nrThreads_) {}
+   /// expectedGroups_ sizes the hashtables and the number of spill
+   /// partitions, e.g. from Relation::distinct
+   GroupBy(UPDATE u, V i, size_t nrThreads_, size_t expectedGroups_ = 0)
+       : update(u), init(i), nrThreads(nrThreads_),
+         expectedGroups(expectedGroups_) {}
 
    GroupBy(const GroupBy& g) = delete;
    GroupBy(GroupBy&& g) = default;
@@ -99,13 +112,13 @@ class GroupBy {
       auto& g = groups.local(exists);
       size_t maxFill;
       if (!exists)
-         maxFill = g.setSize(1024);
+         maxFill = g.setSize(preAggSize());
       else
          maxFill = g.capacity * 0.7;
       auto& e = entries.local();
 
       auto& spillStorage = partitionedDeques.local(exists);
-      if (!exists) spillStorage.postConstruct(nrThreads * 4, sizeof(group_t));
+      if (!exists) spillStorage.postConstruct(nrPartitions(), sizeof(group_t));
 
       return Locals(*this, g, e, spillStorage, maxFill);
    }
@@ -115,7 +128,7 @@ class GroupBy {
 
          bool exists;
          auto& deque = partitionedDeques.local(exists);
-         if (!exists) deque.postConstruct(nrThreads * 4, sizeof(group_t));
+         if (!exists) deque.postConstruct(nrPartitions(), sizeof(group_t));
          for (auto& entries : e)
             for (auto block : entries)
                for (auto& entry : block) deque.push_back(&entry, entry.h.hash);
@@ -137,13 +150,17 @@ class GroupBy {
 
       // aggregate from spill partitions
       auto nrPartitions = partitionedDeques.begin()->getPartitions().size();
+      // groups of one partition
+      auto partitionSize =
+          std::max(runtime::grouping::defaultGroups,
+                   expectedGroups / nrPartitions);
 
       tbb::parallel_for(0ul, nrPartitions, [&](auto partitionNr) {
          bool exists = false;
          auto& ht = groups.local(exists);
          size_t maxFill;
-         if (!exists)
-            maxFill = ht.setSize(1024);
+         if (!exists || ht.capacity * 0.7 < partitionSize)
+            maxFill = ht.setSize(partitionSize);
          else
             maxFill = ht.capacity * 0.7;
          auto& localEntries = entries.local();
@@ -175,6 +192,8 @@ class GroupBy {
 
 template <typename K, typename V, typename HASH, typename UPDATE>
 GroupBy<K, V, HASH, UPDATE> make_GroupBy(UPDATE u, V i,
-                                               size_t nrThreads) {
-   return std::move(GroupBy<K, V, HASH, UPDATE>(u, i, nrThreads));
+                                               size_t nrThreads,
+                                               size_t expectedGroups = 0) {
+   return std::move(
+       GroupBy<K, V, HASH, UPDATE>(u, i, nrThreads, expectedGroups));
 }
@@ -1,3 +1,6 @@
+#include "common/runtime/BloomFilter.hpp"
+#include "common/runtime/Database.hpp"
+#include "common/runtime/Numa.hpp"
 #include "common/runtime/Query.hpp"
 #include <deque>
 #include <tbb/tbb.h>
@@ -66,8 +69,84 @@ void parallel_scan(size_t n, E& entriesGlobal, L& cb) {
        },                                                                      \
        [](const size_t& a, const size_t& b) { return a + b; })
 
+/// parallel_for over the tuples of the blocks kept by filter, f is called
+/// with the tuple range of each candidate block
+template <typename F>
+void parallel_for_candidates(const runtime::BlockFilter& filter, F f) {
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, filter.nrBlocks()),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto b = r.begin(); b != r.end(); ++b)
+                           if (filter.candidate(b))
+                              f(tbb::blocked_range<size_t>(filter.begin(b),
+                                                           filter.end(b)));
+                     });
+}
+
+/// parallel_reduce over the tuples of the blocks kept by filter, f is called
+/// with the tuple range of each candidate block and the running value
+template <typename V, typename F, typename R>
+V parallel_reduce_candidates(const runtime::BlockFilter& filter,
+                             const V& identity, F f, R reduce) {
+   return tbb::parallel_reduce(
+       tbb::blocked_range<size_t>(0, filter.nrBlocks()), identity,
+       [&](const tbb::blocked_range<size_t>& r, const V& v) {
+          auto value = v;
+          for (auto b = r.begin(); b != r.end(); ++b)
+             if (filter.candidate(b))
+                value = f(tbb::blocked_range<size_t>(filter.begin(b),
+                                                     filter.end(b)),
+                          value);
+          return value;
+       },
+       reduce);
+}
+
+/// parallel_for over the tuples of rel in morsels. If the relation is placed
+/// on NUMA nodes, every thread processes the morsels of its own node first.
+template <typename F> void parallel_for_nodes(const runtime::Relation& rel, F f) {
+   if (rel.nodeBounds.empty()) {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, rel.nrTuples, morselSize),
+                        f);
+      return;
+   }
+   runtime::NodeMorsels morsels;
+   tbb::parallel_for(0, tbb::this_task_arena::max_concurrency(), [&](int) {
+      auto node = runtime::numa::currentNode();
+      size_t begin, end;
+      while (morsels.next(rel.nodeBounds, node, morselSize, begin, end))
+         f(tbb::blocked_range<size_t>(begin, end));
+   });
+}
+
+/// Values of the 32 bit attribute attr for the morsel r, indexed by tuple
+/// id. Bit packed attributes are unpacked into buffer.
+template <typename T>
+const T* morselValues(runtime::Attribute& attr,
+                      const tbb::blocked_range<size_t>& r,
+                      std::vector<T>& buffer) {
+   if (!attr.packed) return attr.data<T>();
+   static_assert(sizeof(T) == sizeof(int32_t), "only 32 bit attributes");
+   buffer.resize(r.size());
+   attr.packed->unpack(r.begin(), r.size(),
+                       reinterpret_cast<int32_t*>(buffer.data()));
+   return buffer.data() - r.begin();
+}
+
 template <typename E, typename HT> void parallel_insert(E& entries, HT& ht) {
    tbb::parallel_for(entries.range(), [&ht](const auto& r) {
       for (auto& entries : r) ht.insertAll(entries);
    });
 }
+
+/// Inserts the entries into ht and their hashes into filter, which must be
+/// sized for them. Probes can skip ht for keys whose hash fails filter.
+template <typename E, typename HT>
+void parallel_insert(E& entries, HT& ht, runtime::BloomFilter& filter) {
+   tbb::parallel_for(entries.range(), [&](const auto& r) {
+      for (auto& entries : r) {
+         ht.insertAll(entries);
+         for (auto block : entries)
+            for (auto& e : block) filter.insert(e.h.hash);
+      }
+   });
+}
@@ -1,8 +1,13 @@
 #pragma once
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <memory>
+#include <ostream>
+#include <string>
 #include <tuple>
 #include <vector>
+#include <x86intrin.h>
 
 #include "Primitives.hpp"
 
@@ -143,9 +148,78 @@ struct NEqualityCheckSel : public Op {
   virtual pos_t run(pos_t n) override;
 };
 
+/// Whether operations pick among the flavors of their primitives at run time,
+/// see Flavors. Only affects operations built afterwards.
+extern bool adaptiveFlavors;
+/// Adds the calls of the flavors of a primitive group by one operation to the
+/// flavor report, best is the flavor the operation settled on
+void reportFlavors(const primitives::FlavorGroup& group,
+                   const std::vector<uint64_t>& calls, size_t best);
+/// Prints the share of calls of every flavor of the adaptive primitives, and
+/// how many operations settled on it
+void printFlavorReport(std::ostream& out);
+
+template <typename F>
+class Flavors
+/// Primitive of an operation with its interchangeable flavors, e.g. branching
+/// and branch free selections. Vectorwise-style micro adaptivity: all flavors
+/// are explored for exploreCalls calls each at the start and every
+/// explorePeriod calls, in between the flavor with the lowest measured
+/// cycles per tuple is used. Without adaptiveFlavors just the given flavor.
+{
+ public:
+  static const uint64_t explorePeriod = 1024;
+  static const uint64_t exploreCalls = 4;
+
+ private:
+  const primitives::FlavorGroup* group = nullptr;
+  std::vector<F> flavors;
+  /// Moving average of the cycles per tuple of each flavor
+  std::vector<double> costs;
+  std::vector<uint64_t> calls;
+  uint64_t totalCalls = 0;
+  size_t best = 0;
+
+  size_t pick() {
+    auto phase = totalCalls++ % explorePeriod;
+    if (phase < flavors.size() * exploreCalls) return phase / exploreCalls;
+    return best;
+  }
+  void measure(size_t flavor, pos_t n, uint64_t cycles) {
+    double cost = double(cycles) / std::max<pos_t>(n, 1);
+    auto& c = costs[flavor];
+    c = calls[flavor]++ ? 0.75 * c + 0.25 * cost : cost;
+    for (size_t i = 0; i < flavors.size(); i++)
+      if (calls[i] && (!calls[best] || costs[i] < costs[best])) best = i;
+  }
+
+ public:
+  Flavors(F f) : flavors{f} {
+    if (adaptiveFlavors) group = primitives::flavorsOf((void*)f);
+    if (!group) return;
+    flavors.clear();
+    for (auto& flavor : group->flavors) flavors.push_back((F)flavor.first);
+    costs.assign(flavors.size(), 0);
+    calls.assign(flavors.size(), 0);
+  }
+  Flavors(const Flavors&) = delete;
+  ~Flavors() {
+    if (group) reportFlavors(*group, calls, best);
+  }
+  template <typename... Args>
+  pos_t operator()(pos_t n, Args... args) {
+    if (!group) return flavors[0](n, args...);
+    auto flavor = pick();
+    auto start = __rdtsc();
+    auto found = flavors[flavor](n, args...);
+    measure(flavor, n, __rdtsc() - start);
+    return found;
+  }
+};
+
 struct F1_Op : public Op {
   void* input;
-  primitives::F1 operation;
+  Flavors<primitives::F1> operation;
   F1_Op(void* i, primitives::F1 op) : input(i), operation(op) {}
   virtual pos_t run(pos_t n) override;
 };
@@ -153,7 +227,7 @@ struct F1_Op : public Op {
 struct F2_Op : public Op {
   void* input;
   void* param1;
-  primitives::F2 operation;
+  Flavors<primitives::F2> operation;
   F2_Op(void* i, void* p1, primitives::F2 op)
       : input(i), param1(p1), operation(op) {}
   virtual pos_t run(pos_t n) override;
@@ -165,7 +239,7 @@ struct F3_Op : public Op
   void* outputSelectionV;
   void* param1;
   void* param2;
-  primitives::F3 operation;
+  Flavors<primitives::F3> operation;
   F3_Op(void* out, void* p1, void* p2, primitives::F3 o)
       : outputSelectionV(out), param1(p1), param2(p2), operation(o) {}
   virtual pos_t run(pos_t n) override;
@@ -178,7 +252,7 @@ struct F4_Op : public Op
   void* outputSelectionV;
   void* param1;
   void* param2;
-  primitives::F4 operation;
+  Flavors<primitives::F4> operation;
   F4_Op(void* in, void* out, void* p1, void* p2, primitives::F4 o)
       : inputSelectionV(in),
         outputSelectionV(out),
@@ -1,14 +1,19 @@
 #pragma once
 #include "Operations.hpp"
 #include "common/Compat.hpp"
+#include "common/runtime/BloomFilter.hpp"
 #include "common/runtime/Concurrency.hpp"
 #include "common/runtime/Database.hpp"
 #include "common/runtime/Hashmap.hpp"
+#include "common/runtime/Numa.hpp"
 #include "common/runtime/PartitionedDeque.hpp"
 #include "common/runtime/Query.hpp"
 #include "vectorwise/Primitives.hpp"
+#include "vectorwise/VectorSizeTuner.hpp"
 #include <atomic>
 #include <cstdint>
+#include <cstring>
+#include <deque>
 #include <memory>
 #include <mutex>
 #include <tuple>
@@ -39,15 +44,40 @@ class BinaryOperator : public Operator {
    std::unique_ptr<Operator> right;
 };
 
-class Select : public UnaryOperator {
+class Select : public UnaryOperator
+/// Evaluates condition into a selection vector. With a denseCondition, the
+/// variant of condition on bitmaps, the representation follows the observed
+/// selectivity: above denseSelectivity, dense compares into bitmaps are
+/// cheaper than building and chasing selection vectors. denseCondition either
+/// ends in primitives::bitmap_to_sel into the same selection vector, or, if
+/// all consumers have variants on bitmaps (Project::denseExpressions,
+/// FixedAggr::denseAggregates), in bitmap, which they then read directly.
+/// Hash joins and groupings only take selection vectors and need the first.
+{
+   /// Moving average of the share of selected tuples
+   double selectivity = 0;
+
  public:
+   static constexpr double denseSelectivity = 0.25;
    std::unique_ptr<Expression> condition;
+   std::unique_ptr<Expression> denseCondition;
+   /// Bitmap denseCondition ends in, if the consumers read it
+   uint64_t* bitmap = nullptr;
+   /// Whether the last vector was selected into bitmap, next() then returns
+   /// the number of tuples of the vector rather than of selected ones
+   bool denseResult = false;
+   /// Vectors evaluated by denseCondition
+   uint64_t denseVectors = 0;
    virtual size_t next() override;
 };
 
 class Project : public UnaryOperator {
  public:
    std::vector<std::unique_ptr<Expression>> expressions;
+   /// Variants of expressions on the bitmap of denseInput, evaluated for the
+   /// vectors it selects into it
+   std::vector<std::unique_ptr<Expression>> denseExpressions;
+   const Select* denseInput = nullptr;
    virtual size_t next() override;
 };
 
@@ -56,6 +86,10 @@ class FixedAggr : public UnaryOperator {
 
  public:
    Aggregates aggregates;
+   /// Variant of aggregates on the bitmap of denseInput, evaluated for the
+   /// vectors it selects into it
+   Aggregates denseAggregates;
+   const Select* denseInput = nullptr;
    virtual size_t next() override;
 };
 
@@ -140,25 +174,97 @@ class Scan : public Operator {
  public:
    struct Shared : public SharedState {
       std::atomic<size_t> pos;
+      /// Chunks of relations placed on NUMA nodes
+      runtime::NodeMorsels chunks;
       Shared() : pos(0){};
    };
 
  private:
-   size_t scanChunkSize;
+   /// Tuples per chunk, independent of the vector size
+   size_t chunkTuples;
    Shared& shared;
    bool needsInit;
-   size_t vecInChunk;
+   /// Tuples of the current chunk which were scanned already
+   size_t posInChunk;
    size_t currentChunk;
-   size_t lastOffset;
+   /// Scanned tuples [firstTuple, nrTuples)
+   size_t firstTuple;
    size_t nrTuples;
+   /// Capacity of the vectors of the pipeline
    size_t vecSize;
-   std::vector<std::pair<void**, size_t>> consumers;
+   /// Tuples per vector, at most vecSize
+   size_t batchSize;
+   /// Picks batchSize if the vector size is tuned
+   std::unique_ptr<VectorSizeTuner> tuner;
+   /// Bytes per tuple of the intermediate buffers of the pipeline
+   std::shared_ptr<const size_t> bufferBytes;
+   /// Timestamp and size of the last vector handed out, for online tuning
+   uint64_t lastVectorStart = 0;
+   size_t lastVectorSize = 0;
+   /// First chunk of the partition of each NUMA node, empty if the relation
+   /// is not placed
+   std::vector<size_t> chunkBounds;
+   unsigned node;
+   struct Consumer {
+      void** colPtr;
+      uint8_t* base;
+      size_t typeSize;
+      /// Tuples of the current vector which pass the join filters
+      std::vector<uint8_t> buffer;
+   };
+   std::vector<Consumer> consumers;
+   struct PackedConsumer {
+      const runtime::PackedColumn* column;
+      std::vector<int32_t> buffer;
+   };
+   /// Bit packed columns, unpacked into one buffer per column
+   std::deque<PackedConsumer> packedConsumers;
+   struct JoinFilter {
+      const runtime::BloomFilter* filter;
+      const uint8_t* keys;
+      size_t typeSize;
+      primitives::F2 hash;
+   };
+   /// Filters of the joins probed by the scanned tuples
+   std::vector<JoinFilter> joinFilters;
+   std::vector<primitives::hash_t> filterHashes;
+   std::vector<pos_t> filterSel;
+   /// Drops the tuples [begin, begin + n) which fail a join filter from the
+   /// consumers of the current vector, returns the number of tuples left
+   size_t applyJoinFilters(size_t begin, size_t n);
+   /// Zone map blocks which may contain qualifying tuples, scans all if null
+   const runtime::BlockFilter* filter;
+   /// Claims the next chunk to scan, preferring the local NUMA partition
+   bool nextChunk();
+   /// Whether this worker scans [firstTuple, nrTuples) alone
+   bool privateRange = false;
 
  public:
-   Scan(Shared& sm, size_t nrTuples, size_t vecSize);
+   Scan(Shared& sm, size_t begin, size_t end, size_t vecSize,
+        const runtime::BlockFilter* filter = nullptr,
+        const std::vector<size_t>& nodeBounds = {});
    /// Add consumer to scan operator, typeSize is size of
    /// type pointed to by colPtr
    void addConsumer(void** colPtr, size_t typeSize);
+   /// Add consumer of a bit packed column, colPtr points to the unpacked
+   /// values of the current vector
+   void addPackedConsumer(void** colPtr, const runtime::PackedColumn* column);
+   /// Add the Bloom filter of a join probed by the scanned tuples with the
+   /// keys of the column keys. hash must be the hash function of the build
+   /// side. Tuples which fail the filter are not passed on.
+   void addJoinFilter(const runtime::BloomFilter* filter, const void* keys,
+                      size_t typeSize, primitives::F2 hash);
+   /// Lets tuner pick the vector size, bufferBytes are the bytes per tuple of
+   /// the intermediate buffers the pipeline touches besides the columns
+   void tuneVectorSize(std::unique_ptr<VectorSizeTuner> tuner,
+                       std::shared_ptr<const size_t> bufferBytes);
+   /// Scanned tuples [rangeBegin(), rangeEnd()) of the relation
+   size_t rangeBegin() const { return firstTuple; }
+   size_t rangeEnd() const { return nrTuples; }
+   /// Restarts the scan on the tuples [begin, end), which are scanned by
+   /// this worker alone, for operators which split the relation among the
+   /// workers themselves. Ignores the zone map filter.
+   void scanPrivately(size_t begin, size_t end);
    virtual size_t next() override;
 };
 
@@ -188,11 +294,40 @@ class ResultWriter : public UnaryOperator {
 
 class Hashjoin : public BinaryOperator {
  public:
+   /// Whether the build side is radix partitioned before it is inserted into
+   /// the hashtable. Auto partitions build sides which exceed the last level
+   /// cache.
+   enum class Partitioning { Auto, Off, On };
+   /// Rows returned besides the pairs of tuples with equal keys, left is the
+   /// probe side. Semi joins return every probe with a partner once, anti
+   /// joins only the probes without partner, without build values. Left
+   /// outer joins add the probes without partner with zero build values,
+   /// right outer joins add the build entries without partner once the probe
+   /// side is exhausted, their probe values are undefined.
+   enum class Mode { Inner, LeftSemi, LeftAnti, LeftOuter, RightOuter };
+
    struct Shared : public SharedState {
       std::atomic<size_t> found;
       std::atomic<bool> sizeIsSet;
       runtime::Hashmap ht;
-      Shared() : found(0), sizeIsSet(false){};
+      /// Radix bits of the partitioned build, 0 if it is not partitioned.
+      /// Partitions are the high bits of the slot of an entry, so that every
+      /// partition owns a contiguous range of slots.
+      unsigned radixBits = 0;
+      struct Run
+      /// Partitioned entries of one worker, partition p spans the entries
+      /// [bounds[p], bounds[p + 1]) of data
+      {
+         uint8_t* data;
+         std::vector<size_t> bounds;
+      };
+      std::mutex runsMutex;
+      std::vector<Run> runs;
+      /// Next partition to be inserted into ht
+      std::atomic<size_t> nextPartition;
+      /// Bloom filter of the build hashes, pushed into probe side scans
+      runtime::BloomFilter filter;
+      Shared() : found(0), sizeIsSet(false), nextPartition(0){};
    };
 
    struct IteratorContinuation
@@ -236,6 +371,19 @@ class Hashjoin : public BinaryOperator {
    Expression keyEquality;
    pos_t* probeSel = nullptr;
    pos_t* probeMatches;
+   Partitioning partitioning = Partitioning::Auto;
+   /// Whether the build fills the Bloom filter of the build hashes
+   bool buildFilter = false;
+   const runtime::BloomFilter& filter() const { return shared.filter; }
+   /// Probes of the current vector, clustered by the partition of their hash
+   pos_t* probeOrder;
+   Mode mode = Mode::Inner;
+   /// If set, receives 1 for every returned row with a join partner and 0
+   /// for the rows outer joins add
+   int32_t* matchFlags = nullptr;
+   /// Offset of the byte of build entries which marks that they found a
+   /// partner, only used by right outer joins
+   size_t matchedOffset = 0;
 
    /// function which computes join result into buildMatches and probeMatches
    pos_t (Hashjoin::*join)();
@@ -249,6 +397,9 @@ class Hashjoin : public BinaryOperator {
    /// computes join result into buildMatches and probeMatches
    /// Implementation: Using AVX 512 SIMD
    pos_t joinAllSIMD();
+   /// computes join result into buildMatches and probeMatches
+   /// Implementation: Using AVX2 SIMD, 4 probes at a time
+   pos_t joinAllSIMDAVX2();
    /// computes join result into buildMatches and probeMatches, respecting
    /// selection vector probeSel for probe side
    pos_t joinSel();
@@ -260,9 +411,56 @@ class Hashjoin : public BinaryOperator {
    /// selection vector probeSel for probe side
    /// Implementation: For SkylakeX using AVX512
    pos_t joinSelSIMD();
+   /// computes join result into buildMatches and probeMatches, respecting
+   /// selection vector probeSel for probe side
+   /// Implementation: Using AVX2 SIMD, 4 probes at a time
+   pos_t joinSelSIMDAVX2();
+   /// joinAllSIMDAVX2 and joinSelSIMDAVX2, with probeSel if selection is set
+   template <bool selection> SIMD_AVX2 pos_t joinSIMDAVX2();
+   /// computes join result into buildMatches and probeMatches, respecting
+   /// probeSel if it is set. Probes partition by partition of a radix
+   /// partitioned build, replaces the scalar join functions for them.
+   pos_t joinPartitioned();
+   /// computes the probes of semi and anti joins into probeMatches, checks
+   /// the keys itself and stops at the first partner of a probe
+   pos_t joinSemi();
 
    virtual size_t next() override;
    ~Hashjoin();
+
+ private:
+   /// Radix bits for a build side of n entries in ht, 0 to not partition it
+   unsigned radixBits(size_t n);
+   /// Radix partitions the entries built by this worker into a run of shared
+   void partitionEntries();
+   /// Inserts the partitions claimed by this worker into the hashtable
+   void insertPartitions();
+   /// Clusters the probes of the current vector into probeOrder
+   void clusterProbes();
+   /// Adds the hashes of the entries built by this worker to shared.filter
+   void fillFilter();
+   /// Whether the join returns probes without partner
+   bool preservesProbes() const {
+      return mode == Mode::LeftAnti || mode == Mode::LeftOuter;
+   }
+   /// Marks the partners of the n rows in buildMatches and probeMatches
+   void markMatches(pos_t n);
+   /// Computes the probes of the finished vector without partner
+   pos_t probeOuter();
+   /// Computes the next build entries of this worker without partner
+   pos_t buildOuter();
+
+   /// Build side of the probes without partner, all values are zero
+   std::vector<uint64_t> nullEntry;
+   /// Marks the probes of the current vector with partner, by position
+   std::vector<uint8_t> probeMatched;
+   /// Whether the probes without partner of the current vector are pending
+   bool probeOuterPending = false;
+   /// Whether the probe side is exhausted
+   bool probeDone = false;
+   /// Position of buildOuter in allocations
+   size_t outerBlock = 0;
+   size_t outerEntry = 0;
 };
 
 class HashGroup : public UnaryOperator {
@@ -276,6 +474,8 @@ class HashGroup : public UnaryOperator {
    using EntryHeader = runtime::Hashmap::EntryHeader;
 
    size_t nrPartitions;
+   /// Estimated number of groups, 0 if unknown
+   size_t expectedGroups = 0;
 
    size_t vecSize;
    runtime::ResetableAllocator groupStore;
@@ -288,6 +488,8 @@ class HashGroup : public UnaryOperator {
 
    HashGroup(Shared& shared);
    ~HashGroup();
+   /// Sizes the hashtable for about groups groups
+   void expectGroups(size_t groups);
 
    std::unique_ptr<runtime::HashmapSmall<pos_t, pos_t>> groupHt;
 
@@ -409,6 +611,202 @@ class HashGroup : public UnaryOperator {
    void clearHashtable();
 };
 
+class Sort : public UnaryOperator
+/// Sorts its input by normalized keys, which compare with memcmp. Every
+/// worker sorts the rows it consumed, then the sorted runs of all workers are
+/// merged in parallel, one range of the key space per worker at a time. The
+/// sorted output is returned by a single worker, the others return
+/// EndOfStream, so operators above a large Sort run on one worker only.
+{
+ public:
+   struct Shared : public SharedState {
+      std::mutex runsMutex;
+      /// Sorted rows of each worker
+      std::vector<const std::vector<uint8_t*>*> runs;
+      /// Part p of the merge consists of the rows [partBounds[p][r],
+      /// partBounds[p + 1][r]) of every run r, it is written to sorted from
+      /// partOffsets[p] on
+      std::vector<std::vector<size_t>> partBounds;
+      std::vector<size_t> partOffsets;
+      std::atomic<size_t> nextPart;
+      /// Rows of all workers in key order
+      std::vector<uint8_t*> sorted;
+      std::atomic<bool> emitting;
+      Shared() : nextPart(0), emitting(false) {}
+   };
+   /// Parts of the merge per run, more parts than workers balance the merge
+   static const size_t partsPerRun = 4;
+
+   /// Bytes of the normalized keys at the start of each row, a multiple of 8
+   size_t keySize = 8;
+   size_t rowSize = 0;
+   size_t vecSize;
+   /// Normalizes the keys and scatters the values of the input into rows
+   /// from scatterStart on
+   Aggregates materialize;
+   uint8_t* scatterStart;
+   /// Gathers the values of the rows in rowPtrs
+   Aggregates gather;
+   uint8_t** rowPtrs;
+
+   Sort(Shared& s);
+   virtual size_t next() override;
+   /// Whether the key of row a orders before the key of row b
+   bool less(const uint8_t* a, const uint8_t* b) const {
+      for (size_t i = 0; i < keySize; i += 8) {
+         uint64_t x, y;
+         std::memcpy(&x, a + i, 8);
+         std::memcpy(&y, b + i, 8);
+         if (x != y) return __builtin_bswap64(x) < __builtin_bswap64(y);
+      }
+      return false;
+   }
+   /// Splits the merge of shared.runs into parts, called by one worker
+   virtual void planMerge();
+   /// Merges part of the runs into shared.sorted
+   void mergePart(size_t part);
+
+ protected:
+   Shared& shared;
+   /// Rows consumed by this worker
+   std::vector<uint8_t*> rows;
+   bool consumed = false;
+   /// Whether this worker returns the sorted rows
+   bool emitter = false;
+   size_t outputPos = 0;
+   /// Materializes the n tuples of the current input vector into rows from
+   /// out on
+   void materializeRows(size_t n, uint8_t* out);
+   /// Collects the rows of the child into rows, in key order
+   virtual void consume();
+};
+
+class TopK : public Sort
+/// Sort which only returns the first limit rows. Every worker keeps its
+/// first limit rows in a heap, the heaps are merged by one worker.
+{
+   /// Storage of the rows in the heap
+   std::vector<uint8_t> heapRows;
+   /// Rows of the current input vector
+   std::vector<uint8_t> vectorRows;
+
+ protected:
+   virtual void consume() override;
+
+ public:
+   size_t limit;
+   TopK(Shared& s, size_t limit);
+   virtual void planMerge() override;
+};
+
+class MergeJoin : public BinaryOperator
+/// Equi join of inputs which are ordered by the join key, like relations
+/// sorted by it or lineitem and orders clustered on orderkey. Both relations
+/// are split into key ranges, which the workers claim and join by merging
+/// the normalized keys (see primitives::normalize), without any hashtable.
+/// As in Hashjoin, left is the build side and right the probe side, and the
+/// matches are returned like Hashjoin returns them: the rows of the build
+/// tuples in buildMatches and the positions of the probe tuples in
+/// probeMatches.
+{
+ public:
+   struct Side {
+      /// Scan of the relation, restarted on the tuples of every key range
+      Scan* scan = nullptr;
+      struct Key {
+         /// Normalize primitive of the key, one of them is set
+         primitives::FScatter normalize;
+         primitives::FScatterSel normalizeSel;
+         const uint8_t* column;
+         size_t typeSize;
+         size_t offset;
+      };
+      std::vector<Key> keys;
+      /// Bytes of the keys
+      size_t keyBytes = 0;
+      /// Writes the normalized key of tuple i of the relation to out
+      void normalizeTuple(size_t i, uint8_t* out, size_t keySize) const;
+   };
+   struct Shared : public SharedState {
+      /// Range r consists of the probe tuples [probeBounds[r],
+      /// probeBounds[r + 1]) and the build tuples [buildBounds[r],
+      /// buildBounds[r + 1])
+      std::vector<size_t> probeBounds;
+      std::vector<size_t> buildBounds;
+      std::atomic<size_t> nextRange;
+      Shared() : nextRange(0) {}
+   };
+   /// Key ranges per worker, more ranges than workers balance skew
+   static const size_t rangesPerWorker = 8;
+
+   Side probe;
+   Side build;
+   /// Bytes of the normalized keys, a multiple of 8
+   size_t keySize = 8;
+   /// Build rows consist of the normalized key and the build values
+   size_t rowSize = 0;
+   /// Capacity of the match buffers and the build and probe vectors
+   size_t batchSize;
+   /// Normalizes the keys of the probe vector to probeKeys
+   Aggregates probeNormalize;
+   uint8_t* probeKeys = nullptr;
+   /// Selection vector of the probe side, may be null
+   pos_t* probeSel = nullptr;
+   /// Normalizes the keys and scatters the values of the build vector into
+   /// rows from scatterStart on
+   Aggregates buildScatter;
+   uint8_t* scatterStart;
+   Aggregates buildGather;
+   uint8_t** buildMatches;
+   pos_t* probeMatches;
+
+   MergeJoin(Shared& s);
+   virtual size_t next() override;
+   /// Splits both relations into key ranges, called by one worker
+   void planRanges();
+
+ private:
+   Shared& shared;
+   bool planned = false;
+   /// Whether a key range was claimed and its probe side is not exhausted
+   bool rangeOpen = false;
+   std::vector<uint8_t> probeKeyBuffer;
+   size_t probeSize = 0;
+   size_t probePos = 0;
+   /// Whether matches of the build rows from matchPos on are emitted for the
+   /// probe tuple at probePos
+   bool matching = false;
+   /// Normalized key of the last tuple of the previous probe vector
+   std::vector<uint8_t> lastProbeKey;
+   /// Build rows of the range which were not passed by the probe side yet:
+   /// the first with a key not less than the current probe key is at
+   /// groupBegin
+   std::vector<uint8_t*> buildRows;
+   size_t groupBegin = 0;
+   size_t matchPos = 0;
+   bool buildDone = false;
+   /// Blocks of build rows with their number of rows, the rows of a block
+   /// are freed once the probe side passed all of them
+   std::deque<std::pair<std::unique_ptr<uint8_t[]>, size_t>> blocks;
+   std::vector<std::unique_ptr<uint8_t[]>> spareBlocks;
+
+   /// First tuple in [begin, end) of side with a normalized key not less
+   /// than key
+   size_t lowerBound(const Side& side, size_t begin, size_t end,
+                     const uint8_t* key, uint8_t* buffer) const;
+   /// Next probe vector with normalized keys, claims the next key range
+   /// when the current one is done
+   size_t nextProbe();
+   /// Adds the rows of the next build vector of the range to buildRows,
+   /// false if the range has no more build tuples
+   bool nextBuild();
+   /// Frees the blocks of rows before groupBegin
+   void dropBuildRows();
+   int compare(const uint8_t* a, const uint8_t* b) const {
+      return std::memcmp(a, b, keySize);
+   }
+};
+
 template <typename T>
 pos_t INTERPRET_SEPARATE
 HashGroup::GroupLookup<T>::htLookup(pos_t n, runtime::Hashmap& ht) {
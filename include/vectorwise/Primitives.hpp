@@ -6,7 +6,12 @@
 #include "common/runtime/Util.hpp"
 #include "vectorwise/VectorAllocator.hpp"
 #include "vectorwise/defs.hpp"
+#include <algorithm>
+#include <string>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 // #include "/home/kersten/tools/iaca-lin64/iacaMarks.h"
 
 namespace vectorwise {
@@ -137,6 +142,77 @@ pos_t selsel_col_col_bf(pos_t n, pos_t* RES inSel, pos_t* RES result,
    return result - rStart;
 }
 
+//------------------------------------------------------------------------------
+//--- bitmap selection templates
+// A bitmap selects tuple i of a vector by bit i % 64 of word i / 64, the bits
+// past the end of the vector are zero. Bitmap primitives evaluate densely and
+// return the number of tuples n instead of the number of selected ones, so
+// they chain like projections. bitmap_to_sel converts to a selection vector.
+
+/// Bitmap words of a vector of n tuples
+inline uint64_t bitmapWords(uint64_t n) { return (n + 63) / 64; }
+
+template <typename T, template <typename> class Op>
+inline uint64_t selectWord(const T* RES input, T con, uint64_t count)
+/// bitmap word of the first count <= 64 values of input compared to con
+{
+   uint64_t bits = 0;
+   for (uint64_t j = 0; j < count; ++j)
+      bits |= uint64_t(Op<T>()(input[j], con)) << j;
+   return bits;
+}
+
+/// Number of tuples selected by bitmap
+inline uint64_t countSelected(pos_t n, const uint64_t* RES bitmap) {
+   uint64_t count = 0;
+   for (uint64_t w = 0; w < bitmapWords(n); ++w)
+      count += __builtin_popcountll(bitmap[w]);
+   return count;
+}
+
+template <typename F>
+inline void forEachSelected(pos_t n, const uint64_t* RES bitmap, F f)
+/// calls f for each tuple selected by bitmap in order, without testing the
+/// bits of words which select all of their tuples
+{
+   for (uint64_t w = 0; w < bitmapWords(n); ++w) {
+      auto bits = bitmap[w];
+      const auto base = w * 64;
+      if (bits == ~uint64_t(0))
+         for (uint64_t i = base; i < base + 64; ++i) f(i);
+      else
+         for (; bits; bits &= bits - 1) f(base + __builtin_ctzll(bits));
+   }
+}
+
+template <typename T, template <typename> class Op>
+pos_t selbm_col_val(pos_t n, uint64_t* RES result, T* RES param1,
+                    T* RES param2)
+/// select with column and constant into a bitmap
+{
+   const auto con = *param2;
+   for (uint64_t w = 0; w < bitmapWords(n); ++w)
+      result[w] = selectWord<T, Op>(param1 + w * 64, con,
+                                    std::min<uint64_t>(64, n - w * 64));
+   return n;
+}
+
+template <typename T, template <typename> class Op>
+pos_t selbmbm_col_val(pos_t n, uint64_t* RES inBitmap, uint64_t* RES result,
+                      T* RES param1, T* RES param2)
+/// select with input bitmap and column and constant into a bitmap, skipping
+/// words without selected tuples
+{
+   const auto con = *param2;
+   for (uint64_t w = 0; w < bitmapWords(n); ++w) {
+      const auto in = inBitmap[w];
+      result[w] = in ? in & selectWord<T, Op>(param1 + w * 64, con,
+                                              std::min<uint64_t>(64, n - w * 64))
+                     : 0;
+   }
+   return n;
+}
+
 //------------------------------------------------------------------------------
 //--- projection templates
 template <typename T, template <typename> class Op>
@@ -165,6 +241,31 @@ pos_t proj_col_col(pos_t n, T* RES result, T* RES param1, T* RES param2)
    return n;
 }
 
+template <typename T, template <typename> class Op>
+pos_t proj_bm_col_val(pos_t n, uint64_t* RES bitmap, T* RES result,
+                      T* RES param1, T* RES param2)
+/// project with input bitmap and column and constant, only the selected
+/// tuples of result are written
+{
+   const auto constant = *param2;
+   forEachSelected(n, bitmap, [&](uint64_t i) {
+      result[i] = Op<T>()(param1[i], constant);
+   });
+   return n;
+}
+
+template <typename T, template <typename> class Op>
+pos_t proj_bm_col_col(pos_t n, uint64_t* RES bitmap, T* RES result,
+                      T* RES param1, T* RES param2)
+/// project with input bitmap and two columns, only the selected tuples of
+/// result are written
+{
+   forEachSelected(n, bitmap, [&](uint64_t i) {
+      result[i] = Op<T>()(param1[i], param2[i]);
+   });
+   return n;
+}
+
 template <typename T, template <typename> class Op>
 pos_t proj_sel_col_val(pos_t n, pos_t* RES inSel, T* RES result, T* RES param1,
                        T* RES param2)
@@ -259,6 +360,25 @@ pos_t apply_sel_col(pos_t n, R* RES result, pos_t* RES inSel, T* RES param1)
    return n;
 }
 
+template <typename N, typename W>
+pos_t widen_col(pos_t n, W* RES result, N* RES param1, int64_t* RES base)
+/// widen narrow column to W, adding the base of its encoding
+{
+   const W b = *base;
+   for (uint64_t i = 0; i < n; ++i) result[i] = W(param1[i]) + b;
+   return n;
+}
+
+template <typename N, typename W>
+pos_t widen_sel_col(pos_t n, pos_t* RES inSel, W* RES result, N* RES param1,
+                    int64_t* RES base)
+/// widen narrow column to W with input selection vector
+{
+   const W b = *base;
+   for (uint64_t i = 0; i < n; ++i) result[i] = W(param1[inSel[i]]) + b;
+   return n;
+}
+
 //------------------------------------------------------------------------------
 //--- aggregation templates
 template <typename T, template <typename> class Op>
@@ -285,6 +405,19 @@ pos_t aggr_static_sel_col(pos_t n, pos_t* RES inSel, T* RES result,
    return n;
 }
 
+template <typename T, template <typename> class Op>
+pos_t aggr_static_bm_col(pos_t n, uint64_t* RES bitmap, T* RES result,
+                         T* RES param1)
+/// aggregate the tuples of column selected by bitmap into single value
+{
+   auto aggregator = *result;
+   forEachSelected(n, bitmap, [&](uint64_t i) {
+      aggregator = Op<T>()(param1[i], aggregator);
+   });
+   *result = aggregator;
+   return n;
+}
+
 template <typename T, template <typename> class Op>
 pos_t aggr_col(pos_t n, T* RES entries[], T* RES param1, size_t offset)
 /// aggregate into multiple aggregators given by result
@@ -423,6 +556,60 @@ pos_t gather_val(pos_t n, T** RES input, size_t offset, size_t* struct_size,
    return n;
 }
 
+//------------------------------------------------------------------------------
+//--- normalized keys for sorting
+template <typename T> inline void normalizeKey(T value, uint8_t* RES out)
+/// writes value into sizeof(T) bytes which memcmp orders like the values
+{
+   using U = typename std::make_unsigned<T>::type;
+   auto bits = U(value);
+   // the sign bit is flipped, so that negative values come first
+   if (std::is_signed<T>::value) bits ^= U(1) << (sizeof(T) * 8 - 1);
+   for (size_t b = 0; b < sizeof(T); ++b)
+      out[b] = uint8_t(bits >> (8 * (sizeof(T) - 1 - b)));
+}
+inline void normalizeKey(types::Date value, uint8_t* RES out) {
+   normalizeKey(value.value, out);
+}
+template <unsigned maxLen>
+inline void normalizeKey(const types::Char<maxLen>& value, uint8_t* RES out) {
+   // shorter strings are padded with zeros and come first
+   std::memcpy(out, value.value, value.len);
+   std::memset(out + value.len, 0, sizeof(value) - value.len);
+}
+inline void normalizeKey(types::Char<1> value, uint8_t* RES out) {
+   out[0] = value.value;
+}
+
+template <typename T, bool descending>
+pos_t normalize(pos_t n, T* RES input, uint8_t** RES start, size_t* step,
+                size_t offset)
+/// scatters normalized keys of input into rows, complemented for descending
+/// order
+{
+   const auto s = *step;
+   auto current = *start + offset;
+   for (size_t i = 0; i < n; ++i, current += s) {
+      normalizeKey(input[i], current);
+      if (descending)
+         for (size_t b = 0; b < sizeof(T); ++b) current[b] = ~current[b];
+   }
+   return n;
+}
+
+template <typename T, bool descending>
+pos_t normalize_sel(pos_t n, pos_t* RES inSel, T* RES input,
+                    uint8_t** RES start, size_t* step, size_t offset) {
+   const auto s = *step;
+   auto current = *start + offset;
+   for (size_t i = 0; i < n; ++i, current += s) {
+      normalizeKey(input[inSel[i]], current);
+      if (descending)
+         for (size_t b = 0; b < sizeof(T); ++b) current[b] = ~current[b];
+   }
+   return n;
+}
+
 //------------------------------------------------------------------------------
 //--- hashing templates
 using hash_t = defs::hash_t;
@@ -474,7 +661,7 @@ pos_t rehash_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t hash8(pos_t n, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t hash8(pos_t n, hash_t* RES result, T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 8, "Can only be used for inputs types of size 8");
@@ -496,7 +683,7 @@ pos_t hash8(pos_t n, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t hash4(pos_t n, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t hash4(pos_t n, hash_t* RES result, T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -521,7 +708,7 @@ pos_t hash4(pos_t n, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t hash4_16(pos_t n, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t hash4_16(pos_t n, hash_t* RES result, T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -544,7 +731,7 @@ pos_t hash4_16(pos_t n, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t rehash4(pos_t n, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t rehash4(pos_t n, hash_t* RES result, T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -570,7 +757,7 @@ pos_t rehash4(pos_t n, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t rehash4_16(pos_t n, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t rehash4_16(pos_t n, hash_t* RES result, T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -594,7 +781,8 @@ pos_t rehash4_16(pos_t n, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t hash4_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t hash4_sel(pos_t n, pos_t* RES inSel, hash_t* RES result,
+                            T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -622,7 +810,8 @@ pos_t hash4_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t hash4_16_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t hash4_16_sel(pos_t n, pos_t* RES inSel, hash_t* RES result,
+                               T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -646,7 +835,8 @@ pos_t hash4_16_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t rehash4_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
+SIMD_AVX512 pos_t rehash4_sel(pos_t n, pos_t* RES inSel, hash_t* RES result,
+                              T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -674,8 +864,8 @@ pos_t rehash4_sel(pos_t n, pos_t* RES inSel, hash_t* RES result, T* RES input)
 }
 
 template <typename T, typename Op>
-pos_t rehash4_16_sel(pos_t n, pos_t* RES inSel, hash_t* RES result,
-                     T* RES input)
+SIMD_AVX512 pos_t rehash4_16_sel(pos_t n, pos_t* RES inSel, hash_t* RES result,
+                                 T* RES input)
 /// compute hash for input column
 {
    static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
@@ -699,6 +889,80 @@ pos_t rehash4_16_sel(pos_t n, pos_t* RES inSel, hash_t* RES result,
    }
    return n;
 }
+
+template <typename T, typename Op>
+SIMD_AVX2 pos_t hash4_avx2(pos_t n, hash_t* RES result, T* RES input)
+/// compute hash for input column, 4 values at a time
+{
+   static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
+   size_t rest = n % 4;
+   Vec4u seeds(seed);
+   for (uint64_t i = 0; i < n - rest; i += 4) {
+      Vec4u in(_mm256_cvtepi32_epi64(
+          _mm_loadu_si128((const __m128i*)(input + i))));
+      _mm256_storeu_si256((__m256i*)(result + i), Op().hashKey(in, seeds));
+   }
+   for (uint64_t i = n - rest; i < n; ++i) result[i] = Op()(input[i], seed);
+   return n;
+}
+
+template <typename T, typename Op>
+SIMD_AVX2 pos_t hash4_sel_avx2(pos_t n, pos_t* RES inSel, hash_t* RES result,
+                               T* RES input)
+/// compute hash for input column with selection vector, 4 values at a time
+{
+   static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
+   size_t rest = n % 4;
+   Vec4u seeds(seed);
+   for (uint64_t i = 0; i < n - rest; i += 4) {
+      auto inSels = _mm_loadu_si128((const __m128i*)(inSel + i));
+      Vec4u in(_mm256_cvtepi32_epi64(
+          _mm_i32gather_epi32((const int*)input, inSels, 4)));
+      _mm256_storeu_si256((__m256i*)(result + i), Op().hashKey(in, seeds));
+   }
+   for (uint64_t i = n - rest; i < n; ++i)
+      result[i] = Op()(input[inSel[i]], seed);
+   return n;
+}
+
+template <typename T, typename Op>
+SIMD_AVX2 pos_t rehash4_avx2(pos_t n, hash_t* RES result, T* RES input)
+/// compute hash for input column, taking the value in result as seed, 4
+/// values at a time
+{
+   static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
+   size_t rest = n % 4;
+   for (uint64_t i = 0; i < n - rest; i += 4) {
+      Vec4u seeds(result + i);
+      Vec4u in(_mm256_cvtepi32_epi64(
+          _mm_loadu_si128((const __m128i*)(input + i))));
+      _mm256_storeu_si256((__m256i*)(result + i), Op().hashKey(in, seeds));
+   }
+   for (uint64_t i = n - rest; i < n; ++i)
+      result[i] = Op()(input[i], result[i]);
+   return n;
+}
+
+template <typename T, typename Op>
+SIMD_AVX2 pos_t rehash4_sel_avx2(pos_t n, pos_t* RES inSel, hash_t* RES result,
+                                 T* RES input)
+/// compute hash for input column with selection vector, taking the value in
+/// result as seed, 4 values at a time
+{
+   static_assert(sizeof(T) == 4, "Can only be used for inputs types of size 4");
+   size_t rest = n % 4;
+   for (uint64_t i = 0; i < n - rest; i += 4) {
+      Vec4u seeds(result + i);
+      auto inSels = _mm_loadu_si128((const __m128i*)(inSel + i));
+      Vec4u in(_mm256_cvtepi32_epi64(
+          _mm_i32gather_epi32((const int*)input, inSels, 4)));
+      _mm256_storeu_si256((__m256i*)(result + i), Op().hashKey(in, seeds));
+   }
+   for (uint64_t i = n - rest; i < n; ++i)
+      result[i] = Op()(input[inSel[i]], result[i]);
+   return n;
+}
+
 //------------------------------------------------------------------------------
 //--- key equality check for hashjoin
 template <typename T, template <typename> class Op>
@@ -1130,6 +1394,10 @@ using Varchar_55 = types::Varchar<55>;
 #define EACH_TYPE(m, c) EACH_TYPE_BASIC(m, c) EACH_TYPE_FULL(m, c)
 
 #define NIL(t, m) m(t)
+/// narrow physical types and the types they widen to
+#define EACH_NARROW(m)                                                         \
+   m(int8_t, int32_t) m(int8_t, int64_t) m(int16_t, int32_t)                   \
+       m(int16_t, int64_t) m(int32_t, int64_t)
 
 #define MK_SEL_COLCOL_DECL(type, op)                                           \
    extern F3 sel_##op##_##type##_col_##type##_col;
@@ -1150,6 +1418,10 @@ using Varchar_55 = types::Varchar<55>;
    extern F4 selsel_##op##_##type##_col_##type##_col_bf;
 #define MK_SELSEL_COLVAL_BF_DECL(type, op)                                     \
    extern F4 selsel_##op##_##type##_col_##type##_val_bf;
+#define MK_SELBM_COLVAL_DECL(type, op)                                         \
+   extern F3 selbm_##op##_##type##_col_##type##_val;
+#define MK_SELBMBM_COLVAL_DECL(type, op)                                       \
+   extern F4 selbmbm_##op##_##type##_col_##type##_val;
 
 #define MK_PROJ_COLCOL_DECL(type, op)                                          \
    extern F3 proj_##op##_##type##_col_##type##_col;
@@ -1169,11 +1441,20 @@ using Varchar_55 = types::Varchar<55>;
    extern F4 proj_sel_##op##_##type##_col_##type##_val;
 #define MK_PROJ_SEL_VALCOL_DECL(type, op)                                      \
    extern F4 proj_sel_##op##_##type##_val_##type##_col;
+#define MK_PROJ_BM_COLCOL_DECL(type, op)                                       \
+   extern F4 proj_bm_##op##_##type##_col_##type##_col;
+#define MK_PROJ_BM_COLVAL_DECL(type, op)                                       \
+   extern F4 proj_bm_##op##_##type##_col_##type##_val;
+#define MK_WIDEN_DECL(narrow, wide)                                            \
+   extern F3 widen_##narrow##_col_##wide;                                      \
+   extern F4 widen_sel_##narrow##_col_##wide;
 
 #define MK_AGGR_STATIC_COL_DECL(type, op)                                      \
    extern F2 aggr_static_##op##_##type##_col;
 #define MK_AGGR_STATIC_SEL_COL_DECL(type, op)                                  \
    extern F3 aggr_static_sel_##op##_##type##_col;
+#define MK_AGGR_STATIC_BM_COL_DECL(type, op)                                   \
+   extern F3 aggr_static_bm_##op##_##type##_col;
 #define MK_AGGR_COL_DECL(type, op) extern FAggr aggr_##op##_##type##_col;
 #define MK_AGGR_SEL_COL_DECL(type, op)                                         \
    extern FAggrSel aggr_sel_##op##_##type##_col;
@@ -1195,6 +1476,11 @@ using Varchar_55 = types::Varchar<55>;
 #define MK_GATHER_SEL_COL_DECL(type)                                           \
    extern FGatherSel gather_sel_col_##type##_col;
 #define MK_GATHER_VAL_DECL(type) extern FGatherVal gather_val_##type##_col;
+#define MK_NORMALIZE_DECL(type)                                                \
+   extern FScatter normalize_##type##_col;                                     \
+   extern FScatter normalize_desc_##type##_col;                                \
+   extern FScatterSel normalize_sel_##type##_col;                              \
+   extern FScatterSel normalize_sel_desc_##type##_col;
 
 #define MK_KEYS_EQUAL_DECL(type) extern EQCheck keys_equal_##type##_col;
 #define MK_KEYS_NOT_EQUAL_DECL(type)                                           \
@@ -1223,7 +1509,22 @@ EACH_COMP(EACH_TYPE, MK_SEL_COLVAL_BF_DECL)
 EACH_COMP(EACH_TYPE, MK_SELSEL_COLCOL_BF_DECL)
 EACH_COMP(EACH_TYPE, MK_SELSEL_COLVAL_BF_DECL)
 
+/// Selections into bitmaps, the int32_t and int64_t ones use the SIMD compares
+/// of runtime::cpu::isa()
+EACH_COMP(EACH_TYPE, MK_SELBM_COLVAL_DECL)
+EACH_COMP(EACH_TYPE, MK_SELBMBM_COLVAL_DECL)
+/// Conversions between bitmaps and selection vectors. bitmap_to_sel takes the
+/// number of tuples and returns the number of selected ones, sel_to_bitmap
+/// takes the number of selected ones and returns the number of tuples the
+/// bitmap covers, i.e. up to the last selected one
+extern F2 bitmap_to_sel;
+extern F2 sel_to_bitmap;
+
 extern F3 sel_contains_Varchar_55_col_Varchar_55_val;
+/// selects the hashes which may be contained in a runtime::BloomFilter,
+/// the selsel variant reads the hashes at the input selection
+extern F3 sel_bloom_hash_t_col;
+extern F4 selsel_bloom_hash_t_col;
 
 EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_COLCOL_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_COLVAL_DECL)
@@ -1234,17 +1535,23 @@ EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_SEL_COL_SEL_COL_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_SEL_COLVAL_DECL)
 EACH_ARITH_NON_COMM(EACH_TYPE_FULL, MK_PROJ_VALCOL_DECL)
 EACH_ARITH_NON_COMM(EACH_TYPE_FULL, MK_PROJ_SEL_VALCOL_DECL)
+EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_BM_COLCOL_DECL)
+EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_BM_COLVAL_DECL)
 
 extern F2 apply_extract_year_col;
 extern F3 apply_extract_year_sel_col;
+EACH_NARROW(MK_WIDEN_DECL)
 
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_STATIC_COL_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_STATIC_SEL_COL_DECL)
+EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_STATIC_BM_COL_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_COL_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_SEL_COL_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_ROW_DECL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_INIT_DECL)
 extern F1 aggr_static_count_star;
+/// counts the tuples selected by a bitmap
+extern F2 aggr_static_bm_count_star;
 extern FAggr aggr_count_star;
 
 EACH_TYPE(NIL, MK_HASH_DECL)
@@ -1259,6 +1566,7 @@ EACH_TYPE(NIL, MK_SCATTER_SEL_ROW_DECL)
 EACH_TYPE(NIL, MK_GATHER_COL_DECL)
 EACH_TYPE(NIL, MK_GATHER_SEL_COL_DECL)
 EACH_TYPE(NIL, MK_GATHER_VAL_DECL)
+EACH_TYPE(NIL, MK_NORMALIZE_DECL)
 
 EACH_TYPE(NIL, MK_KEYS_EQUAL_DECL)
 EACH_TYPE(NIL, MK_KEYS_NOT_EQUAL_DECL)
@@ -1270,8 +1578,7 @@ EACH_TYPE(NIL, MK_PARTITION_DECL);
 EACH_TYPE(NIL, MK_PARTITION_SEL_DECL);
 EACH_TYPE(NIL, MK_PARTITION_ROW_DECL);
 
-// Specializations
-#ifdef __AVX512F__
+// Specializations, only to be called if runtime::cpu::isa() permits
 extern F2 hash8_int64_t_col;
 // extern F3 hash8_sel_int64_t_col;
 // extern F2 rehash8_int64_t_col;
@@ -1292,7 +1599,33 @@ extern F4 selsel_greater_equal_int32_t_col_int32_t_val_avx512;
 extern F4 selsel_greater_equal_int64_t_col_int64_t_val_avx512;
 extern F4 selsel_less_int64_t_col_int64_t_val_avx512;
 extern F4 selsel_less_equal_int64_t_col_int64_t_val_avx512;
-#endif
+
+extern F2 hash4_int32_t_col_avx2;
+extern F3 hash4_sel_int32_t_col_avx2;
+extern F2 rehash4_int32_t_col_avx2;
+extern F3 rehash4_sel_int32_t_col_avx2;
+
+extern F4 proj_sel4_minus_int64_t_val_int64_t_col_avx2;
+extern F4 proj_sel4_plus_int64_t_col_int64_t_val_avx2;
+extern F3 proj4_multiplies_int64_t_col_int64_t_col_avx2;
+extern F4 proj4_multiplies_sel_int64_t_col_int64_t_col_avx2;
+
+extern F3 sel_less_int32_t_col_int32_t_val_avx2;
+extern F4 selsel_greater_equal_int32_t_col_int32_t_val_avx2;
+extern F4 selsel_greater_equal_int64_t_col_int64_t_val_avx2;
+extern F4 selsel_less_int64_t_col_int64_t_val_avx2;
+extern F4 selsel_less_equal_int64_t_col_int64_t_val_avx2;
+
+struct FlavorGroup
+/// Interchangeable implementations of a primitive, e.g. branching, branch
+/// free and SIMD selections
+{
+   std::string name;
+   /// The implementations with the name of their flavor
+   std::vector<std::pair<void*, std::string>> flavors;
+};
+/// Flavors of the primitive f, null if it has no alternatives
+const FlavorGroup* flavorsOf(void* f);
 } // namespace primitives
 } // namespace vectorwise
 
@@ -18,6 +18,9 @@ class QueryBuilder {
    SharedStateManager& operatorState;
    VectorAllocator vecs;
    std::unordered_map<size_t, std::pair<size_t, void*>> buffers;
+   /// Selection whose dense vectors the following Project and
+   /// FixedAggregation read from its bitmap
+   class Select* denseSelect = nullptr;
 
    struct DataStorage
    /// handle for data sources, e.g. base table columns or cache buffers
@@ -26,6 +29,8 @@ class QueryBuilder {
       size_t dataSize;
       void* data = nullptr;
       class Scan* scan = nullptr;
+      /// bit packed encoding of a column, unpacked by the scan
+      const runtime::PackedColumn* packed = nullptr;
       std::string attribute;
       void registerDS(void** location);
       void registerDS(pos_t** location);
@@ -52,11 +57,16 @@ class QueryBuilder {
       QueryBuilder& base;
       Project& project;
       ProjectionBuilder& addExpression(std::unique_ptr<Expression>&& exp);
+      /// Expression with its variant on the bitmap of the preceding
+      /// Select(exp, dense, bitmap)
+      ProjectionBuilder& addExpression(std::unique_ptr<Expression>&& exp,
+                                       std::unique_ptr<Expression>&& dense);
    };
 
    struct HashJoinBuilder {
       QueryBuilder& base;
       bool probeHasSelection = false;
+      bool probeSelPushed = false;
       std::deque<size_t> keyOffsets;
       void* buildHashBuffer = nullptr;
       void* probeHashBuffer = nullptr;
@@ -81,6 +91,48 @@ class QueryBuilder {
       setProbeSelVector(DS vec,
                         pos_t (Hashjoin::*join)() = &Hashjoin::joinSelParallel);
       B& pushProbeSelVector(DS sel, DS target);
+      /// Overrides the cost based choice whether to radix partition the
+      /// build side
+      B& setPartitioning(Hashjoin::Partitioning partitioning);
+      /// Pushes a Bloom filter of the build keys into the scan of the probe
+      /// key column col, hash is the hash function of the build keys. Only
+      /// valid if every scanned tuple without join partner may be dropped.
+      B& addProbeFilter(DS col, primitives::F2 hash);
+      /// Makes it a semi, anti or outer join, see Hashjoin::Mode
+      B& setMode(Hashjoin::Mode mode);
+      /// Writes 1 into the int32_t buffer target for returned rows with join
+      /// partner and 0 for the rows outer joins add
+      B& setMatchFlags(DS target);
+      /// Throws if a join filter was added to a join with more than one key,
+      /// the scan hashes only the filtered column
+      void checkFilterKeys();
+   };
+
+   struct MergeJoinBuilder {
+      QueryBuilder& base;
+      class MergeJoin* join;
+      MergeJoinBuilder(QueryBuilder& b);
+      ~MergeJoinBuilder();
+      using B = MergeJoinBuilder;
+
+      /// Adds the next key in order of significance to the build side, col
+      /// must be a column of the scan of the build side and normalize one of
+      /// the primitives::normalize primitives. Keys precede all values.
+      B& addBuildKey(DS col, primitives::FScatter normalize);
+      B& addBuildKey(DS col, DS sel, primitives::FScatterSel normalize);
+      /// Adds the next key to the probe side, like addBuildKey
+      B& addProbeKey(DS col, primitives::FScatter normalize);
+      B& addProbeKey(DS col, DS sel, primitives::FScatterSel normalize);
+      B& addBuildValue(DS source, primitives::FScatter scatter, DS target,
+                       primitives::FGather gather);
+      B& addBuildValue(DS source, DS sel, primitives::FScatterSel scatter,
+                       DS target, primitives::FGather gather);
+      /// Selection vector of the probe side, probeMatches then holds its
+      /// entries
+      B& setProbeSelVector(DS sel);
+
+    private:
+      void addKey(MergeJoin::Side& side, DS col);
    };
 
    struct HashGroupBuilder {
@@ -121,6 +173,9 @@ class QueryBuilder {
           primitives::FScatterSelRow scatterG,
           /**** output *****/
           primitives::FGatherVal gather, DS out);
+      /// Sizes the hashtable and the spill partitions for about groups
+      /// groups, e.g. from runtime::Relation::distinct
+      B& expectGroups(size_t groups);
       B& pushKeySelVec(DS sel, DS outBuf);
       B& addValue(DS col, primitives::FAggrInit aggrInit,
                   primitives::FAggr aggr, primitives::FAggrRow aggrGlobal,
@@ -132,6 +187,25 @@ class QueryBuilder {
       ~HashGroupBuilder();
    };
 
+   struct SortBuilder {
+      QueryBuilder& base;
+      class Sort* sort;
+      /// Bytes of the keys added so far
+      size_t keyBytes = 0;
+      SortBuilder(QueryBuilder& b);
+      ~SortBuilder();
+      using B = SortBuilder;
+
+      /// Adds the next key in order of significance, normalize is one of the
+      /// primitives::normalize primitives. Keys precede all values.
+      B& addKey(DS col, primitives::FScatter normalize);
+      B& addKey(DS col, DS sel, primitives::FScatterSel normalize);
+      B& addValue(DS source, primitives::FScatter scatter, DS target,
+                  primitives::FGather gather);
+      B& addValue(DS source, DS sel, primitives::FScatterSel scatter,
+                  DS target, primitives::FGather gather);
+   };
+
    struct ExpressionBuilder {
       std::unique_ptr<Expression> expression;
       using DS = DataStorage;
@@ -153,18 +227,41 @@ class QueryBuilder {
    size_t nextOnceNr();
 
    ResultBuilder Result();
-   ScanBuilder Scan(std::string relation);
+   /// Scan of relation, skipping blocks excluded by the zone map filter
+   ScanBuilder Scan(std::string relation,
+                    const runtime::BlockFilter* filter = nullptr);
+   /// Scan of the tuples [begin, end) of relation, e.g. the slice of a
+   /// sorted relation found by Relation::sortedRange
+   ScanBuilder Scan(std::string relation, size_t begin, size_t end,
+                    const runtime::BlockFilter* filter = nullptr);
    template <typename PAYLOAD>
    void Debug(std::function<void(size_t, PAYLOAD&)> step,
               std::function<void(PAYLOAD&)> finish);
    void DebugCounter(std::string message);
    void Select(std::unique_ptr<Expression>&& exp);
+   /// Selection which switches to dense, the same condition on bitmaps
+   /// ending in primitives::bitmap_to_sel, for high selectivities
+   void Select(std::unique_ptr<Expression>&& exp,
+               std::unique_ptr<Expression>&& dense);
+   /// Selection which switches to dense, with dense ending in bitmap. The
+   /// following projections and aggregation need variants on bitmap.
+   void Select(std::unique_ptr<Expression>&& exp,
+               std::unique_ptr<Expression>&& dense, DS bitmap);
    ProjectionBuilder Project();
    void FixedAggregation(std::unique_ptr<Aggregates>&& aggrs);
+   /// Aggregation with its variant on the bitmap of the preceding
+   /// Select(exp, dense, bitmap)
+   void FixedAggregation(std::unique_ptr<Aggregates>&& aggrs,
+                         std::unique_ptr<Aggregates>&& dense);
    HashJoinBuilder
    HashJoin(DS probeMatches,
             pos_t (Hashjoin::*join)() = &Hashjoin::joinAllParallel);
    HashGroupBuilder HashGroup();
+   /// Join of inputs ordered by the join key, see vectorwise::MergeJoin
+   MergeJoinBuilder MergeJoin(DS probeMatches);
+   SortBuilder Sort();
+   /// Sort which only returns the first limit tuples
+   SortBuilder TopK(size_t limit);
 
    ~QueryBuilder();
 
@@ -172,11 +269,20 @@ class QueryBuilder {
 
    DS Buffer(size_t nr, size_t entrySize);
    DS Buffer(size_t nr);
+   /// Buffer nr holding a selection bitmap of a vector
+   DS Bitmap(size_t nr);
    DS Column(ScanBuilder& scan, std::string attribute);
+   /// Dictionary codes of a dictionary encoded attribute
+   DS Codes(ScanBuilder& scan, std::string attribute);
+   /// Narrow values of an attribute with a narrow physical type, to be
+   /// compared with NarrowColumn::narrow constants or widened
+   DS Narrow(ScanBuilder& scan, std::string attribute);
    DS Value(void*);
 
    void pushOperator(std::unique_ptr<Operator>&& op);
    std::unique_ptr<Operator> popOperator();
+   /// Places sort on top of the operator stack
+   SortBuilder pushSort(std::unique_ptr<class Sort>&& sort);
 };
 
 template <typename PAYLOAD>
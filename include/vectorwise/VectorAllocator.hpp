@@ -4,6 +4,7 @@
 #include <cstdlib>
 
 #include <deque>
+#include <memory>
 
 namespace vectorwise {
 
@@ -27,17 +28,32 @@ class VectorAllocator
 /// allocator for buffers
 {
    size_t vectorSize;
+   /// Bytes per tuple of all buffers handed out, the working set of the
+   /// vectors besides the scanned columns
+   std::shared_ptr<size_t> tupleBytes = std::make_shared<size_t>(0);
+   /// Number of bitmaps handed out, 8 of them take a byte per tuple
+   size_t bitmaps = 0;
 
  public:
    /// Get a standard buffer
    inline void* get(size_t elementSize) {
+      *tupleBytes += elementSize;
       return runtime::this_worker->allocator.allocate(vectorSize * elementSize);
    }
+   /// Selection bitmap of a vector, one bit per tuple
+   inline uint64_t* getBitmap() {
+      if (bitmaps++ % 8 == 0) *tupleBytes += 1;
+      auto words = (vectorSize + 63) / 64;
+      return reinterpret_cast<uint64_t*>(
+          runtime::this_worker->allocator.allocate(words * sizeof(uint64_t)));
+   }
    inline void* getPlus1(size_t elementSize) {
+      *tupleBytes += elementSize;
       return runtime::this_worker->allocator.allocate((vectorSize + 1) *
                                                       elementSize);
    }
    inline SizeBuffer<void*>* getSizeBuffer(size_t elementSize) {
+     *tupleBytes += elementSize;
      auto alloc = runtime::this_worker->allocator.allocate(
          vectorSize * elementSize + sizeof(SizeBuffer<void*>));
      new (alloc) SizeBuffer<void*>();
@@ -45,5 +61,7 @@ class VectorAllocator
    }
    VectorAllocator(size_t vecSize) : vectorSize(vecSize) {}
    inline size_t getVecSize() { return vectorSize; }
+   /// Bytes per tuple of the buffers, grows as further buffers are handed out
+   std::shared_ptr<const size_t> getTupleBytes() { return tupleBytes; }
 };
 }
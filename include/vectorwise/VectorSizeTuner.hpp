@@ -0,0 +1,69 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+
+namespace vectorwise {
+
+/// Vector size tuning of the pipelines, 0: the vector size of the query
+/// builder is used as is, 1: pipelines pick a vector size which fits their
+/// working set into the L2 cache, 2: the size is also refined while running
+extern unsigned tuneVectorSizes;
+
+/// Prints the vector sizes chosen per pipeline
+void printVectorSizeReport(std::ostream& out);
+
+class VectorSizeTuner
+/// Vector size of a pipeline, i.e. of the scan which drives it. The initial
+/// size is the largest power of two for which the vectors of the scanned
+/// columns and the intermediate buffers fill at most half of the L2 cache.
+/// Online refinement measures the cycles per tuple of the pipeline and
+/// doubles or halves the size as long as that gets cheaper.
+{
+ public:
+   static constexpr size_t minSize = 64;
+   /// Upper bound of the vector size of tuned queries
+   static constexpr size_t maxSize = 16 * 1024;
+   /// Vectors per measurement of the online refinement
+   static constexpr size_t window = 32;
+
+ private:
+   std::string name;
+   size_t capacity;
+   size_t initial = 0;
+   size_t current = 0;
+   bool online;
+   /// Refinement state: measuring the current size, trying a neighbour or
+   /// settled
+   enum class Phase { Measure, Probe, Settled } phase = Phase::Measure;
+   /// Size and cycles per tuple of the cheapest size measured so far
+   size_t bestSize = 0;
+   double bestCost = 0;
+   /// Doubling if true, halving otherwise
+   bool growing = true;
+   bool triedOtherDirection = false;
+   size_t vectors = 0;
+   uint64_t tuples = 0;
+   uint64_t cycles = 0;
+   /// Starts probing the next size in the current direction, false if that
+   /// is out of bounds
+   bool probeNext();
+
+ public:
+   /// Tunes the pipeline name with vectors of at most capacity tuples
+   VectorSizeTuner(std::string name, size_t capacity, bool online);
+   ~VectorSizeTuner();
+   /// Size of the L2 cache, detected once
+   static size_t l2Bytes();
+   /// Largest power of two between minSize and capacity whose vectors of
+   /// tupleBytes per tuple fill at most half of the L2 cache
+   static size_t fitting(size_t tupleBytes, size_t capacity);
+   /// Picks the initial size for a pipeline touching tupleBytes per tuple
+   void start(size_t tupleBytes);
+   size_t size() const { return current; }
+   /// Accounts the cycles the pipeline spent on a vector of n tuples, may
+   /// change size()
+   void measured(size_t n, uint64_t cycles);
+};
+} // namespace vectorwise
@@ -1,96 +1,109 @@
 #include "benchmarks/tpch/Queries.hpp"
+#include "common/runtime/Cpu.hpp"
 #include "vectorwise/Primitives.hpp"
 
+using runtime::cpu::Isa;
+using runtime::cpu::dispatch;
 
 ExperimentConfig conf;
 
 vectorwise::primitives::F2 ExperimentConfig::hash_int32_t_col() {
-#ifdef __AVX512F__
-   if (useSimdHash) return vectorwise::primitives::hash4_int32_t_col;
-#endif
+   if (useSimdHash)
+      return dispatch(vectorwise::primitives::hash4_int32_t_col,
+                      vectorwise::primitives::hash4_int32_t_col_avx2,
+                      vectorwise::primitives::hash_int32_t_col);
    return vectorwise::primitives::hash_int32_t_col;
 }
 vectorwise::primitives::F3 ExperimentConfig::hash_sel_int32_t_col() {
-#ifdef __AVX512F__
-   if (useSimdHash) return vectorwise::primitives::hash4_sel_int32_t_col;
-#endif
+   if (useSimdHash)
+      return dispatch(vectorwise::primitives::hash4_sel_int32_t_col,
+                      vectorwise::primitives::hash4_sel_int32_t_col_avx2,
+                      vectorwise::primitives::hash_sel_int32_t_col);
    return vectorwise::primitives::hash_sel_int32_t_col;
 }
 vectorwise::primitives::F2 ExperimentConfig::rehash_int32_t_col() {
-#ifdef __AVX512F__
-   if (useSimdHash) return vectorwise::primitives::rehash4_int32_t_col;
-#endif
+   if (useSimdHash)
+      return dispatch(vectorwise::primitives::rehash4_int32_t_col,
+                      vectorwise::primitives::rehash4_int32_t_col_avx2,
+                      vectorwise::primitives::rehash_int32_t_col);
    return vectorwise::primitives::rehash_int32_t_col;
 }
 vectorwise::primitives::F3 ExperimentConfig::rehash_sel_int32_t_col() {
-#ifdef __AVX512F__
-   if (useSimdHash) return vectorwise::primitives::rehash4_sel_int32_t_col;
-#endif
+   if (useSimdHash)
+      return dispatch(vectorwise::primitives::rehash4_sel_int32_t_col,
+                      vectorwise::primitives::rehash4_sel_int32_t_col_avx2,
+                      vectorwise::primitives::rehash_sel_int32_t_col);
    return vectorwise::primitives::rehash_sel_int32_t_col;
 }
 vectorwise::primitives::F4 ExperimentConfig::proj_sel_minus_int64_t_val_int64_t_col(){
-#ifdef __AVX512F__
   if (useSimdProj)
-  return vectorwise::primitives::proj_sel8_minus_int64_t_val_int64_t_col;
-#endif
+    return dispatch(vectorwise::primitives::proj_sel8_minus_int64_t_val_int64_t_col,
+                    vectorwise::primitives::proj_sel4_minus_int64_t_val_int64_t_col_avx2,
+                    vectorwise::primitives::proj_sel_minus_int64_t_val_int64_t_col);
   return vectorwise::primitives::proj_sel_minus_int64_t_val_int64_t_col;
 }
 vectorwise::primitives::F4 ExperimentConfig::proj_sel_plus_int64_t_col_int64_t_val(){
-#ifdef __AVX512F__
   if (useSimdProj)
-    return vectorwise::primitives::proj_sel8_plus_int64_t_col_int64_t_val;
-#endif
+    return dispatch(vectorwise::primitives::proj_sel8_plus_int64_t_col_int64_t_val,
+                    vectorwise::primitives::proj_sel4_plus_int64_t_col_int64_t_val_avx2,
+                    vectorwise::primitives::proj_sel_plus_int64_t_col_int64_t_val);
   return vectorwise::primitives::proj_sel_plus_int64_t_col_int64_t_val;
 }
 vectorwise::primitives::F3 ExperimentConfig::proj_multiplies_int64_t_col_int64_t_col(){
-#ifdef __AVX512VL__
   if (useSimdProj)
-  return vectorwise::primitives::proj8_multiplies_int64_t_col_int64_t_col;
-#endif
+    return dispatch(vectorwise::primitives::proj8_multiplies_int64_t_col_int64_t_col,
+                    vectorwise::primitives::proj4_multiplies_int64_t_col_int64_t_col_avx2,
+                    vectorwise::primitives::proj_multiplies_int64_t_col_int64_t_col);
   return vectorwise::primitives::proj_multiplies_int64_t_col_int64_t_col;
 }
 vectorwise::primitives::F4 ExperimentConfig::proj_multiplies_sel_int64_t_col_int64_t_col(){
-#ifdef __AVX512VL__
   if (useSimdProj)
-  return vectorwise::primitives::proj8_multiplies_sel_int64_t_col_int64_t_col;
-#endif
+    return dispatch(vectorwise::primitives::proj8_multiplies_sel_int64_t_col_int64_t_col,
+                    vectorwise::primitives::proj4_multiplies_sel_int64_t_col_int64_t_col_avx2,
+                    vectorwise::primitives::proj_multiplies_sel_int64_t_col_int64_t_col);
   return vectorwise::primitives::proj_multiplies_sel_int64_t_col_int64_t_col;
 }
 vectorwise::primitives::F3 ExperimentConfig::sel_less_int32_t_col_int32_t_val(){
-#ifdef __AVX512F__
-  if(useSimdSel) return vectorwise::primitives::sel_less_int32_t_col_int32_t_val_avx512;
-#endif
+  if(useSimdSel)
+    return dispatch(vectorwise::primitives::sel_less_int32_t_col_int32_t_val_avx512,
+                    vectorwise::primitives::sel_less_int32_t_col_int32_t_val_avx2,
+                    BF(vectorwise::primitives::sel_less_int32_t_col_int32_t_val));
   return BF(vectorwise::primitives::sel_less_int32_t_col_int32_t_val);
 }
 vectorwise::primitives::F4 ExperimentConfig::selsel_greater_equal_int32_t_col_int32_t_val() {
-#ifdef __AVX512F__
-  if(useSimdSel) return vectorwise::primitives::selsel_greater_equal_int32_t_col_int32_t_val_avx512;
-#endif
+  if(useSimdSel)
+    return dispatch(vectorwise::primitives::selsel_greater_equal_int32_t_col_int32_t_val_avx512,
+                    vectorwise::primitives::selsel_greater_equal_int32_t_col_int32_t_val_avx2,
+                    BF(vectorwise::primitives::selsel_greater_equal_int32_t_col_int32_t_val));
   return BF(vectorwise::primitives::selsel_greater_equal_int32_t_col_int32_t_val);
 }
 vectorwise::primitives::F4 ExperimentConfig::selsel_less_int64_t_col_int64_t_val() {
-#ifdef __AVX512F__
-  if(useSimdSel) return vectorwise::primitives::selsel_less_int64_t_col_int64_t_val_avx512;
-#endif
+  if(useSimdSel)
+    return dispatch(vectorwise::primitives::selsel_less_int64_t_col_int64_t_val_avx512,
+                    vectorwise::primitives::selsel_less_int64_t_col_int64_t_val_avx2,
+                    BF(vectorwise::primitives::selsel_less_int64_t_col_int64_t_val));
   return BF(vectorwise::primitives::selsel_less_int64_t_col_int64_t_val);
 }
 vectorwise::primitives::F4 ExperimentConfig::selsel_greater_equal_int64_t_col_int64_t_val() {
-#ifdef __AVX512F__
-  if(useSimdSel) return vectorwise::primitives::selsel_greater_equal_int64_t_col_int64_t_val_avx512;
-#endif
+  if(useSimdSel)
+    return dispatch(vectorwise::primitives::selsel_greater_equal_int64_t_col_int64_t_val_avx512,
+                    vectorwise::primitives::selsel_greater_equal_int64_t_col_int64_t_val_avx2,
+                    BF(vectorwise::primitives::selsel_greater_equal_int64_t_col_int64_t_val));
   return BF(vectorwise::primitives::selsel_greater_equal_int64_t_col_int64_t_val);
 }
 vectorwise::primitives::F4 ExperimentConfig::selsel_less_equal_int64_t_col_int64_t_val() {
-#ifdef __AVX512F__
-  if(useSimdSel) return vectorwise::primitives::selsel_less_equal_int64_t_col_int64_t_val_avx512;
-#endif
+  if(useSimdSel)
+    return dispatch(vectorwise::primitives::selsel_less_equal_int64_t_col_int64_t_val_avx512,
+                    vectorwise::primitives::selsel_less_equal_int64_t_col_int64_t_val_avx2,
+                    BF(vectorwise::primitives::selsel_less_equal_int64_t_col_int64_t_val));
   return BF(vectorwise::primitives::selsel_less_equal_int64_t_col_int64_t_val);
 }
 
 ExperimentConfig::joinFun ExperimentConfig::joinAll() {
-#ifdef __AVX512F__
-  if (useSimdJoin) return &vectorwise::Hashjoin::joinAllSIMD;
-#endif
+  if (useSimdJoin && runtime::cpu::isa() != Isa::Scalar)
+    return dispatch(&vectorwise::Hashjoin::joinAllSIMD,
+                    &vectorwise::Hashjoin::joinAllSIMDAVX2,
+                    &vectorwise::Hashjoin::joinAllParallel);
   char* v;
   if ((v = std::getenv("JoinBoncz")) && atoi(v) != 0)
     return &vectorwise::Hashjoin::joinBoncz;
@@ -98,8 +111,9 @@ ExperimentConfig::joinFun ExperimentConfig::joinAll() {
 }
 
 ExperimentConfig::joinFun ExperimentConfig::joinSel() {
-#ifdef __AVX512F__
-  if (useSimdJoin) return &vectorwise::Hashjoin::joinSelSIMD;
-#endif
+  if (useSimdJoin)
+    return dispatch(&vectorwise::Hashjoin::joinSelSIMD,
+                    &vectorwise::Hashjoin::joinSelSIMDAVX2,
+                    &vectorwise::Hashjoin::joinSelParallel);
   return &vectorwise::Hashjoin::joinSelParallel;
 }
@@ -0,0 +1,193 @@
+#include "common/runtime/Tokenizer.hpp"
+#include "common/runtime/Types.hpp"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/// Micro benchmark for the .tbl field parser: compares the getline and
+/// find_first_of based field splitting with the structural index of
+/// runtime::findDelimiters. Parses lineitem rows, either from the .tbl file
+/// given as first argument or from generated data.
+
+template <typename T>
+void castInto(const char* str, uint32_t size, void* col, size_t row) {
+   reinterpret_cast<T*>(col)[row] = T::castString(str, size);
+}
+
+struct Column {
+   size_t typeSize;
+   void (*cast)(const char* str, uint32_t size, void* col, size_t row);
+   vector<char> data;
+};
+
+template <typename T> Column column() {
+   return {sizeof(T), &castInto<T>, {}};
+}
+
+vector<Column> lineitemColumns() {
+   using namespace types;
+   return {column<Integer>(),        column<Integer>(),
+           column<Integer>(),        column<Integer>(),
+           column<Numeric<12, 2>>(), column<Numeric<12, 2>>(),
+           column<Numeric<12, 2>>(), column<Numeric<12, 2>>(),
+           column<Char<1>>(),        column<Char<1>>(),
+           column<Date>(),           column<Date>(),
+           column<Date>(),           column<Char<25>>(),
+           column<Char<10>>(),       column<Varchar<44>>()};
+}
+
+string generateLineitem(size_t rows) {
+   mt19937 gen(1337);
+   uniform_int_distribution<int> key(1, 6000000), small(1, 50), day(10, 28);
+   const char* modes[] = {"TRUCK", "MAIL", "REG AIR", "SHIP", "AIR"};
+   ostringstream out;
+   for (size_t i = 0; i < rows; i++) {
+      auto date = "199" + to_string(small(gen) % 8) + "-0" +
+                  to_string(small(gen) % 9 + 1) + "-" +
+                  to_string(day(gen));
+      out << key(gen) << "|" << key(gen) / 30 << "|" << key(gen) / 600 << "|"
+          << small(gen) % 7 + 1 << "|" << small(gen) << ".00|" << key(gen)
+          << "." << small(gen) + 10 << "|0.0" << small(gen) % 10 << "|0.0"
+          << small(gen) % 8 << "|N|O|" << date << "|" << date << "|" << date
+          << "|DELIVER IN PERSON|" << modes[small(gen) % 5]
+          << "|ironic deposits haggle carefully|\n";
+   }
+   return out.str();
+}
+
+/// field splitting as done by the line based importer
+size_t parseGetline(const string& input, vector<Column>& cols) {
+   istringstream in(input);
+   string line;
+   size_t row = 0;
+   while (getline(in, line)) {
+      unsigned begin = 0, end;
+      for (auto& col : cols) {
+         end = line.find_first_of('|', begin);
+         col.cast(line.data() + begin, end - begin, col.data.data(), row);
+         begin = end + 1;
+      }
+      row++;
+   }
+   return row;
+}
+
+/// structural index only
+size_t tokenize(const string& input, vector<uint32_t>& delimiters) {
+   const size_t blockSize = 64 * 1024;
+   size_t found = 0;
+   for (size_t pos = 0; pos < input.size(); pos += blockSize) {
+      auto end = min(pos + blockSize, input.size());
+      found += runtime::findDelimiters(input.data() + pos, input.data() + end,
+                                       delimiters.data());
+   }
+   return found;
+}
+
+/// structural index followed by casts over the pre-split fields
+size_t parseIndexed(const string& input, vector<Column>& cols,
+                    vector<uint32_t>& delimiters) {
+   const size_t blockSize = 64 * 1024;
+   const char* pos = input.data();
+   const char* limit = input.data() + input.size();
+   size_t row = 0;
+   for (size_t block = blockSize; pos < limit;) {
+      auto blockEnd = pos + min(block, size_t(limit - pos));
+      if (delimiters.size() < block) delimiters.resize(block);
+      auto n = runtime::findDelimiters(pos, blockEnd, delimiters.data());
+      const char* field = pos;
+      const char* line = pos;
+      size_t column = 0;
+      for (size_t i = 0; i < n; i++) {
+         const char* delimiter = pos + delimiters[i];
+         if (column < cols.size())
+            cols[column].cast(field, delimiter - field,
+                              cols[column].data.data(), row);
+         column++;
+         field = delimiter + 1;
+         if (*delimiter == '\n') {
+            row++;
+            column = 0;
+            line = field;
+         }
+      }
+      if (blockEnd == limit && line < limit) {
+         // last line without '\n'
+         if (column < cols.size())
+            cols[column].cast(field, limit - field, cols[column].data.data(),
+                              row);
+         row++;
+         line = limit;
+      }
+      if (line == pos) {
+         // line does not fit into block
+         block *= 2;
+      } else {
+         pos = line;
+         block = blockSize;
+      }
+   }
+   return row;
+}
+
+template <typename F> double bestOf(size_t repetitions, F f) {
+   double best = 1e100;
+   for (size_t i = 0; i < repetitions; i++) {
+      auto start = chrono::steady_clock::now();
+      f();
+      chrono::duration<double> time = chrono::steady_clock::now() - start;
+      best = min(best, time.count());
+   }
+   return best;
+}
+
+int main(int argc, char* argv[]) {
+   string input;
+   if (argc > 1) {
+      ifstream file(argv[1]);
+      if (!file) {
+         cerr << "could not open " << argv[1] << endl;
+         return 1;
+      }
+      input.assign(istreambuf_iterator<char>(file),
+                   istreambuf_iterator<char>());
+   } else {
+      input = generateLineitem(1000000);
+   }
+   size_t rows = count(input.begin(), input.end(), '\n');
+   if (!input.empty() && input.back() != '\n') rows++;
+   auto cols = lineitemColumns();
+   for (auto& col : cols) col.data.resize(rows * col.typeSize);
+   vector<uint32_t> delimiters(64 * 1024);
+   const size_t repetitions = 5;
+   double gb = input.size() / 1e9;
+
+   size_t parsed = 0, found = 0;
+   auto tGetline = bestOf(repetitions,
+                          [&]() { parsed = parseGetline(input, cols); });
+   auto tTokenize = bestOf(repetitions,
+                           [&]() { found = tokenize(input, delimiters); });
+   auto tIndexed = bestOf(repetitions, [&]() {
+      parsed = min(parsed, parseIndexed(input, cols, delimiters));
+   });
+   if (parsed != rows) {
+      cerr << "parsed " << parsed << " of " << rows << " rows" << endl;
+      return 1;
+   }
+
+   cout << "path\tGB/s\trows/s" << endl;
+   cout << "getline+find_first_of\t" << gb / tGetline << "\t"
+        << rows / tGetline << endl;
+   cout << "findDelimiters (" << found << " fields)\t" << gb / tTokenize
+        << "\t" << rows / tTokenize << endl;
+   cout << "findDelimiters+cast\t" << gb / tIndexed << "\t" << rows / tIndexed
+        << endl;
+   return 0;
+}
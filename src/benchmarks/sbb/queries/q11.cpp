@@ -18,8 +18,27 @@ using namespace std;
 
 namespace ssb {
 
+BlockFilter q11_blocks(Database& db) {
+   Q11Builder::Q11 c;
+   auto& lo = db["lineorder"];
+   BlockFilter blocks(lo);
+   // date keys are yyyymmdd, so d_year = 1993 is a date key range
+   auto rows = lo.sortedRange("lo_orderdate", types::Integer(19930101),
+                              types::Integer(19931231));
+   blocks.restrictRows(rows.first, rows.second);
+   if (conf.useZoneMaps)
+      blocks
+          .restrict(lo["lo_orderdate"], types::Integer(19930101),
+                    types::Integer(19931231))
+          .restrict(lo["lo_discount"], c.discount_min, c.discount_max);
+   return blocks;
+}
+
 NOVECTORIZE std::unique_ptr<runtime::Query> q11_hyper(Database& db,
                                                       size_t nrThreads) {
+   db.warmUp("date", {"d_year", "d_datekey"});
+   db.warmUp("lineorder", {"lo_orderdate", "lo_quantity", "lo_discount",
+                           "lo_extendedprice"});
    // --- aggregates
 
    auto resources = initQuery(nrThreads);
@@ -59,8 +78,9 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q11_hyper(Database& db,
    auto lo_discount = lo["lo_discount"].data<types::Numeric<18, 2>>();
    auto lo_extendedprice = lo["lo_extendedprice"].data<types::Numeric<18, 2>>();
 
-   auto result_revenue = tbb::parallel_reduce(
-       tbb::blocked_range<size_t>(0, lo.nrTuples), types::Numeric<18, 4>(0),
+   auto blocks = q11_blocks(db);
+   auto result_revenue = parallel_reduce_candidates(
+       blocks, types::Numeric<18, 4>(0),
        [&](const tbb::blocked_range<size_t>& r,
            const types::Numeric<18, 4>& s) {
           auto revenue = s;
@@ -106,7 +126,9 @@ std::unique_ptr<Q11Builder::Q11> Q11Builder::getQuery() {
                              Buffer(sel_year, sizeof(pos_t)),
                              Column(date, "d_year"), Value(&r->year)));
 
-   auto lineorder = Scan("lineorder");
+   r->blocks = make_unique<BlockFilter>(q11_blocks(db));
+   auto lineorder = Scan("lineorder", r->blocks->rowsBegin(),
+                         r->blocks->rowsEnd(), r->blocks.get());
    // select lo_discount between 1 and 3, lo_quantity < 25
    Select(
        Expression()
@@ -148,6 +170,9 @@ std::unique_ptr<Q11Builder::Q11> Q11Builder::getQuery() {
 std::unique_ptr<runtime::Query> q11_vectorwise(Database& db, size_t nrThreads,
                                                size_t vectorSize) {
    using namespace vectorwise;
+   db.warmUp("date", {"d_year", "d_datekey"});
+   db.warmUp("lineorder", {"lo_orderdate", "lo_quantity", "lo_discount",
+                           "lo_extendedprice"});
 
    // runtime::Relation result;
    auto result = std::make_unique<runtime::Query>();
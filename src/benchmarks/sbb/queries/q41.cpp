@@ -91,7 +91,12 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q41_hyper(Database& db,
       }
    });
    ht2.setSize(found2);
-   parallel_insert(entries2, ht2);
+   BloomFilter filter2;
+   if (conf.useJoinFilters) {
+      filter2.setSize(found2);
+      parallel_insert(entries2, ht2, filter2);
+   } else
+      parallel_insert(entries2, ht2);
 
    // --- ht for join customer-lineorder
    Hashmapx<types::Integer, types::Char<15>, hash> ht3;
@@ -111,7 +116,12 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q41_hyper(Database& db,
       }
    });
    ht3.setSize(found3);
-   parallel_insert(entries3, ht3);
+   BloomFilter filter3;
+   if (conf.useJoinFilters) {
+      filter3.setSize(found3);
+      parallel_insert(entries3, ht3, filter3);
+   } else
+      parallel_insert(entries3, ht3);
 
    // --- ht for join supplier-lineorder
    Hashset<types::Integer, hash> ht4;
@@ -129,7 +139,12 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q41_hyper(Database& db,
       }
    });
    ht4.setSize(found4);
-   parallel_insert(entries4, ht4);
+   BloomFilter filter4;
+   if (conf.useJoinFilters) {
+      filter4.setSize(found4);
+      parallel_insert(entries4, ht4, filter4);
+   } else
+      parallel_insert(entries4, ht4);
 
    // --- scan and join lineorder
    auto& lo = db["lineorder"];
@@ -146,6 +161,7 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q41_hyper(Database& db,
        [](auto& acc, auto&& value) { acc += value; }, zero, nrThreads);
 
    // preaggregation
+   const bool useFilters = conf.useJoinFilters;
    tbb::parallel_for(
        tbb::blocked_range<size_t>(0, lo.nrTuples, morselSize),
        [&](const tbb::blocked_range<size_t>& r) {
@@ -158,6 +174,12 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q41_hyper(Database& db,
              auto& custkey = lo_custkey[i];
              auto& orderdate = lo_orderdate[i];
 
+             // the filters of the dimensions reject most tuples without
+             // touching the hashtables
+             if (useFilters && (!filter4.contains(ht4.hash(suppkey)) ||
+                                !filter3.contains(ht3.hash(custkey)) ||
+                                !filter2.contains(ht2.hash(partkey))))
+                continue;
              if (ht4.contains(suppkey)) {
                 auto customer = ht3.findOne(custkey);
                 if (customer) {
@@ -230,39 +252,59 @@ std::unique_ptr<Q41Builder::Q41> Q41Builder::getQuery() {
    auto lineorder = Scan("lineorder");
 
    // filter for lineorder is lineorder_supplier
-   HashJoin(Buffer(lineorder_supplier, sizeof(pos_t)), conf.joinAll())
-       .addBuildKey(Column(supplier, "s_suppkey"), Buffer(sel_supplier),
-                    conf.hash_sel_int32_t_col(),
-                    primitives::scatter_sel_int32_t_col)
-       .addProbeKey(Column(lineorder, "lo_suppkey"), conf.hash_int32_t_col(),
-                    primitives::keys_equal_int32_t_col);
+   {
+      auto join =
+          HashJoin(Buffer(lineorder_supplier, sizeof(pos_t)), conf.joinAll());
+      join.addBuildKey(Column(supplier, "s_suppkey"), Buffer(sel_supplier),
+                       conf.hash_sel_int32_t_col(),
+                       primitives::scatter_sel_int32_t_col)
+          .addProbeKey(Column(lineorder, "lo_suppkey"),
+                       conf.hash_int32_t_col(),
+                       primitives::keys_equal_int32_t_col);
+      // lineorder tuples without supplier in the region skip all joins
+      if (conf.useJoinFilters)
+         join.addProbeFilter(Column(lineorder, "lo_suppkey"),
+                             conf.hash_int32_t_col());
+   }
 
    // filter for lineorder is lineorder_customer
-   HashJoin(Buffer(lineorder_customer, sizeof(pos_t)), conf.joinAll())
-       .addBuildKey(Column(customer, "c_custkey"), Buffer(sel_customer),
-                    conf.hash_sel_int32_t_col(),
-                    primitives::scatter_sel_int32_t_col)
-       .addBuildValue(Column(customer, "c_nation"), Buffer(sel_customer),
-                      primitives::scatter_sel_Char_15_col,
-                      Buffer(c_nation, sizeof(types::Char<15>)),
-                      primitives::gather_col_Char_15_col)
-       .setProbeSelVector(Buffer(lineorder_supplier), conf.joinSel())
-       .addProbeKey(Column(lineorder, "lo_custkey"), Buffer(lineorder_supplier),
-                    conf.hash_sel_int32_t_col(),
-                    primitives::keys_equal_int32_t_col);
+   {
+      auto join =
+          HashJoin(Buffer(lineorder_customer, sizeof(pos_t)), conf.joinAll());
+      join.addBuildKey(Column(customer, "c_custkey"), Buffer(sel_customer),
+                       conf.hash_sel_int32_t_col(),
+                       primitives::scatter_sel_int32_t_col)
+          .addBuildValue(Column(customer, "c_nation"), Buffer(sel_customer),
+                         primitives::scatter_sel_Char_15_col,
+                         Buffer(c_nation, sizeof(types::Char<15>)),
+                         primitives::gather_col_Char_15_col)
+          .setProbeSelVector(Buffer(lineorder_supplier), conf.joinSel())
+          .addProbeKey(Column(lineorder, "lo_custkey"),
+                       Buffer(lineorder_supplier), conf.hash_sel_int32_t_col(),
+                       primitives::keys_equal_int32_t_col);
+      if (conf.useJoinFilters)
+         join.addProbeFilter(Column(lineorder, "lo_custkey"),
+                             conf.hash_int32_t_col());
+   }
 
    // filter for c_nation is lineorder_part
-   HashJoin(Buffer(lineorder_part, sizeof(pos_t)), conf.joinAll())
-       .addBuildKey(Column(part, "p_partkey"), Buffer(sel_part),
-                    conf.hash_sel_int32_t_col(),
-                    primitives::scatter_sel_int32_t_col)
-       .pushProbeSelVector(Buffer(lineorder_customer),
-                           Buffer(lineorder_customer_part,
-                                  sizeof(pos_t))) // filter for lineorder
-       .addProbeKey(Column(lineorder, "lo_partkey"), Buffer(lineorder_customer),
-                    conf.hash_sel_int32_t_col(),
-                    Buffer(lineorder_customer_part),
-                    primitives::keys_equal_int32_t_col);
+   {
+      auto join =
+          HashJoin(Buffer(lineorder_part, sizeof(pos_t)), conf.joinAll());
+      join.addBuildKey(Column(part, "p_partkey"), Buffer(sel_part),
+                       conf.hash_sel_int32_t_col(),
+                       primitives::scatter_sel_int32_t_col)
+          .pushProbeSelVector(Buffer(lineorder_customer),
+                              Buffer(lineorder_customer_part,
+                                     sizeof(pos_t))) // filter for lineorder
+          .addProbeKey(Column(lineorder, "lo_partkey"),
+                       Buffer(lineorder_customer), conf.hash_sel_int32_t_col(),
+                       Buffer(lineorder_customer_part),
+                       primitives::keys_equal_int32_t_col);
+      if (conf.useJoinFilters)
+         join.addProbeFilter(Column(lineorder, "lo_partkey"),
+                             conf.hash_int32_t_col());
+   }
 
    HashJoin(Buffer(lineorder_date, sizeof(pos_t)), conf.joinAll())
        .addBuildKey(Column(date, "d_datekey"), conf.hash_int32_t_col(),
@@ -7,6 +7,7 @@
 #include <unordered_set>
 
 #include "benchmarks/ssb/Queries.hpp"
+#include "common/runtime/Cpu.hpp"
 #include "common/runtime/Import.hpp"
 #include "profile.hpp"
 #include "tbb/tbb.h"
@@ -37,7 +38,14 @@ int main(int argc, char* argv[]) {
           << "Usage: ./" << argv[0]
           << "<number of repetitions> <path to sbb dir> [nrThreads = all] \n "
              " EnvVars: [vectorSize = 1024] [SIMDhash = 0] [SIMDjoin = 0] "
-             "[SIMDsel = 0]";
+             "[SIMDsel = 0] [SIMDproj = 0] "
+             "[simdIsa = detected (scalar, avx2, avx512)] "
+             "[narrowColumns = 0] [joinFilters = 0] "
+             "[adaptive = 0] [tuneVectorSize = 0 (1 = fit L2, 2 = online)] "
+             "[clearCaches = 0] "
+             "[warmUp = 0 (1 = readahead, 2 = populate)] "
+             "[sortKeys = lineorder.lo_orderdate,...] "
+             "[hugePages = part,lineorder.lo_partkey,... (1 = all)]";
       exit(1);
    }
 
@@ -61,11 +69,27 @@ int main(int argc, char* argv[]) {
    };
 
    if (auto v = std::getenv("vectorSize")) vectorSize = atoi(v);
+   if (auto v = std::getenv("tuneVectorSize")) {
+      vectorwise::tuneVectorSizes = atoi(v);
+      // tuned pipelines pick their vector size up to the given one
+      if (vectorwise::tuneVectorSizes && !std::getenv("vectorSize"))
+         vectorSize = vectorwise::VectorSizeTuner::maxSize;
+   }
    if (auto v = std::getenv("SIMDhash")) conf.useSimdHash = atoi(v);
    if (auto v = std::getenv("SIMDjoin")) conf.useSimdJoin = atoi(v);
    if (auto v = std::getenv("SIMDsel")) conf.useSimdSel = atoi(v);
    if (auto v = std::getenv("SIMDproj")) conf.useSimdProj = atoi(v);
+   if (conf.useSimdHash || conf.useSimdJoin || conf.useSimdSel ||
+       conf.useSimdProj)
+      std::cerr << "SIMD primitives: " << cpu::name(cpu::isa()) << std::endl;
+   if (auto v = std::getenv("adaptive"))
+      vectorwise::adaptiveFlavors = atoi(v);
+   if (auto v = std::getenv("dictionaries")) conf.useDictionaries = atoi(v);
+   if (auto v = std::getenv("zoneMaps")) conf.useZoneMaps = atoi(v);
+   if (auto v = std::getenv("joinFilters")) conf.useJoinFilters = atoi(v);
    if (auto v = std::getenv("clearCaches")) clearCaches = atoi(v);
+   if (auto v = std::getenv("warmUp"))
+      ssb.warmUpMode = Database::WarmUpMode(atoi(v));
    if (auto v = std::getenv("q")) {
      using namespace std;
      istringstream iss((string(v)));
@@ -77,6 +101,11 @@ int main(int argc, char* argv[]) {
    tbb::task_scheduler_init scheduler(nrThreads);
    if (q.count("1.1h")) e.timeAndProfile("q1.1 hyper     ", nrTuples(ssb, {"date", "lineorder"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q11_hyper(ssb, nrThreads); escape(&result);}, repetitions);
    if (q.count("1.1v")) e.timeAndProfile("q1.1 vectorwise", nrTuples(ssb, {"date", "lineorder"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q11_vectorwise(ssb, nrThreads, vectorSize); escape(&result);}, repetitions);
+   if (conf.useZoneMaps && (q.count("1.1h") || q.count("1.1v"))) {
+      auto blocks = q11_blocks(ssb);
+      std::cout << "q1.1 skipped blocks: " << blocks.skipped() << " of "
+                << blocks.nrBlocks() << std::endl;
+   }
    if (q.count("1.2h")) e.timeAndProfile("q1.2 hyper     ", nrTuples(ssb, {"date", "lineorder"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q12_hyper(ssb, nrThreads); escape(&result);}, repetitions);
    if (q.count("1.2v")) e.timeAndProfile("q1.2 vectorwise", nrTuples(ssb, {"date", "lineorder"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q12_vectorwise(ssb, nrThreads, vectorSize); escape(&result);}, repetitions);
    if (q.count("1.3h")) e.timeAndProfile("q1.3 hyper     ", nrTuples(ssb, {"date", "lineorder"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q13_hyper(ssb, nrThreads); escape(&result);}, repetitions);
@@ -105,5 +134,9 @@ int main(int argc, char* argv[]) {
    if (q.count("4.3h")) e.timeAndProfile("q4.3 hyper     ", nrTuples(ssb, {"date", "lineorder", "supplier", "customer", "part"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q43_hyper(ssb, nrThreads); escape(&result);}, repetitions);
    if (q.count("4.3v")) e.timeAndProfile("q4.3 vectorwise", nrTuples(ssb, {"date", "lineorder", "supplier", "customer", "part"}), [&]() { if(clearCaches) clearOsCaches(); auto result = q43_vectorwise(ssb, nrThreads, vectorSize); escape(&result);}, repetitions);
 
+   if (vectorwise::adaptiveFlavors)
+      vectorwise::printFlavorReport(std::cerr);
+   if (vectorwise::tuneVectorSizes)
+      vectorwise::printVectorSizeReport(std::cerr);
    return 0;
 }
@@ -43,6 +43,8 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q1_hyper(Database& db,
    types::Date c1 = types::Date::castString("1998-09-02");
    types::Numeric<12, 2> one = types::Numeric<12, 2>::castString("1.00");
    auto& li = db["lineitem"];
+   db.warmUp("lineitem", {"l_returnflag", "l_linestatus", "l_extendedprice",
+                           "l_discount", "l_tax", "l_quantity", "l_shipdate"});
    auto l_returnflag = li["l_returnflag"].data<types::Char<1>>();
    auto l_linestatus = li["l_linestatus"].data<types::Char<1>>();
    auto l_extendedprice = li["l_extendedprice"].data<types::Numeric<12, 2>>();
@@ -71,8 +73,8 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q1_hyper(Database& db,
        nrThreads);
 
 
-   tbb::parallel_for(
-       tbb::blocked_range<size_t>(0, li.nrTuples, morselSize),
+   parallel_for_nodes(
+       li,
        [&](const tbb::blocked_range<size_t>& r) {
           auto locals = groupOp.preAggLocals();
           for (size_t i = r.begin(), end = r.end(); i != end; ++i) {
@@ -138,9 +140,18 @@ std::unique_ptr<Q1Builder::Q1> Q1Builder::getQuery() {
 
    auto r = make_unique<Q1>();
    auto lineitem = Scan("lineitem");
+   // nearly all tuples qualify, then the dense compare into a bitmap and its
+   // conversion are cheaper than the selection, see vectorwise::Select
+   Buffer(sel_date, sizeof(pos_t));
    Select(Expression().addOp(BF(primitives::sel_less_equal_Date_col_Date_val),
-                             Buffer(sel_date, sizeof(pos_t)),
-                             Column(lineitem, "l_shipdate"), Value(&r->c1)));
+                             Buffer(sel_date), Column(lineitem, "l_shipdate"),
+                             Value(&r->c1)),
+          Expression()
+              .addOp(primitives::selbm_less_equal_Date_col_Date_val,
+                     Bitmap(bm_date), Column(lineitem, "l_shipdate"),
+                     Value(&r->c1))
+              .addOp(primitives::bitmap_to_sel, Buffer(sel_date),
+                     Bitmap(bm_date)));
    Project()
        .addExpression(
            Expression()
@@ -233,6 +244,8 @@ std::unique_ptr<Q1Builder::Q1> Q1Builder::getQuery() {
 std::unique_ptr<runtime::Query> q1_vectorwise(Database& db, size_t nrThreads,
                                               size_t vectorSize) {
    using namespace vectorwise;
+   db.warmUp("lineitem", {"l_returnflag", "l_linestatus", "l_extendedprice",
+                           "l_discount", "l_tax", "l_quantity", "l_shipdate"});
    WorkerGroup workers(nrThreads);
    vectorwise::SharedStateManager shared;
 
@@ -69,8 +69,10 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q18_hyper(Database& db,
 
    const auto zero = types::Numeric<12, 2>::castString("0.00");
 
+   // one group per order, sized from the import statistics
    auto groupOp = make_GroupBy<types::Integer, types::Numeric<12, 2>, hash>(
-       [](auto& acc, auto&& value) { acc += value; }, zero, nrThreads);
+       [](auto& acc, auto&& value) { acc += value; }, zero, nrThreads,
+       li.distinct("l_orderkey"));
 
    // scan lineitem and group by l_orderkey
    tbb::parallel_for(tbb::blocked_range<size_t>(0, li.nrTuples, morselSize),
@@ -217,6 +219,7 @@ std::unique_ptr<Q18Builder::Q18> Q18Builder::getQuery() {
    auto customer = Scan("customer");
    auto lineitem = Scan("lineitem");
    HashGroup()
+       .expectGroups(db["lineitem"].distinct("l_orderkey"))
        .addKey(Column(lineitem, "l_orderkey"), primitives::hash_int32_t_col,
                primitives::keys_not_equal_int32_t_col,
                primitives::partition_by_key_int32_t_col,
@@ -237,9 +240,8 @@ std::unique_ptr<Q18Builder::Q18> Q18Builder::getQuery() {
                           Buffer(sel_orderkey, sizeof(pos_t)),
                           Buffer(l_quantity), Value(&r->qty_bound)));
    auto orders = Scan("orders");
-   // FIXME: This should be a right semi join (, but for now, hashjoin may be
-   // good enough)
    HashJoin(Buffer(orders_matches, sizeof(pos_t)))
+       .setMode(Hashjoin::Mode::LeftSemi)
        .addBuildKey(Buffer(l_orderkey), //
                     Buffer(sel_orderkey), primitives::hash_sel_int32_t_col,
                     primitives::scatter_sel_int32_t_col)
@@ -336,6 +338,28 @@ std::unique_ptr<Q18Builder::Q18> Q18Builder::getQuery() {
                  primitives::aggr_row_plus_int64_t_col,
                  primitives::gather_val_int64_t_col,
                  Buffer(group_sum, sizeof(types::Numeric<12, 2>)));
+   if (conf.useOrderBy)
+      // order by o_totalprice desc, o_orderdate limit 100, the top rows are
+      // gathered back into the buffers of the groups
+      TopK(100)
+          .addKey(Buffer(group_o_totalprice),
+                  primitives::normalize_desc_int64_t_col)
+          .addKey(Buffer(group_o_orderdate), primitives::normalize_Date_col)
+          .addValue(Buffer(group_c_name), primitives::scatter_Char_25_col,
+                    Buffer(group_c_name), primitives::gather_col_Char_25_col)
+          .addValue(Buffer(group_o_custkey), primitives::scatter_int32_t_col,
+                    Buffer(group_o_custkey),
+                    primitives::gather_col_int32_t_col)
+          .addValue(Buffer(group_l_orderkey), primitives::scatter_int32_t_col,
+                    Buffer(group_l_orderkey),
+                    primitives::gather_col_int32_t_col)
+          .addValue(Buffer(group_o_orderdate), primitives::scatter_Date_col,
+                    Buffer(group_o_orderdate), primitives::gather_col_Date_col)
+          .addValue(Buffer(group_o_totalprice),
+                    primitives::scatter_int64_t_col, Buffer(group_o_totalprice),
+                    primitives::gather_col_int64_t_col)
+          .addValue(Buffer(group_sum), primitives::scatter_int64_t_col,
+                    Buffer(group_sum), primitives::gather_col_int64_t_col);
 
    result.addValue("c_name", Buffer(group_c_name))
        .addValue("c_custkey", Buffer(group_o_custkey))
@@ -378,6 +402,7 @@ std::unique_ptr<Q18Builder::Q18> Q18Builder::getGroupQuery() {
    auto r = make_unique<Q18>();
    auto lineitem = Scan("lineitem");
    HashGroup()
+       .expectGroups(db["lineitem"].distinct("l_orderkey"))
        .addKey(Column(lineitem, "l_orderkey"), primitives::hash_int32_t_col,
                primitives::keys_not_equal_int32_t_col,
                primitives::partition_by_key_int32_t_col,
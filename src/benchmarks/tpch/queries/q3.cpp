@@ -92,8 +92,8 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q3_hyper_index2(
   auto& ord = db["orders"];
   auto& li = db["lineitem"];
   // indexes
-  auto& icust = db.getindex("customer_key");
-  auto& iord = db.getindex("orders_key");
+  auto& icust = db.getKeyIndex("customer_key");
+  auto& iord = db.getKeyIndex("orders_key");
 
   auto c_mktsegment = cu["c_mktsegment"].data<types::Char<10>>();
   auto o_orderdate = ord["o_orderdate"].data<types::Date>();
@@ -677,6 +677,13 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q3_hyper(Database& db,
   auto l_extendedprice = li["l_extendedprice"].data<types::Numeric<12, 2>>();
   auto l_discount = li["l_discount"].data<types::Numeric<12, 2>>();
 
+  // compare dictionary codes instead of strings
+  auto dict = cu["c_mktsegment"].dictionary.get();
+  const bool useCodes =
+      conf.useDictionaries && dict && dict->codeSize == sizeof(int8_t);
+  auto c_mktsegment_code = useCodes ? dict->codes<int8_t>() : nullptr;
+  auto c3_code = useCodes ? dict->code(c3) : -1;
+
   using hash = runtime::CRC32Hash;
   using range = tbb::blocked_range<size_t>;
 
@@ -693,7 +700,8 @@ NOVECTORIZE std::unique_ptr<runtime::Query> q3_hyper(Database& db,
         auto found = f;
         auto& entries = entries1.local();
         for (size_t i = r.begin(), end = r.end(); i != end; ++i) {
-          if (c_mktsegment[i] == c3) {
+          if (useCodes ? c_mktsegment_code[i] == c3_code
+                       : c_mktsegment[i] == c3) {
 #ifdef VERBOSE_II
             std::cout << c_custkey[i] << std::endl;
 #endif
@@ -818,11 +826,21 @@ std::unique_ptr<Q3Builder::Q3> Q3Builder::getQuery() {
   previous = result.resultWriter.shared.result->participate();
   auto r = make_unique<Q3>();
   auto customer = Scan("customer");
-  Select(Expression().addOp(
-      BF(primitives::sel_equal_to_Char_10_col_Char_10_val),  //
-      Buffer(sel_cust, sizeof(pos_t)),                       //
-      Column(customer, "c_mktsegment"),                      //
-      Value(&r->c1)));                                       //
+  auto dict = db["customer"]["c_mktsegment"].dictionary.get();
+  if (conf.useDictionaries && dict && dict->codeSize == sizeof(int8_t)) {
+    // select on the dictionary codes
+    r->c1_code = dict->code(r->c1);
+    Select(Expression().addOp(
+        BF(primitives::sel_equal_to_int8_t_col_int8_t_val),  //
+        Buffer(sel_cust, sizeof(pos_t)),                     //
+        Codes(customer, "c_mktsegment"),                     //
+        Value(&r->c1_code)));                                //
+  } else
+    Select(Expression().addOp(
+        BF(primitives::sel_equal_to_Char_10_col_Char_10_val),  //
+        Buffer(sel_cust, sizeof(pos_t)),                       //
+        Column(customer, "c_mktsegment"),                      //
+        Value(&r->c1)));                                       //
   auto order = Scan("orders");
   Select(Expression().addOp(BF(primitives::sel_less_Date_col_Date_val),  //
                             Buffer(sel_order, sizeof(pos_t)),            //
@@ -910,6 +928,20 @@ std::unique_ptr<Q3Builder::Q3> Q3Builder::getQuery() {
                 primitives::aggr_plus_int64_t_col,
                 primitives::aggr_row_plus_int64_t_col,
                 primitives::gather_val_int64_t_col, Buffer(result_project));
+  if (conf.useOrderBy)
+    // order by revenue desc, o_orderdate limit 10, the top rows are gathered
+    // back into the buffers of the groups
+    TopK(10)
+        .addKey(Buffer(result_project), primitives::normalize_desc_int64_t_col)
+        .addKey(Buffer(o_orderdate), primitives::normalize_Date_col)
+        .addValue(Buffer(result_project), primitives::scatter_int64_t_col,
+                  Buffer(result_project), primitives::gather_col_int64_t_col)
+        .addValue(Buffer(o_shippriority), primitives::scatter_int32_t_col,
+                  Buffer(o_shippriority), primitives::gather_col_int32_t_col)
+        .addValue(Buffer(o_orderdate), primitives::scatter_Date_col,
+                  Buffer(o_orderdate), primitives::gather_col_Date_col)
+        .addValue(Buffer(l_orderkey), primitives::scatter_int32_t_col,
+                  Buffer(l_orderkey), primitives::gather_col_int32_t_col);
 
   result.addValue("revenue", Buffer(result_project))
       .addValue("o_shippriority", Buffer(o_shippriority))
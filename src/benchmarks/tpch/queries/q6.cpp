@@ -1,15 +1,31 @@
 #include "benchmarks/tpch/Queries.hpp"
 #include "common/runtime/Types.hpp"
+#include "hyper/ParallelHelper.hpp"
 #include "tbb/tbb.h"
 #include "vectorwise/Operations.hpp"
 #include "vectorwise/Operators.hpp"
 #include "vectorwise/Primitives.hpp"
 #include "vectorwise/QueryBuilder.hpp"
 #include "vectorwise/VectorAllocator.hpp"
+#include <cstring>
 #include <iostream>
 
 using namespace runtime;
 using namespace std;
+
+BlockFilter q6_blocks(Database& db) {
+   Q6Builder::Q6 c;
+   auto& li = db["lineitem"];
+   BlockFilter blocks(li);
+   // the slice of l_shipdate in [c1, c2) if lineitem is sorted by it
+   auto rows = li.sortedRange("l_shipdate", c.c1, types::Date(c.c2.value - 1));
+   blocks.restrictRows(rows.first, rows.second);
+   if (conf.useZoneMaps)
+      blocks.restrict(li["l_shipdate"], c.c1, c.c2)
+          .restrict(li["l_discount"], c.c3, c.c4);
+   return blocks;
+}
+
 NOVECTORIZE Relation q6_hyper(Database& db, size_t /*nrThreads*/) {
    Relation result;
    result.insert("revenue", make_unique<algebra::Numeric>(12, 4));
@@ -26,17 +42,22 @@ NOVECTORIZE Relation q6_hyper(Database& db, size_t /*nrThreads*/) {
 
    // --- scan
    auto& rel = db["lineitem"];
-   auto l_shipdate_col = rel["l_shipdate"].data<types::Date>();
+   db.warmUp("lineitem", {"l_shipdate", "l_quantity", "l_extendedprice", "l_discount"});
+   auto& l_shipdate_attr = rel["l_shipdate"];
+   tbb::enumerable_thread_specific<vector<types::Date>> l_shipdate_buffer;
    auto l_quantity_col = rel["l_quantity"].data<types::Numeric<12, 2>>();
    auto l_extendedprice_col =
        rel["l_extendedprice"].data<types::Numeric<12, 2>>();
    auto l_discount_col = rel["l_discount"].data<types::Numeric<12, 2>>();
 
-   revenue = tbb::parallel_reduce(
-       tbb::blocked_range<size_t>(0, rel.nrTuples), types::Numeric<12, 4>(0),
+   auto blocks = q6_blocks(db);
+   revenue = parallel_reduce_candidates(
+       blocks, types::Numeric<12, 4>(0),
        [&](const tbb::blocked_range<size_t>& r,
            const types::Numeric<12, 4>& s) {
           auto revenue = s;
+          auto l_shipdate_col = morselValues(l_shipdate_attr, r,
+                                             l_shipdate_buffer.local());
           for (size_t i = r.begin(), end = r.end(); i != end; ++i) {
              auto& l_shipdate = l_shipdate_col[i];
              auto& l_quantity = l_quantity_col[i];
@@ -63,55 +84,149 @@ NOVECTORIZE Relation q6_hyper(Database& db, size_t /*nrThreads*/) {
    return result;
 }
 
+/// Stores value in the narrow representation of column into c and returns c
+template <typename T>
+static void* narrowValue(const NarrowColumn& column, const T& value,
+                         int64_t& c) {
+   auto store = [&](auto n) { memcpy(&c, &n, sizeof(n)); };
+   switch (column.width()) {
+   case 1: store(column.narrow<int8_t>(value)); break;
+   case 2: store(column.narrow<int16_t>(value)); break;
+   case 4: store(column.narrow<int32_t>(value)); break;
+   default: throw runtime_error("Unsupported narrow width");
+   }
+   return &c;
+}
+
+/// The one of the int8_t, int16_t and int32_t variants of a primitive which
+/// matches the width of column, or the int64_t one without narrow column
+static vectorwise::primitives::F4
+byWidth(const NarrowColumn* column, vectorwise::primitives::F4 int8,
+        vectorwise::primitives::F4 int16, vectorwise::primitives::F4 int32,
+        vectorwise::primitives::F4 int64) {
+   if (!column) return int64;
+   switch (column->width()) {
+   case 1: return int8;
+   case 2: return int16;
+   case 4: return int32;
+   default: throw runtime_error("Unsupported narrow width");
+   }
+}
+
 unique_ptr<Q6Builder::Q6> Q6Builder::getQuery() {
    using namespace vectorwise;
    // --- constants
    auto res = make_unique<Q6>();
    auto& consts = *res;
-   enum { sel_a, sel_b, result_project };
+   enum { sel_a, sel_b, bm_a, bm_b, result_project };
 
    assert(db["lineitem"]["l_shipdate"].type->rt_size() == sizeof(consts.c2));
    assert(db["lineitem"]["l_quantity"].type->rt_size() == sizeof(consts.c5));
    assert(db["lineitem"]["l_discount"].type->rt_size() == sizeof(consts.c3));
    assert(db["lineitem"]["l_extendedprice"].type->rt_size() == sizeof(int64_t));
 
-   auto lineitem = Scan("lineitem");
-   Select((Expression()                                       //
-              .addOp(conf.sel_less_int32_t_col_int32_t_val(), //
-                     Buffer(sel_a, sizeof(pos_t)),            //
-                     Column(lineitem, "l_shipdate"),          //
-                     Value(&consts.c2)))
-              .addOp(conf.selsel_greater_equal_int32_t_col_int32_t_val(), //
-                     Buffer(sel_a, sizeof(pos_t)),                        //
-                     Buffer(sel_b, sizeof(pos_t)),                        //
-                     Column(lineitem, "l_shipdate"),                      //
-                     Value(&consts.c1))
-             .addOp(conf.selsel_less_int64_t_col_int64_t_val(), //
-             // .addOp(primitives::selsel_less_int64_t_col_int64_t_val_bf, //
-                     Buffer(sel_b, sizeof(pos_t)),               //
-                     Buffer(sel_a, sizeof(pos_t)),               //
-                     Column(lineitem, "l_quantity"),             //
-                     Value(&consts.c5))
-              .addOp(conf.selsel_greater_equal_int64_t_col_int64_t_val(), //
-              //.addOp(primitives::selsel_greater_equal_int64_t_col_int64_t_val_bf, //
-                     Buffer(sel_a, sizeof(pos_t)),                        //
-                     Buffer(sel_b, sizeof(pos_t)),                        //
-                     Column(lineitem, "l_discount"),                      //
-                     Value(&consts.c3))
-              .addOp(conf.selsel_less_equal_int64_t_col_int64_t_val(), //
-                     Buffer(sel_b, sizeof(pos_t)),                     //
-                     Buffer(sel_a, sizeof(pos_t)),                     //
-                     Column(lineitem, "l_discount"),                   //
-                     Value(&consts.c4)));
+   res->blocks = make_unique<BlockFilter>(q6_blocks(db));
+   auto lineitem = Scan("lineitem", res->blocks->rowsBegin(),
+                        res->blocks->rowsEnd(), res->blocks.get());
+   // with narrow physical types, l_quantity and l_discount are compared in
+   // their narrow representation, which reads a quarter of the bytes or less
+   auto& l_quantity = db["lineitem"]["l_quantity"];
+   auto& l_discount = db["lineitem"]["l_discount"];
+   auto narrow = l_quantity.narrow && l_discount.narrow;
+   auto narrowQuantity = narrow ? l_quantity.narrow.get() : nullptr;
+   auto narrowDiscount = narrow ? l_discount.narrow.get() : nullptr;
+   auto quantity = narrow ? Narrow(lineitem, "l_quantity")
+                          : Column(lineitem, "l_quantity");
+   auto discount = narrow ? Narrow(lineitem, "l_discount")
+                          : Column(lineitem, "l_discount");
+   auto c3 = narrow ? narrowValue(*narrowDiscount, consts.c3, consts.n3)
+                    : &consts.c3;
+   auto c4 = narrow ? narrowValue(*narrowDiscount, consts.c4, consts.n4)
+                    : &consts.c4;
+   auto c5 = narrow ? narrowValue(*narrowQuantity, consts.c5, consts.n5)
+                    : &consts.c5;
+   // both representations of the selection exist before either is built
+   Buffer(sel_a, sizeof(pos_t));
+   Buffer(sel_b, sizeof(pos_t));
+   Bitmap(bm_a);
+   Bitmap(bm_b);
+   std::unique_ptr<vectorwise::Expression> sparse =
+       Expression()
+           .addOp(conf.sel_less_int32_t_col_int32_t_val(), Buffer(sel_a),
+                  Column(lineitem, "l_shipdate"), Value(&consts.c2))
+           .addOp(conf.selsel_greater_equal_int32_t_col_int32_t_val(),
+                  Buffer(sel_a), Buffer(sel_b), Column(lineitem, "l_shipdate"),
+                  Value(&consts.c1))
+           .addOp(byWidth(narrowQuantity,
+                          primitives::selsel_less_int8_t_col_int8_t_val,
+                          primitives::selsel_less_int16_t_col_int16_t_val,
+                          primitives::selsel_less_int32_t_col_int32_t_val,
+                          conf.selsel_less_int64_t_col_int64_t_val()),
+                  Buffer(sel_b), Buffer(sel_a), quantity, Value(c5))
+           .addOp(
+               byWidth(narrowDiscount,
+                       primitives::selsel_greater_equal_int8_t_col_int8_t_val,
+                       primitives::selsel_greater_equal_int16_t_col_int16_t_val,
+                       primitives::selsel_greater_equal_int32_t_col_int32_t_val,
+                       conf.selsel_greater_equal_int64_t_col_int64_t_val()),
+               Buffer(sel_a), Buffer(sel_b), discount, Value(c3))
+           .addOp(byWidth(narrowDiscount,
+                          primitives::selsel_less_equal_int8_t_col_int8_t_val,
+                          primitives::selsel_less_equal_int16_t_col_int16_t_val,
+                          primitives::selsel_less_equal_int32_t_col_int32_t_val,
+                          conf.selsel_less_equal_int64_t_col_int64_t_val()),
+                  Buffer(sel_b), Buffer(sel_a), discount, Value(c4));
+   // for vectors where many tuples qualify, the same conditions on bitmaps,
+   // which the projection and aggregation read directly
+   std::unique_ptr<vectorwise::Expression> dense =
+       Expression()
+           .addOp(primitives::selbm_less_int32_t_col_int32_t_val, Bitmap(bm_a),
+                  Column(lineitem, "l_shipdate"), Value(&consts.c2))
+           .addOp(primitives::selbmbm_greater_equal_int32_t_col_int32_t_val,
+                  Bitmap(bm_a), Bitmap(bm_b), Column(lineitem, "l_shipdate"),
+                  Value(&consts.c1))
+           .addOp(byWidth(narrowQuantity,
+                          primitives::selbmbm_less_int8_t_col_int8_t_val,
+                          primitives::selbmbm_less_int16_t_col_int16_t_val,
+                          primitives::selbmbm_less_int32_t_col_int32_t_val,
+                          primitives::selbmbm_less_int64_t_col_int64_t_val),
+                  Bitmap(bm_b), Bitmap(bm_a), quantity, Value(c5))
+           .addOp(
+               byWidth(
+                   narrowDiscount,
+                   primitives::selbmbm_greater_equal_int8_t_col_int8_t_val,
+                   primitives::selbmbm_greater_equal_int16_t_col_int16_t_val,
+                   primitives::selbmbm_greater_equal_int32_t_col_int32_t_val,
+                   primitives::selbmbm_greater_equal_int64_t_col_int64_t_val),
+               Bitmap(bm_a), Bitmap(bm_b), discount, Value(c3))
+           .addOp(
+               byWidth(narrowDiscount,
+                       primitives::selbmbm_less_equal_int8_t_col_int8_t_val,
+                       primitives::selbmbm_less_equal_int16_t_col_int16_t_val,
+                       primitives::selbmbm_less_equal_int32_t_col_int32_t_val,
+                       primitives::selbmbm_less_equal_int64_t_col_int64_t_val),
+               Bitmap(bm_b), Bitmap(bm_a), discount, Value(c4));
+   Select(move(sparse), move(dense), Bitmap(bm_a));
    Project().addExpression(
        Expression() //
            .addOp(primitives::proj_sel_both_multiplies_int64_t_col_int64_t_col,
                   Buffer(sel_a),                           //
                   Buffer(result_project, sizeof(int64_t)), //
                   Column(lineitem, "l_discount"),
+                  Column(lineitem, "l_extendedprice")),
+       Expression() //
+           .addOp(primitives::proj_bm_multiplies_int64_t_col_int64_t_col,
+                  Bitmap(bm_a),                            //
+                  Buffer(result_project, sizeof(int64_t)), //
+                  Column(lineitem, "l_discount"),
                   Column(lineitem, "l_extendedprice")));
    FixedAggregation(Expression() //
                         .addOp(primitives::aggr_static_plus_int64_t_col,
+                               Value(&consts.aggregator), //
+                               Buffer(result_project)),
+                    Expression() //
+                        .addOp(primitives::aggr_static_bm_plus_int64_t_col,
+                               Bitmap(bm_a),              //
                                Value(&consts.aggregator), //
                                Buffer(result_project)));
    res->rootOp = popOperator();
@@ -121,6 +236,7 @@ unique_ptr<Q6Builder::Q6> Q6Builder::getQuery() {
 
 Relation q6_vectorwise(Database& db, size_t nrThreads, size_t vectorSize) {
    using namespace vectorwise;
+   db.warmUp("lineitem", {"l_shipdate", "l_quantity", "l_extendedprice", "l_discount"});
 
    std::atomic<size_t> n;
    runtime::Relation result;
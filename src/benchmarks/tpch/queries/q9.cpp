@@ -104,11 +104,14 @@ std::unique_ptr<runtime::Query> q9_hyper(runtime::Database& db,
    auto& part = db["part"];
    auto p_partkey = part["p_partkey"].data<types::Integer>();
    auto p_name = part["p_name"].data<types::Varchar<55>>();
+   // variable length strings if available
+   auto p_name_strings = part["p_name"].strings.get();
    // do selection on part and put selected elements into ht
    auto found3 = PARALLEL_SELECT(part.nrTuples, entries3, {
        auto& pk = p_partkey[i];
-       auto& pn = p_name[i];
-       if (memmem(pn.value, pn.len, contains.value, contains.len) != nullptr){
+       auto name = p_name_strings ? p_name_strings->data(i) : p_name[i].value;
+       auto length = p_name_strings ? p_name_strings->size(i) : p_name[i].len;
+       if (memmem(name, length, contains.value, contains.len) != nullptr){
           entries.emplace_back(ht3.hash(pk), pk);
           found++;
        }
@@ -10,6 +10,7 @@
 #include <unordered_set>
 
 #include "benchmarks/tpch/Queries.hpp"
+#include "common/runtime/Cpu.hpp"
 #include "common/runtime/Import.hpp"
 #include "profile.hpp"
 #include "tbb/tbb.h"
@@ -39,7 +40,14 @@ int main(int argc, char* argv[]) {
           << "Usage: ./" << argv[0]
           << "<number of repetitions> <path to tpch dir> [nrThreads = all] \n "
              " EnvVars: [vectorSize = 1024] [SIMDhash = 0] [SIMDjoin = 0] "
-             "[SIMDsel = 0]";
+             "[SIMDsel = 0] [SIMDproj = 0] "
+             "[simdIsa = detected (scalar, avx2, avx512)] "
+             "[packColumns = 0] [narrowColumns = 0] "
+             "[numaPlacement = 0] [adaptive = 0] "
+             "[tuneVectorSize = 0 (1 = fit L2, 2 = online)] "
+             "[clearCaches = 0] [warmUp = 0 (1 = readahead, 2 = populate)] "
+             "[sortKeys = lineitem.l_shipdate,...] "
+             "[hugePages = orders,customer.c_custkey,... (1 = all)]";
       exit(1);
    }
 
@@ -48,6 +56,20 @@ int main(int argc, char* argv[]) {
    // load tpch data
    importTPCH(argv[2], tpch);
 
+   // footprint of the bit packed columns compared to the plain ones
+   size_t plainBytes = 0, packedBytes = 0;
+   for (auto table : {"part", "supplier", "partsupp", "customer", "orders",
+                      "lineitem", "nation", "region"})
+      for (auto& attr : tpch[table].attributes)
+         if (attr.second.packed) {
+            plainBytes += tpch[table].nrTuples * sizeof(int32_t);
+            packedBytes += attr.second.packed->memory();
+         }
+   if (packedBytes)
+      std::cerr << "Bit packed columns: " << packedBytes / 1e6
+                << " MB instead of " << plainBytes / 1e6 << " MB, resident memory "
+                << getCurrentRSS() / 1e6 << " MB" << std::endl;
+
    // run queries
    auto repetitions = atoi(argv[1]);
    size_t nrThreads = std::thread::hardware_concurrency();
@@ -61,11 +83,27 @@ int main(int argc, char* argv[]) {
        "5h", "5v", "6h", "6v",  "9h",   "9v",  "18h",  "18v"};
 
    if (auto v = std::getenv("vectorSize")) vectorSize = atoi(v);
+   if (auto v = std::getenv("tuneVectorSize")) {
+      vectorwise::tuneVectorSizes = atoi(v);
+      // tuned pipelines pick their vector size up to the given one
+      if (vectorwise::tuneVectorSizes && !std::getenv("vectorSize"))
+         vectorSize = vectorwise::VectorSizeTuner::maxSize;
+   }
    if (auto v = std::getenv("SIMDhash")) conf.useSimdHash = atoi(v);
    if (auto v = std::getenv("SIMDjoin")) conf.useSimdJoin = atoi(v);
    if (auto v = std::getenv("SIMDsel")) conf.useSimdSel = atoi(v);
    if (auto v = std::getenv("SIMDproj")) conf.useSimdProj = atoi(v);
+   if (conf.useSimdHash || conf.useSimdJoin || conf.useSimdSel ||
+       conf.useSimdProj)
+      std::cerr << "SIMD primitives: " << cpu::name(cpu::isa()) << std::endl;
+   if (auto v = std::getenv("adaptive"))
+      vectorwise::adaptiveFlavors = atoi(v);
+   if (auto v = std::getenv("dictionaries")) conf.useDictionaries = atoi(v);
+   if (auto v = std::getenv("zoneMaps")) conf.useZoneMaps = atoi(v);
+   if (auto v = std::getenv("orderBy")) conf.useOrderBy = atoi(v);
    if (auto v = std::getenv("clearCaches")) clearCaches = atoi(v);
+   if (auto v = std::getenv("warmUp"))
+      tpch.warmUpMode = Database::WarmUpMode(atoi(v));
    if (auto v = std::getenv("q")) {
       using namespace std;
       istringstream iss((string(v)));
@@ -301,6 +339,11 @@ int main(int argc, char* argv[]) {
                           escape(&result);
                        },
                        repetitions);
+   if (conf.useZoneMaps && (q.count("6h") || q.count("6v"))) {
+      auto blocks = q6_blocks(tpch);
+      std::cout << "q6 skipped blocks: " << blocks.skipped() << " of "
+                << blocks.nrBlocks() << std::endl;
+   }
    if (q.count("9h"))
       e.timeAndProfile("q9 hyper     ",
                        nrTuples(tpch, {"nation", "supplier", "part", "partsupp",
@@ -343,6 +386,10 @@ int main(int argc, char* argv[]) {
           },
           repetitions);
 #endif
+   if (vectorwise::adaptiveFlavors)
+      vectorwise::printFlavorReport(std::cerr);
+   if (vectorwise::tuneVectorSizes)
+      vectorwise::printVectorSizeReport(std::cerr);
    scheduler.terminate();
    return 0;
 }
@@ -1,6 +1,11 @@
 #include "common/runtime/Database.hpp"
 #include "common/runtime/Concurrency.hpp"
+#include "common/runtime/Numa.hpp"
+#include "common/runtime/Types.hpp"
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
 #include <cstdlib>
+#include <stdexcept>
 
 namespace runtime {
 
@@ -23,12 +28,124 @@ Attribute& Relation::insert(std::string name, std::unique_ptr<Type> t) {
        .first->second;
 }
 
+void Relation::append(
+    const std::unordered_map<std::string, const void*>& values, size_t n) {
+   if (!sortKey.empty())
+      throw std::runtime_error("Can't append to " + name + ", it is sorted by " +
+                               sortKey);
+   for (auto& attr : attributes)
+      if (!values.count(attr.first))
+         throw std::runtime_error("Missing values of attribute " + attr.first +
+                                  " to append to " + name);
+   if (values.size() != attributes.size())
+      throw std::runtime_error("Unknown attributes to append to " + name);
+   for (auto& attr : attributes) {
+      auto& a = attr.second;
+      a.data_.append(values.at(attr.first), n, a.type->rt_size());
+      a.dictionary.reset();
+      a.zoneMap.reset();
+      a.packed.reset();
+      a.strings.reset();
+      a.statistics.reset();
+      a.narrow.reset();
+   }
+   nrTuples += n;
+   // grown columns are no longer placed, the partitions have to cover the
+   // appended tuples as well
+   if (!nodeBounds.empty())
+      placeOnNodes([&](const std::string& attr) {
+         return attributes.at(attr).data_.onHugePages();
+      });
+}
+
+void Relation::placeOnNodes(
+    const std::function<bool(const std::string&)>& hugePages) {
+   nodeBounds = numa::partitionBounds(nrTuples);
+   for (auto& attr : attributes)
+      attr.second.data_.moveToAnonymous(
+          [&](uint8_t* data, size_t typeSize) {
+             for (size_t node = 0; node + 1 < nodeBounds.size(); node++)
+                if (nodeBounds[node] < nodeBounds[node + 1])
+                   numa::bind(data + nodeBounds[node] * typeSize,
+                              (nodeBounds[node + 1] - nodeBounds[node]) *
+                                  typeSize,
+                              node);
+          },
+          hugePages(attr.first));
+}
+
 bool Database::hasRelation(std::string name) {
    return relations.find(name) != relations.end();
 }
 
 Relation& Database::operator[](std::string key) { return relations[key]; }
 std::vector<size_t>& Database::getindex(std::string key) { return indexes[key]; }
+KeyIndex& Database::getKeyIndex(std::string key) { return keyIndexes[key]; }
+
+/// Adds the rows [begin, end) with keys to index
+template <typename R>
+static void addRows(KeyIndex& index, const types::Integer* keys, size_t begin,
+                    size_t end) {
+   auto& rows = index.typedRowsForChange<R>();
+   // the rows are changed in place, not in the cached file
+   if (rows.mapped()) rows.moveToAnonymous([](uint8_t*, size_t) {});
+   size_t size = rows.size();
+   for (auto i = begin; i < end; i++)
+      size = std::max(size, size_t(keys[i].value) + 1);
+   if (size > rows.size()) {
+      // keys without tuple map to row 0, as in the built index
+      std::vector<R> missing(size - rows.size(), 0);
+      rows.append(missing.data(), missing.size(), sizeof(R));
+   }
+   for (auto i = begin; i < end; i++) rows[keys[i].value] = i;
+}
+
+void Database::append(
+    std::string relation,
+    const std::unordered_map<std::string, const void*>& values, size_t n) {
+   auto& rel = (*this)[relation];
+   for (auto& index : keyIndexes)
+      if (index.second.relation == relation &&
+          index.second.rowIdSize == sizeof(uint32_t) &&
+          rel.nrTuples + n > std::numeric_limits<uint32_t>::max())
+         throw std::runtime_error("Can't append to " + relation +
+                                  ", the row ids of " + index.first +
+                                  " have 32 bits");
+   auto first = rel.nrTuples;
+   rel.append(values, n);
+   for (auto& index : keyIndexes) {
+      auto& i = index.second;
+      if (i.relation != relation) continue;
+      auto keys = rel[i.key].data<types::Integer>();
+      if (i.rowIdSize == sizeof(uint32_t))
+         addRows<uint32_t>(i, keys, first, rel.nrTuples);
+      else
+         addRows<uint64_t>(i, keys, first, rel.nrTuples);
+   }
+}
+
+template <typename V> static void warmUp(const V& v, Database::WarmUpMode mode) {
+   if (mode == Database::WarmUpMode::Advise) {
+      v.willNeed(0, v.size());
+   } else if (mode == Database::WarmUpMode::Populate) {
+      tbb::parallel_for(tbb::blocked_range<size_t>(0, v.size(), 64 * 1024),
+                        [&](const tbb::blocked_range<size_t>& r) {
+                           v.populate(r.begin(), r.end());
+                        });
+   }
+}
+
+void Database::warmUp(std::string relation,
+                      std::initializer_list<std::string> columns) {
+   if (warmUpMode == WarmUpMode::Off) return;
+   auto& rel = (*this)[relation];
+   for (auto& column : columns) {
+      auto& attr = rel[column];
+      runtime::warmUp(attr.data_, warmUpMode);
+      // vectorized scans read the bit packed values instead
+      if (attr.packed) runtime::warmUp(attr.packed->data_, warmUpMode);
+   }
+}
 BlockRelation::Block BlockRelation::createBlock(size_t minNrElements) {
    auto elements = std::max(minBlockSize, minNrElements);
    auto a = this_worker->allocator.allocate(sizeof(BlockHeader) +
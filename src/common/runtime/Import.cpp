@@ -1,10 +1,20 @@
 #include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
 #include <fstream>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <iterator>
+#include <limits>
+#include <mutex>
 #include <random>
+#include <sstream>
 #include <stdlib.h>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "errno.h"
@@ -15,8 +25,10 @@
 #include "benchmarks/tpch/Queries.hpp"
 #include "common/runtime/Hash.hpp"
 #include "common/runtime/Hashmap.hpp"
+#include "common/runtime/HyperLogLog.hpp"
 #include "common/runtime/Import.hpp"
 #include "common/runtime/Mmap.hpp"
+#include "common/runtime/Tokenizer.hpp"
 #include "common/runtime/Types.hpp"
 #include "hyper/ParallelHelper.hpp"
 
@@ -159,34 +171,807 @@ struct ColumnConfig {
    case Varchar_152: D(types::Varchar<152>)                                    \
    case Varchar_199: D(types::Varchar<199>)
 
-inline void parse(ColumnConfig& c, std::vector<void*>& col, std::string& line,
-                  unsigned& begin, unsigned& end) {
+/// fixed size strings which are dictionary encoded
+#define EACHCHARTYPE                                                           \
+   case Char_6: D(types::Char<6>)                                              \
+   case Char_7: D(types::Char<7>)                                              \
+   case Char_9: D(types::Char<9>)                                              \
+   case Char_10: D(types::Char<10>)                                            \
+   case Char_11: D(types::Char<11>)                                            \
+   case Char_12: D(types::Char<12>)                                            \
+   case Char_15: D(types::Char<15>)                                            \
+   case Char_18: D(types::Char<18>)                                            \
+   case Char_22: D(types::Char<22>)                                            \
+   case Char_25: D(types::Char<25>)
 
-   const char* start = line.data() + begin;
-   end = line.find_first_of('|', begin);
-   size_t size = end - begin;
+/// variable length strings which get a string heap
+#define EACHVARCHARTYPE                                                        \
+   case Varchar_11: D(types::Varchar<11>)                                      \
+   case Varchar_12: D(types::Varchar<12>)                                      \
+   case Varchar_22: D(types::Varchar<22>)                                      \
+   case Varchar_23: D(types::Varchar<23>)                                      \
+   case Varchar_25: D(types::Varchar<25>)                                      \
+   case Varchar_40: D(types::Varchar<40>)                                      \
+   case Varchar_44: D(types::Varchar<44>)                                      \
+   case Varchar_55: D(types::Varchar<55>)                                      \
+   case Varchar_79: D(types::Varchar<79>)                                      \
+   case Varchar_101: D(types::Varchar<101>)                                    \
+   case Varchar_117: D(types::Varchar<117>)                                    \
+   case Varchar_152: D(types::Varchar<152>)                                    \
+   case Varchar_199: D(types::Varchar<199>)
 
+/// numbers and dates which get zone maps
+#define EACHNUMERICTYPE                                                        \
+   case Integer: D(types::Integer)                                             \
+   case Numeric_12_2: D(types::Numeric<12 COMMA 2>)                            \
+   case Numeric_18_2: D(types::Numeric<18 COMMA 2>)                            \
+   case Date: D(types::Date)
+
+template <typename T>
+void parseInto(const char* str, uint32_t size, void* col, size_t row) {
+   reinterpret_cast<T*>(col)[row] = T::castString(str, size);
+}
+
+/// Typed field parser for one column of a .tbl file
+struct ColumnParser {
+   RTType type;
+   size_t typeSize;
+   void (*parse)(const char* str, uint32_t size, void* col, size_t row);
+   ColumnParser(ColumnConfig& c) : type(algebraToRTType(c.type)) {
 #define D(type)                                                                \
-   reinterpret_cast<std::vector<type>&>(col).emplace_back(                     \
-       type::castString(start, size));                                         \
+   typeSize = sizeof(type);                                                    \
+   parse = &parseInto<type>;                                                   \
    break;
-
-   switch (algebraToRTType(c.type)) { EACHTYPE }
+      switch (type) { EACHTYPE }
 #undef D
-   begin = end + 1;
+   }
+};
+
+/// Size and modification time of a .tbl file
+struct SourceInfo {
+   bool exists;
+   uint64_t size;
+   int64_t mtime;
+   SourceInfo(const std::string& path) {
+      struct stat sb;
+      exists = stat(path.c_str(), &sb) == 0;
+      size = exists ? sb.st_size : 0;
+      mtime = exists ? sb.st_mtim.tv_sec * 1000000000ll + sb.st_mtim.tv_nsec
+                     : 0;
+   }
+};
+
+/// Header of a cached column file, the values follow it
+struct ColumnHeader {
+   static constexpr uint64_t magicValue = 0x4c4f434e49474e45; // "ENGINCOL"
+   static constexpr uint32_t currentVersion = 2;
+   /// The cache holds tuples which mergeDelta appended, it no longer matches
+   /// the .tbl file it was parsed from
+   static constexpr uint32_t deltaMerged = 1;
+   uint64_t magic;
+   uint32_t version;
+   /// RTType of the values
+   uint32_t type;
+   uint32_t typeSize;
+   uint32_t flags;
+   uint64_t count;
+   /// .tbl file the column was parsed from
+   uint64_t sourceSize;
+   int64_t sourceMtime;
+   uint64_t checksum;
+   uint64_t reserved;
+};
+static_assert(sizeof(ColumnHeader) == 64, "column header layout changed");
+
+/// Position dependent checksum of size bytes, computed in parallel
+uint64_t checksum(const void* data, size_t size) {
+   auto bytes = reinterpret_cast<const uint8_t*>(data);
+   size_t words = size / sizeof(uint64_t);
+   runtime::MurMurHash hash;
+   uint64_t sum = tbb::parallel_reduce(
+       tbb::blocked_range<size_t>(0, words, 1024 * 1024), uint64_t(0),
+       [&](const tbb::blocked_range<size_t>& r, uint64_t s) {
+          for (size_t i = r.begin(); i != r.end(); ++i) {
+             uint64_t word;
+             memcpy(&word, bytes + i * sizeof(uint64_t), sizeof(uint64_t));
+             s += hash.hashKey(word, i);
+          }
+          return s;
+       },
+       [](uint64_t x, uint64_t y) { return x + y; });
+   uint64_t tail = 0;
+   memcpy(&tail, bytes + words * sizeof(uint64_t), size % sizeof(uint64_t));
+   return sum + hash.hashKey(tail, words);
 }
 
-void writeBinary(ColumnConfig& col, std::vector<void*>& data,
-                 std::string path) {
-#define D(type)                                                                \
-   {                                                                           \
-      auto name = path + "_" + col.name;                                       \
-      runtime::Vector<type>::writeBinary(                                      \
-          name.data(), reinterpret_cast<std::vector<type>&>(data));            \
-      break;                                                                   \
+/// Fills the header of a cached column file with count values behind it
+void writeHeader(void* file, RTType type, size_t typeSize, size_t count,
+                 const SourceInfo& source) {
+   auto& header = *reinterpret_cast<ColumnHeader*>(file);
+   header.magic = ColumnHeader::magicValue;
+   header.version = ColumnHeader::currentVersion;
+   header.type = type;
+   header.typeSize = typeSize;
+   header.flags = 0;
+   header.count = count;
+   header.sourceSize = source.size;
+   header.sourceMtime = source.mtime;
+   header.checksum = checksum(&header + 1, count * typeSize);
+   header.reserved = 0;
+}
+
+/// Checks that the header of the cached column file name matches the type
+/// and the source. On success, the number of cached values is stored in count.
+bool validCache(const std::string& name, RTType type, size_t typeSize,
+                const SourceInfo& source, bool verifyChecksum,
+                uint64_t& count) {
+   ifstream file(name, ios::binary | ios::ate);
+   if (!file) return false;
+   uint64_t fileSize = file.tellg();
+   ColumnHeader header;
+   file.seekg(0);
+   if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+      return false;
+   if (header.magic != ColumnHeader::magicValue ||
+       header.version != ColumnHeader::currentVersion ||
+       header.type != type || header.typeSize != typeSize ||
+       fileSize != sizeof(header) + header.count * header.typeSize)
+      return false;
+   // without its .tbl file the cache is all we have
+   if (source.exists && (header.sourceSize != source.size ||
+                         header.sourceMtime != source.mtime))
+      return false;
+   if (verifyChecksum) {
+      runtime::Vector<uint8_t> data;
+      data.readBinary(name.c_str(), sizeof(header));
+      if (checksum(data.data(), data.size()) != header.checksum) return false;
    }
-   switch (algebraToRTType(col.type)) { EACHTYPE }
-#undef D
+   count = header.count;
+   return true;
+}
+
+/// Whether the cached column file name holds tuples merged by mergeDelta
+bool deltaMerged(const std::string& name) {
+   ColumnHeader header;
+   ifstream file(name, ios::binary);
+   return file.read(reinterpret_cast<char*>(&header), sizeof(header)) &&
+          header.magic == ColumnHeader::magicValue &&
+          header.version == ColumnHeader::currentVersion &&
+          (header.flags & ColumnHeader::deltaMerged);
+}
+
+/// Line aligned part of a .tbl file which is parsed by one task
+struct ParseRange {
+   const char* begin;
+   const char* end;
+   size_t firstRow;
+   size_t rows;
+};
+
+/// Splits [data, data+size) into line aligned ranges of roughly chunkSize
+std::vector<ParseRange> splitLines(const char* data, size_t size,
+                                   size_t chunkSize) {
+   std::vector<ParseRange> ranges;
+   const char* limit = data + size;
+   for (const char* begin = data; begin < limit;) {
+      const char* end = begin + min(chunkSize, size_t(limit - begin));
+      if (end < limit) {
+         end = static_cast<const char*>(memchr(end, '\n', limit - end));
+         end = end ? end + 1 : limit;
+      }
+      ranges.push_back({begin, end, 0, 0});
+      begin = end;
+   }
+   // count lines per range in parallel, a line may lack its final '\n'
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size(), 1),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto i = r.begin(); i != r.end(); ++i) {
+                           auto& range = ranges[i];
+                           range.rows =
+                               std::count(range.begin, range.end, '\n');
+                           if (range.end[-1] != '\n') range.rows++;
+                        }
+                     });
+   size_t row = 0;
+   for (auto& range : ranges) {
+      range.firstRow = row;
+      row += range.rows;
+   }
+   return ranges;
+}
+
+/// Parses all lines of range into the preallocated column buffers, columns
+/// without buffer are skipped. The range is tokenized block-wise, the casts
+/// then run over the pre-split fields.
+void parseRange(const ParseRange& range, std::vector<ColumnParser>& parsers,
+                std::vector<void*>& columns) {
+   const size_t blockSize = 64 * 1024;
+   std::vector<uint32_t> delimiters;
+   const size_t nrColumns = parsers.size();
+   size_t row = range.firstRow;
+   const char* pos = range.begin;
+   for (size_t block = blockSize; pos < range.end;) {
+      const char* blockEnd = pos + min(block, size_t(range.end - pos));
+      if (delimiters.size() < block) delimiters.resize(block);
+      auto n = findDelimiters(pos, blockEnd, delimiters.data());
+
+      // fields of an incomplete last line are parsed again with the next block
+      const char* field = pos;
+      const char* line = pos;
+      size_t column = 0;
+      for (size_t i = 0; i < n; i++) {
+         const char* delimiter = pos + delimiters[i];
+         if (column < nrColumns && columns[column])
+            parsers[column].parse(field, delimiter - field, columns[column],
+                                  row);
+         column++;
+         field = delimiter + 1;
+         if (*delimiter == '\n') {
+            row++;
+            column = 0;
+            line = field;
+         }
+      }
+      if (blockEnd == range.end && line < range.end) {
+         // last line of the file without '\n'
+         if (column < nrColumns && columns[column])
+            parsers[column].parse(field, range.end - field, columns[column],
+                                  row);
+         row++;
+         line = range.end;
+      }
+
+      if (line == pos) {
+         // line does not fit into block
+         block *= 2;
+      } else {
+         pos = line;
+         block = blockSize;
+      }
+   }
+   assert(row == range.firstRow + range.rows);
+}
+
+/// Parses dir/fileName.tbl in parallel straight into the cached column files
+/// of all columns with rebuild set
+void parseTable(std::vector<ColumnParser>& parsers, std::vector<bool>& rebuild,
+                std::vector<ColumnConfig>& cols, const SourceInfo& source,
+                std::string dir, std::string fileName) {
+   auto path = dir + fileName + ".tbl";
+   if (!std::ifstream(path)) throw runtime_error("csv file not found: " + dir);
+   auto start = gettime();
+
+   runtime::Vector<char> file(path.c_str());
+   madvise(file.data(), file.size(), MADV_SEQUENTIAL);
+   const size_t chunkSize = 16 * 1024 * 1024;
+   auto ranges = splitLines(file.data(), file.size(), chunkSize);
+   size_t rows =
+       ranges.empty() ? 0 : ranges.back().firstRow + ranges.back().rows;
+
+   std::vector<runtime::Vector<char>> outputs(cols.size());
+   std::vector<void*> columns(cols.size(), nullptr);
+   for (size_t c = 0; c < cols.size(); c++) {
+      if (!rebuild[c]) continue;
+      auto name = dir + "/cached/" + fileName + "_" + cols[c].name;
+      outputs[c].createBinary(name.c_str(), rows * parsers[c].typeSize,
+                              sizeof(ColumnHeader));
+      columns[c] = outputs[c].data();
+   }
+
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, ranges.size(), 1),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto i = r.begin(); i != r.end(); ++i)
+                           parseRange(ranges[i], parsers, columns);
+                     });
+
+   for (size_t c = 0; c < cols.size(); c++)
+      if (rebuild[c])
+         writeHeader(outputs[c].header(), parsers[c].type, parsers[c].typeSize,
+                     rows, source);
+   outputs.clear();
+
+   auto time = gettime() - start;
+   cerr << "Imported " << fileName << ": " << rows << " rows in " << time
+        << "s, " << (rows / time) << " rows/s, "
+        << (file.size() / time / (1024 * 1024)) << " MB/s" << endl;
+}
+
+/// Hash of the used bytes of a fixed size string
+struct CharHash {
+   template <unsigned maxLen>
+   size_t operator()(const types::Char<maxLen>& c) const {
+      return std::hash<std::string_view>()(std::string_view(c.value, c.len));
+   }
+};
+
+/// Columns with more distinct values are not dictionary encoded
+const size_t maxDictionarySize = 32768;
+
+/// Code size for a dictionary of size values
+size_t codeSize(size_t size) {
+   return size <= 128 ? sizeof(int8_t) : sizeof(int16_t);
+}
+
+template <typename C, typename T>
+void writeCodes(const std::string& name, runtime::Vector<T>& column,
+                runtime::Vector<T>& dictionary, RTType type,
+                const SourceInfo& source) {
+   std::unordered_map<T, C, CharHash> lookup;
+   for (size_t i = 0; i < dictionary.size(); i++) lookup[dictionary[i]] = i;
+   runtime::Vector<C> codes;
+   codes.createBinary((name + ".codes").c_str(), column.size(),
+                      sizeof(ColumnHeader));
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, column.size(), 100000),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto i = r.begin(); i != r.end(); ++i)
+                           codes[i] = lookup.find(column[i])->second;
+                     });
+   writeHeader(codes.header(), type, sizeof(C), column.size(), source);
+}
+
+/// Builds the sorted dictionary name.dict and the codes name.codes for the
+/// cached column name. The dictionary stays empty if there are too many
+/// distinct values.
+template <typename T>
+void buildDictionary(const std::string& name, RTType type,
+                     const SourceInfo& source) {
+   runtime::Vector<T> column;
+   column.readBinary(name.c_str(), sizeof(ColumnHeader));
+
+   // collect distinct values, give up once there are too many
+   using Set = std::unordered_set<T, CharHash>;
+   std::atomic<bool> tooMany(false);
+   tbb::enumerable_thread_specific<Set> distinct;
+   tbb::parallel_for(
+       tbb::blocked_range<size_t>(0, column.size(), 100000),
+       [&](const tbb::blocked_range<size_t>& r) {
+          auto& local = distinct.local();
+          for (auto i = r.begin(); i != r.end() && !tooMany; ++i) {
+             local.insert(column[i]);
+             if (local.size() > maxDictionarySize) tooMany = true;
+          }
+       });
+   std::vector<T> values;
+   if (!tooMany) {
+      Set all;
+      for (auto& local : distinct) all.insert(local.begin(), local.end());
+      if (all.size() <= maxDictionarySize)
+         values.assign(all.begin(), all.end());
+   }
+   std::sort(values.begin(), values.end());
+
+   runtime::Vector<T> dictionary;
+   dictionary.createBinary((name + ".dict").c_str(), values.size(),
+                           sizeof(ColumnHeader));
+   std::copy(values.begin(), values.end(), dictionary.begin());
+   writeHeader(dictionary.header(), type, sizeof(T), values.size(), source);
+   if (values.empty()) return;
+   if (codeSize(values.size()) == sizeof(int8_t))
+      writeCodes<int8_t>(name, column, dictionary, type, source);
+   else
+      writeCodes<int16_t>(name, column, dictionary, type, source);
+}
+
+/// Maps the dictionary of the cached column name into attr, building it
+/// first if necessary
+template <typename T>
+void dictionaryEncode(runtime::Attribute& attr, const std::string& name,
+                      RTType type, const SourceInfo& source,
+                      bool verifyChecksum) {
+   auto valid = [&](uint64_t& size) {
+      uint64_t count = 0;
+      return validCache(name + ".dict", type, sizeof(T), source,
+                        verifyChecksum, size) &&
+             (size == 0 ||
+              (validCache(name + ".codes", type, codeSize(size), source,
+                          verifyChecksum, count) &&
+               count == attr.data_.size()));
+   };
+   uint64_t size = 0;
+   if (!valid(size)) {
+      buildDictionary<T>(name, type, source);
+      if (!valid(size))
+         throw runtime_error("Could not build dictionary for " + name);
+   }
+   if (!size) return;
+
+   auto dictionary = make_unique<runtime::Dictionary>();
+   dictionary->codeSize = codeSize(size);
+   dictionary->typedValuesForChange<T>().readBinary((name + ".dict").c_str(),
+                                                    sizeof(ColumnHeader));
+   auto codes = (name + ".codes");
+   if (dictionary->codeSize == sizeof(int8_t))
+      dictionary->typedCodesForChange<int8_t>().readBinary(
+          codes.c_str(), sizeof(ColumnHeader));
+   else
+      dictionary->typedCodesForChange<int16_t>().readBinary(
+          codes.c_str(), sizeof(ColumnHeader));
+   attr.dictionary = move(dictionary);
+}
+
+/// Maps the zone map name.zone of the cached column name into attr, building
+/// it first if necessary
+template <typename T>
+void zoneMap(runtime::Attribute& attr, const std::string& name, RTType type,
+             const SourceInfo& source, bool verifyChecksum) {
+   using Bounds = std::pair<T, T>;
+   auto file = name + ".zone";
+   auto& column = attr.typedAccess<T>();
+   auto blockSize = runtime::ZoneMap::blockSize;
+   size_t nrBlocks = (column.size() + blockSize - 1) / blockSize;
+   uint64_t count = 0;
+   if (!validCache(file, type, sizeof(Bounds), source, verifyChecksum,
+                   count) ||
+       count != nrBlocks) {
+      runtime::Vector<Bounds> bounds;
+      bounds.createBinary(file.c_str(), nrBlocks, sizeof(ColumnHeader));
+      tbb::parallel_for(
+          tbb::blocked_range<size_t>(0, nrBlocks),
+          [&](const tbb::blocked_range<size_t>& r) {
+             for (auto b = r.begin(); b != r.end(); ++b) {
+                auto begin = b * blockSize;
+                auto end = std::min(column.size(), begin + blockSize);
+                Bounds block(column[begin], column[begin]);
+                for (auto i = begin + 1; i < end; ++i) {
+                   if (column[i] < block.first) block.first = column[i];
+                   if (block.second < column[i]) block.second = column[i];
+                }
+                bounds[b] = block;
+             }
+          });
+      writeHeader(bounds.header(), type, sizeof(Bounds), nrBlocks, source);
+   }
+   auto zoneMap = make_unique<runtime::ZoneMap>();
+   zoneMap->typedBoundsForChange<T>().readBinary(file.c_str(),
+                                                 sizeof(ColumnHeader));
+   attr.zoneMap = move(zoneMap);
+}
+
+/// Writes the value range and the equi-depth histogram of column to stats.
+/// The bucket bounds are quantiles of a regular sample of the values.
+template <typename T>
+void histogram(const runtime::Vector<T>& column, int64_t* stats) {
+   using Stats = runtime::ColumnStatistics;
+   using Range = std::pair<int64_t, int64_t>;
+   auto n = column.size();
+   if (!n) return;
+   auto range = tbb::parallel_reduce(
+       tbb::blocked_range<size_t>(0, n), Range(Stats::key(column[0]),
+                                               Stats::key(column[0])),
+       [&](const tbb::blocked_range<size_t>& r, Range range) {
+          for (auto i = r.begin(); i != r.end(); ++i) {
+             auto k = Stats::key(column[i]);
+             range.first = std::min(range.first, k);
+             range.second = std::max(range.second, k);
+          }
+          return range;
+       },
+       [](const Range& a, const Range& b) {
+          return Range(std::min(a.first, b.first),
+                       std::max(a.second, b.second));
+       });
+   stats[Stats::Min] = range.first;
+   stats[Stats::Max] = range.second;
+   const size_t maxSample = 64 * 1024;
+   auto step = (n + maxSample - 1) / maxSample;
+   std::vector<int64_t> sample;
+   for (size_t i = 0; i < n; i += step) sample.push_back(Stats::key(column[i]));
+   std::sort(sample.begin(), sample.end());
+   for (size_t b = 0; b < Stats::histogramBuckets; b++)
+      stats[Stats::Buckets + b] =
+          sample[((b + 1) * sample.size() - 1) / Stats::histogramBuckets];
+   // the sample may miss the largest value
+   stats[Stats::Buckets + Stats::histogramBuckets - 1] = range.second;
+}
+/// Strings have no value range
+template <unsigned l>
+void histogram(const runtime::Vector<types::Char<l>>&, int64_t*) {}
+template <unsigned l>
+void histogram(const runtime::Vector<types::Varchar<l>>&, int64_t*) {}
+
+/// Maps the statistics name.stats of the cached column name into attr,
+/// building them first if necessary
+template <typename T>
+void statistics(runtime::Attribute& attr, const std::string& name,
+                RTType type, const SourceInfo& source, bool verifyChecksum) {
+   using Stats = runtime::ColumnStatistics;
+   auto file = name + ".stats";
+   auto& column = attr.typedAccess<T>();
+   uint64_t count = 0;
+   if (!validCache(file, type, sizeof(int64_t), source, verifyChecksum,
+                   count) ||
+       count != Stats::size) {
+      // one sketch per range, merged into the sketch of the column
+      auto sketch = tbb::parallel_reduce(
+          tbb::blocked_range<size_t>(0, column.size()), runtime::HyperLogLog(),
+          [&](const tbb::blocked_range<size_t>& r,
+              runtime::HyperLogLog sketch) {
+             for (auto i = r.begin(); i != r.end(); ++i)
+                sketch.add(runtime::HyperLogLog::hash(
+                    runtime::MurMurHash()(column[i], 0)));
+             return sketch;
+          },
+          [](runtime::HyperLogLog a, const runtime::HyperLogLog& b) {
+             a.merge(b);
+             return a;
+          });
+      runtime::Vector<int64_t> stats;
+      stats.createBinary(file.c_str(), Stats::size, sizeof(ColumnHeader));
+      std::fill(stats.data(), stats.data() + Stats::size, 0);
+      stats[Stats::Count] = column.size();
+      stats[Stats::Distinct] =
+          std::min<uint64_t>(sketch.estimate(), column.size());
+      histogram(column, stats.data());
+      writeHeader(stats.header(), type, sizeof(int64_t), Stats::size, source);
+   }
+   auto statistics = make_unique<runtime::ColumnStatistics>();
+   statistics->data_.readBinary(file.c_str(), sizeof(ColumnHeader));
+   attr.statistics = move(statistics);
+}
+
+/// Bytes per value of the narrow representation of values in [min, max] of
+/// a type with typeSize bytes, typeSize if no narrower width fits. Base is
+/// chosen so that the narrow values stay strictly within their range.
+unsigned narrowWidth(int64_t min, int64_t max, size_t typeSize,
+                     int64_t& base) {
+   for (unsigned width = 1; width < typeSize; width *= 2) {
+      auto lowest = -(int64_t(1) << (8 * width - 1));
+      auto highest = (int64_t(1) << (8 * width - 1)) - 1;
+      if (uint64_t(max) - uint64_t(min) > uint64_t(highest - lowest - 2))
+         continue;
+      // keep the values if they fit, so that the narrow values are theirs
+      base = (min > lowest && max < highest) ? 0 : min - (lowest + 1);
+      return width;
+   }
+   return typeSize;
+}
+
+/// Writes the n values minus base as N to out
+template <typename N, typename T>
+void writeNarrow(uint8_t* out, const T* values, size_t n, int64_t base) {
+   using Stats = runtime::ColumnStatistics;
+   auto narrow = reinterpret_cast<N*>(out);
+   tbb::parallel_for(
+       tbb::blocked_range<size_t>(0, n, 100000),
+       [&](const tbb::blocked_range<size_t>& r) {
+          for (auto i = r.begin(); i != r.end(); ++i)
+             narrow[i] = N(Stats::key(values[i]) - base);
+       });
+}
+
+/// Maps the narrow representation name.narrow of the cached column name into
+/// attr, building it first if necessary. Attributes whose value range needs
+/// all bytes of their type stay without one.
+template <typename T>
+void narrowColumn(runtime::Attribute& attr, const std::string& name,
+                  RTType type, const SourceInfo& source, bool verifyChecksum) {
+   using Narrow = runtime::NarrowColumn;
+   auto& stats = *attr.statistics;
+   auto n = attr.data_.size();
+   int64_t base = 0;
+   auto width = narrowWidth(stats.min(), stats.max(), sizeof(T), base);
+   if (!n || width == sizeof(T)) return;
+   auto file = name + ".narrow";
+   auto size = Narrow::headerSize + n * width;
+   uint64_t count = 0;
+   if (!validCache(file, type, 1, source, verifyChecksum, count) ||
+       count != size) {
+      runtime::Vector<uint8_t> out;
+      out.createBinary(file.c_str(), size, sizeof(ColumnHeader));
+      reinterpret_cast<int64_t*>(out.data())[0] = base;
+      reinterpret_cast<uint64_t*>(out.data())[1] = width;
+      auto values = out.data() + Narrow::headerSize;
+      auto column = attr.data<T>();
+      switch (width) {
+      case 1: writeNarrow<int8_t>(values, column, n, base); break;
+      case 2: writeNarrow<int16_t>(values, column, n, base); break;
+      default: writeNarrow<int32_t>(values, column, n, base); break;
+      }
+      writeHeader(out.header(), type, 1, size, source);
+   }
+   auto narrow = make_unique<Narrow>();
+   narrow->data_.readBinary(file.c_str(), sizeof(ColumnHeader));
+   attr.narrow = move(narrow);
+}
+
+/// Writes the frame of reference and bit packing encoding of the n 32 bit
+/// values to file
+void writePacked(const std::string& file, const int32_t* values, size_t n,
+                 RTType type, const SourceInfo& source) {
+   using MinMax = std::pair<int32_t, int32_t>;
+   auto range = tbb::parallel_reduce(
+       tbb::blocked_range<size_t>(0, n, 100000),
+       MinMax(std::numeric_limits<int32_t>::max(),
+              std::numeric_limits<int32_t>::min()),
+       [&](const tbb::blocked_range<size_t>& r, MinMax m) {
+          for (auto i = r.begin(); i != r.end(); ++i)
+             m = MinMax(min(m.first, values[i]), max(m.second, values[i]));
+          return m;
+       },
+       [](const MinMax& a, const MinMax& b) {
+          return MinMax(min(a.first, b.first), max(a.second, b.second));
+       });
+   // the minimum is the frame of reference
+   int32_t base = n ? range.first : 0;
+   unsigned bits = n ? runtime::bitsFor(int64_t(range.second) - base) : 1;
+   auto size = 8 + runtime::packedSize(n, bits);
+   runtime::Vector<uint8_t> out;
+   out.createBinary(file.c_str(), size, sizeof(ColumnHeader));
+   reinterpret_cast<int32_t*>(out.data())[0] = base;
+   reinterpret_cast<uint32_t*>(out.data())[1] = bits;
+   auto chunkSize = runtime::packChunkSize;
+   tbb::parallel_for(
+       tbb::blocked_range<size_t>(0, (n + chunkSize - 1) / chunkSize),
+       [&](const tbb::blocked_range<size_t>& r) {
+          for (auto c = r.begin(); c != r.end(); ++c)
+             runtime::packChunk(values + c * chunkSize,
+                                min(chunkSize, n - c * chunkSize), base, bits,
+                                out.data() + 8 + c * bits * 8);
+       });
+   writeHeader(out.header(), type, 1, size, source);
+}
+
+/// Maps the bit packed encoding name.packed of the cached 32 bit column name
+/// into attr, building it first if necessary
+void bitPack(runtime::Attribute& attr, const std::string& name, RTType type,
+             const SourceInfo& source, bool verifyChecksum) {
+   auto file = name + ".packed";
+   auto n = attr.data_.size();
+   auto valid = [&](runtime::PackedColumn& packed) {
+      uint64_t count = 0;
+      if (!validCache(file, type, 1, source, verifyChecksum, count) ||
+          count < 8)
+         return false;
+      packed.data_.readBinary(file.c_str(), sizeof(ColumnHeader));
+      return packed.bits() <= 32 &&
+             packed.memory() == 8 + runtime::packedSize(n, packed.bits());
+   };
+   auto packed = make_unique<runtime::PackedColumn>();
+   if (!valid(*packed)) {
+      writePacked(file, reinterpret_cast<int32_t*>(attr.data()), n, type,
+                  source);
+      if (!valid(*packed))
+         throw runtime_error("Could not bit pack " + name);
+   }
+   attr.packed = move(packed);
+}
+
+/// Writes the strings of column back to back to name.heap and their offsets
+/// to name.offsets
+template <typename T>
+void writeStringHeap(const std::string& name, const runtime::Vector<T>& column,
+                     RTType type, const SourceInfo& source) {
+   auto n = column.size();
+   runtime::Vector<uint64_t> offsets;
+   offsets.createBinary((name + ".offsets").c_str(), n + 1,
+                        sizeof(ColumnHeader));
+   offsets[0] = 0;
+   for (size_t i = 0; i < n; i++) offsets[i + 1] = offsets[i] + column[i].len;
+   runtime::Vector<char> heap;
+   heap.createBinary((name + ".heap").c_str(), offsets[n],
+                     sizeof(ColumnHeader));
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, n, 100000),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto i = r.begin(); i != r.end(); ++i)
+                           memcpy(heap.data() + offsets[i], column[i].value,
+                                  column[i].len);
+                     });
+   writeHeader(offsets.header(), type, sizeof(uint64_t), n + 1, source);
+   writeHeader(heap.header(), type, 1, offsets[n], source);
+}
+
+/// Maps the string heap of the cached Varchar column name into attr,
+/// building it first if necessary
+template <typename T>
+void stringHeap(runtime::Attribute& attr, const std::string& name,
+                RTType type, const SourceInfo& source, bool verifyChecksum) {
+   auto& column = attr.typedAccess<T>();
+   auto n = column.size();
+   auto strings = make_unique<runtime::StringColumn>();
+   auto valid = [&]() {
+      uint64_t offsets = 0, bytes = 0;
+      if (!validCache(name + ".offsets", type, sizeof(uint64_t), source,
+                      verifyChecksum, offsets) ||
+          offsets != n + 1 ||
+          !validCache(name + ".heap", type, 1, source, verifyChecksum, bytes))
+         return false;
+      strings->offsets_.readBinary((name + ".offsets").c_str(),
+                                   sizeof(ColumnHeader));
+      return strings->offsets_[n] == bytes;
+   };
+   if (!valid()) {
+      writeStringHeap(name, column, type, source);
+      if (!valid())
+         throw runtime_error("Could not build string heap for " + name);
+   }
+   strings->heap_.readBinary((name + ".heap").c_str(), sizeof(ColumnHeader));
+   attr.strings = move(strings);
+}
+
+/// Writes the dense key index of the n keys to file, rows of missing keys
+/// are 0
+template <typename R>
+void writeKeyIndex(const std::string& file, const types::Integer* keys,
+                   size_t n, const SourceInfo& source) {
+   auto maxKey = tbb::parallel_reduce(
+       tbb::blocked_range<size_t>(0, n, 100000), int32_t(-1),
+       [&](const tbb::blocked_range<size_t>& r, int32_t m) {
+          for (auto i = r.begin(); i != r.end(); ++i)
+             m = max(m, keys[i].value);
+          return m;
+       },
+       [](int32_t a, int32_t b) { return max(a, b); });
+   runtime::Vector<R> rows;
+   size_t size = maxKey + 1;
+   rows.createBinary(file.c_str(), size, sizeof(ColumnHeader));
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, n, 100000),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto i = r.begin(); i != r.end(); ++i)
+                           rows[keys[i].value] = i;
+                     });
+   writeHeader(rows.header(), Integer, sizeof(R), size, source);
+}
+
+/// Maps the dense index of the integer key column of rel from the cache of
+/// table in dir, building it first if necessary
+void keyIndex(runtime::KeyIndex& index, runtime::Relation& rel,
+              std::string key, std::string dir, std::string table) {
+   SourceInfo source(dir + table + ".tbl");
+   // row ids depend on the order of the relation
+   if (!rel.sortKey.empty()) table += "_by_" + rel.sortKey;
+   auto file = dir + "/cached/" + table + "_" + key + ".index";
+   auto verify = getenv("verifyCache");
+   bool verifyChecksum = verify && atoi(verify);
+   index.relation = rel.name;
+   index.key = key;
+   index.rowIdSize = rel.nrTuples <= std::numeric_limits<uint32_t>::max()
+                         ? sizeof(uint32_t)
+                         : sizeof(uint64_t);
+   uint64_t count = 0;
+   if (!validCache(file, Integer, index.rowIdSize, source, verifyChecksum,
+                   count)) {
+      auto start = gettime();
+      auto keys = rel[key].data<types::Integer>();
+      if (index.rowIdSize == sizeof(uint32_t))
+         writeKeyIndex<uint32_t>(file, keys, rel.nrTuples, source);
+      else
+         writeKeyIndex<uint64_t>(file, keys, rel.nrTuples, source);
+      cerr << "Building index " << table << "_" << key << " time "
+           << (gettime() - start) << endl;
+   }
+   if (index.rowIdSize == sizeof(uint32_t))
+      index.typedRowsForChange<uint32_t>().readBinary(file.c_str(),
+                                                      sizeof(ColumnHeader));
+   else
+      index.typedRowsForChange<uint64_t>().readBinary(file.c_str(),
+                                                      sizeof(ColumnHeader));
+}
+
+/// Whether list selects attribute attr of table. It lists tables and
+/// table.attribute entries, or is 1 for all attributes.
+bool selects(const std::string& list, const std::string& table,
+             const std::string& attr) {
+   if (list == "1") return true;
+   istringstream entries(list);
+   string entry;
+   while (getline(entries, entry, ','))
+      if (entry == table || entry == table + "." + attr) return true;
+   return false;
+}
+
+/// Whether the env variable hugePages selects attribute attr of table for
+/// memory backed by huge pages, see selects
+bool onHugePages(const std::string& table, const std::string& attr) {
+   auto list = getenv("hugePages");
+   return list && selects(list, table, attr);
+}
+
+/// Whether the env variable statistics selects attribute attr of table for
+/// statistics, see selects. Without it only the attributes the queries
+/// estimate from get them.
+bool withStatistics(const std::string& table, const std::string& attr) {
+   auto list = getenv("statistics");
+   return selects(list ? list : "lineitem.l_orderkey", table, attr);
 }
 
 size_t readBinary(runtime::Relation& r, ColumnConfig& col, std::string path) {
@@ -197,7 +982,7 @@ size_t readBinary(runtime::Relation& r, ColumnConfig& col, std::string path) {
       /* attr.name = col.name;   */                                            \
       /*attr.type = col.type;  */                                              \
       auto& data = attr.typedAccessForChange<rt_type>();                       \
-      data.readBinary(name.data());                                            \
+      data.readBinary(name.data(), sizeof(ColumnHeader));                      \
       return data.size();                                                      \
    }
    switch (algebraToRTType(col.type)) {
@@ -206,6 +991,85 @@ size_t readBinary(runtime::Relation& r, ColumnConfig& col, std::string path) {
 #undef D
 }
 
+/// Sort key of table given in the sortKeys env var as a comma separated
+/// list of table.attribute, empty if the table is not sorted
+std::string sortKeyOf(const std::string& table) {
+   auto keys = getenv("sortKeys");
+   if (!keys) return "";
+   istringstream list(keys);
+   string entry;
+   while (getline(list, entry, ','))
+      if (entry.substr(0, entry.find('.')) == table)
+         return entry.substr(entry.find('.') + 1);
+   return "";
+}
+
+/// Positions of the n keys in ascending order, ties keep the .tbl order
+template <typename T>
+std::vector<uint64_t> sortOrder(const T* keys, size_t n) {
+   std::vector<uint64_t> order(n);
+   tbb::parallel_for(tbb::blocked_range<size_t>(0, n),
+                     [&](const tbb::blocked_range<size_t>& r) {
+                        for (auto i = r.begin(); i != r.end(); ++i)
+                           order[i] = i;
+                     });
+   tbb::parallel_sort(order.begin(), order.end(), [&](uint64_t a, uint64_t b) {
+      return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+   });
+   return order;
+}
+
+/// Maps the columns of r sorted by key from the cache at path, building
+/// them from the .tbl ordered columns first if necessary
+void sortColumns(runtime::Relation& r, std::vector<ColumnConfig>& cols,
+                 std::vector<ColumnParser>& parsers, const std::string& key,
+                 const std::string& path, const SourceInfo& source,
+                 bool verifyChecksum) {
+   bool valid = true;
+   for (size_t c = 0; c < cols.size(); c++) {
+      uint64_t count = 0;
+      valid &= validCache(path + "_" + cols[c].name, parsers[c].type,
+                          parsers[c].typeSize, source, verifyChecksum,
+                          count) &&
+               count == r.nrTuples;
+   }
+   if (!valid) {
+      auto start = gettime();
+      auto k = std::find_if(cols.begin(), cols.end(),
+                            [&](ColumnConfig& c) { return c.name == key; });
+      if (k == cols.end())
+         throw runtime_error("Unknown sort key " + key + " of " + r.name);
+      std::vector<uint64_t> order;
+#define D(T)                                                                   \
+   order = sortOrder(r[key].data<T>(), r.nrTuples);                            \
+   break;
+      switch (parsers[k - cols.begin()].type) {
+         EACHNUMERICTYPE
+      default: throw runtime_error("Sort key " + key + " is not numeric");
+      }
+#undef D
+      for (size_t c = 0; c < cols.size(); c++) {
+         auto typeSize = parsers[c].typeSize;
+         auto in = reinterpret_cast<const uint8_t*>(r[cols[c].name].data());
+         runtime::Vector<uint8_t> out;
+         out.createBinary((path + "_" + cols[c].name).c_str(),
+                          r.nrTuples * typeSize, sizeof(ColumnHeader));
+         tbb::parallel_for(tbb::blocked_range<size_t>(0, r.nrTuples),
+                           [&](const tbb::blocked_range<size_t>& range) {
+                              for (auto i = range.begin(); i != range.end();
+                                   ++i)
+                                 memcpy(out.data() + i * typeSize,
+                                        in + order[i] * typeSize, typeSize);
+                           });
+         writeHeader(out.header(), parsers[c].type, typeSize, r.nrTuples,
+                     source);
+      }
+      cerr << "Sorting " << r.name << " by " << key << " time "
+           << (gettime() - start) << endl;
+   }
+   for (auto& col : cols) readBinary(r, col, path);
+}
+
 // void buildIndex(runtime::Relation& indx, std::vector<ColumnConfigOwning>&
 // cols,
 //                 std::vector<std::vector<size_t>> attributes, std::string dir,
@@ -244,53 +1108,174 @@ size_t readBinary(runtime::Relation& r, ColumnConfig& col, std::string path) {
 //       throw runtime_error("Columns of " + fileName + " differ in size.");
 //    indx.nrTuples = size;
 // }
-void parseColumns(runtime::Relation& r, std::vector<ColumnConfigOwning>& cols,
-                  std::string dir, std::string fileName) {
+/// Bytes of the cached files mapped by the attributes of r
+size_t mappedBytes(runtime::Relation& r) {
+   size_t bytes = 0;
+   for (auto& a : r.attributes) {
+      auto& attr = a.second;
+      bytes += attr.data_.mappedBytes();
+      if (attr.dictionary)
+         bytes += attr.dictionary->values_.mappedBytes() +
+                  attr.dictionary->codes_.mappedBytes();
+      if (attr.zoneMap) bytes += attr.zoneMap->bounds_.mappedBytes();
+      if (attr.packed) bytes += attr.packed->data_.mappedBytes();
+      if (attr.strings)
+         bytes += attr.strings->offsets_.mappedBytes() +
+                  attr.strings->heap_.mappedBytes();
+      if (attr.statistics) bytes += attr.statistics->data_.mappedBytes();
+      if (attr.narrow) bytes += attr.narrow->data_.mappedBytes();
+   }
+   return bytes;
+}
 
+TableLoad parseColumns(runtime::Relation& r,
+                       std::vector<ColumnConfigOwning>& cols, std::string dir,
+                       std::string fileName) {
+   auto start = gettime();
    std::vector<ColumnConfig> colsC;
    for (auto& col : cols) {
       colsC.emplace_back(col.name, col.type.get());
       r.insert(col.name, move(col.type));
    }
 
-   bool allColumnsMMaped = true;
    string cachedir = dir + "/cached/";
-   if (!mkdir((dir + "/cached/").c_str(), 0777))
-      throw runtime_error("Could not create dir 'cached': " + dir + "/cached/");
-   for (auto& col : colsC)
-      if (!std::ifstream(cachedir + fileName + "_" + col.name))
-         allColumnsMMaped = false;
-
-   if (!allColumnsMMaped) {
-      std::vector<std::vector<void*>> attributes;
-      attributes.assign(colsC.size(), {});
-      ifstream relationFile(dir + fileName + ".tbl");
-      if (!relationFile.is_open())
-         throw runtime_error("csv file not found: " + dir);
-      string line;
-      unsigned begin = 0, end;
+   if (mkdir(cachedir.c_str(), 0777) && errno != EEXIST)
+      throw runtime_error("Could not create dir 'cached': " + cachedir);
+
+   // rebuild the cached columns which are missing or outdated
+   SourceInfo source(dir + fileName + ".tbl");
+   auto verify = getenv("verifyCache");
+   bool verifyChecksum = verify && atoi(verify);
+   auto pack = getenv("packColumns");
+   bool packColumns = pack && atoi(pack);
+   auto heaps = getenv("stringHeap");
+   bool stringHeaps = heaps && atoi(heaps);
+   auto numa = getenv("numaPlacement");
+   bool numaPlacement = numa && atoi(numa);
+   auto narrow = getenv("narrowColumns");
+   bool narrowColumns = narrow && atoi(narrow);
+   auto dicts = getenv("dictionaries");
+   bool dictionaries = dicts && atoi(dicts);
+   std::vector<ColumnParser> parsers;
+   std::vector<bool> rebuild;
+   uint64_t cachedCount = 0;
+   bool outdated = false, sameCount = true, merged = false;
+   for (auto& col : colsC) {
+      parsers.emplace_back(col);
       uint64_t count = 0;
-      while (getline(relationFile, line)) {
-         count++;
-         unsigned i = 0;
-         for (auto& col : colsC) parse(col, attributes[i++], line, begin, end);
-         begin = 0;
-      }
-      count = 0;
-      for (auto& col : colsC)
-         writeBinary(col, attributes[count++], cachedir + fileName);
+      auto file = cachedir + fileName + "_" + col.name;
+      bool valid = validCache(file, parsers.back().type,
+                              parsers.back().typeSize, source, verifyChecksum,
+                              count);
+      if (valid && cachedCount && count != cachedCount) sameCount = false;
+      if (valid) cachedCount = count;
+      rebuild.push_back(!valid);
+      outdated |= !valid;
+      merged |= deltaMerged(file);
    }
-   // load mmaped files
-   size_t size = 0;
-   size_t diffs = 0;
-   for (auto& col : colsC) {
-      auto oldSize = size;
-      size = readBinary(r, col, cachedir + fileName);
-      diffs += (oldSize != size);
+   if (!sameCount) rebuild.assign(colsC.size(), true);
+   size_t bytesParsed = 0;
+   if (outdated || !sameCount) {
+      // parsing the .tbl file would silently drop the merged tuples
+      if (merged)
+         throw runtime_error("Cached columns of " + fileName +
+                             " hold merged tuples and cannot be rebuilt "
+                             "from its .tbl file, remove " + cachedir +
+                             fileName + "_* to import it again");
+      parseTable(parsers, rebuild, colsC, source, dir, fileName);
+      bytesParsed = source.size;
    }
-   if (diffs > 1)
+   // load mmaped files, one task per column
+   std::vector<size_t> sizes(colsC.size());
+   tbb::parallel_for(size_t(0), colsC.size(), [&](size_t c) {
+      sizes[c] = readBinary(r, colsC[c], cachedir + fileName);
+   });
+   if (std::adjacent_find(sizes.begin(), sizes.end(),
+                          std::not_equal_to<size_t>()) != sizes.end())
       throw runtime_error("Columns of " + fileName + " differ in size.");
-   r.nrTuples = size;
+   r.nrTuples = sizes.empty() ? 0 : sizes.front();
+
+   // cluster the relation by its sort key, the encodings follow its order
+   auto path = cachedir + fileName;
+   auto sortKey = sortKeyOf(fileName);
+   if (!sortKey.empty()) {
+      path += "_by_" + sortKey;
+      sortColumns(r, colsC, parsers, sortKey, path, source, verifyChecksum);
+      r.sortKey = sortKey;
+   }
+
+   // dictionary encode fixed size strings if requested, zone maps for
+   // numbers and dates, statistics for the selected attributes and the
+   // narrowed ones, one task per column
+   tbb::parallel_for(size_t(0), colsC.size(), [&](size_t c) {
+      auto name = path + "_" + colsC[c].name;
+      auto& attr = r[colsC[c].name];
+#define D(T)                                                                   \
+   dictionaryEncode<T>(attr, name, parsers[c].type, source,                    \
+                          verifyChecksum);                                     \
+   break;
+      if (dictionaries) {
+         switch (parsers[c].type) {
+            EACHCHARTYPE
+         default: break;
+         }
+      }
+#undef D
+#define D(T)                                                                   \
+   zoneMap<T>(attr, name, parsers[c].type, source, verifyChecksum);            \
+   break;
+      switch (parsers[c].type) {
+         EACHNUMERICTYPE
+      default: break;
+      }
+#undef D
+#define D(T)                                                                   \
+   statistics<T>(attr, name, parsers[c].type, source, verifyChecksum);         \
+   break;
+      if (narrowColumns || withStatistics(fileName, colsC[c].name)) {
+         switch (parsers[c].type) {
+            EACHTYPE
+         default: break;
+         }
+      }
+#undef D
+      // narrow physical types from the value range of the statistics
+#define D(T)                                                                   \
+   narrowColumn<T>(attr, name, parsers[c].type, source, verifyChecksum);       \
+   break;
+      if (narrowColumns) {
+         switch (parsers[c].type) {
+            EACHNUMERICTYPE
+         default: break;
+         }
+      }
+#undef D
+      // 32 bit integers and dates
+      if (packColumns &&
+          (parsers[c].type == Integer || parsers[c].type == Date))
+         bitPack(attr, name, parsers[c].type, source, verifyChecksum);
+      if (!stringHeaps) return;
+#define D(T)                                                                   \
+   stringHeap<T>(attr, name, parsers[c].type, source, verifyChecksum);         \
+   break;
+      switch (parsers[c].type) {
+         EACHVARCHARTYPE
+      default: break;
+      }
+#undef D
+   });
+   if (numaPlacement) {
+      r.placeOnNodes([&](const std::string& attr) {
+         return onHugePages(r.name, attr);
+      });
+   } else {
+      // hot columns, e.g. those accessed through indexes, suffer less dTLB
+      // misses on huge pages than on the 4 KiB pages of the mapped files
+      for (auto& attr : r.attributes)
+         if (onHugePages(fileName, attr.first))
+            attr.second.data_.moveToAnonymous([](uint8_t*, size_t) {}, true);
+   }
+   return {fileName, gettime() - start, mappedBytes(r), bytesParsed};
 }
 
 std::vector<ColumnConfigOwning>
@@ -301,8 +1286,125 @@ configX(std::initializer_list<ColumnConfigOwning>&& l) {
    return v;
 }
 
+/// Loads the tables of a benchmark on the tbb scheduler: every table is a
+/// task, index builds are tasks which start once the tables they read are
+/// loaded
+class LoadGraph {
+   using Node = tbb::flow::continue_node<tbb::flow::continue_msg>;
+   std::string dir;
+   tbb::flow::graph graph;
+   std::deque<Node> nodes;
+   std::deque<std::vector<ColumnConfigOwning>> columns;
+   std::unordered_map<std::string, Node*> tables;
+   std::mutex reportMutex;
+   std::vector<TableLoad> report;
+
+   void record(TableLoad load) {
+      std::lock_guard<std::mutex> lock(reportMutex);
+      report.push_back(move(load));
+   }
+
+ public:
+   LoadGraph(std::string d) : dir(d) {}
+   /// Adds the task loading rel with the columns cols
+   void table(runtime::Relation& rel, std::vector<ColumnConfigOwning>&& cols) {
+      columns.push_back(move(cols));
+      auto& c = columns.back();
+      nodes.emplace_back(graph,
+                         [this, &rel, &c](const tbb::flow::continue_msg&) {
+                            record(parseColumns(rel, c, dir, rel.name));
+                            return tbb::flow::continue_msg();
+                         });
+      tables[rel.name] = &nodes.back();
+   }
+   /// Adds the task build named name, which reads the tables reads
+   void index(std::string name, std::initializer_list<std::string> reads,
+              std::function<void()> build) {
+      nodes.emplace_back(graph,
+                         [this, name, build](const tbb::flow::continue_msg&) {
+                            auto start = gettime();
+                            build();
+                            record({name, gettime() - start, 0, 0});
+                            return tbb::flow::continue_msg();
+                         });
+      for (auto& table : reads)
+         tbb::flow::make_edge(*tables.at(table), nodes.back());
+   }
+   /// Runs all tasks and prints the loading report
+   std::vector<TableLoad> run() {
+      auto start = gettime();
+      for (auto& table : tables)
+         table.second->try_put(tbb::flow::continue_msg());
+      graph.wait_for_all();
+      auto time = gettime() - start;
+      size_t mapped = 0, parsed = 0;
+      cerr << "Loading report" << endl << "name\ttime\tMB mapped\tMB parsed"
+           << endl;
+      for (auto& load : report) {
+         cerr << load.name << "\t" << load.time << "\t"
+              << load.bytesMapped / (1024.0 * 1024) << "\t"
+              << load.bytesParsed / (1024.0 * 1024) << endl;
+         mapped += load.bytesMapped;
+         parsed += load.bytesParsed;
+      }
+      cerr << "total\t" << time << "\t" << mapped / (1024.0 * 1024) << "\t"
+           << parsed / (1024.0 * 1024) << endl;
+      return move(report);
+   }
+};
+
+/// Builds the index of the tuples of inner joining each tuple of outer:
+/// the matches of tuple i of outer are indexVals[index[i - 1], index[i])
+void buildJoinIndex(std::vector<size_t>& index, std::vector<size_t>& indexVals,
+                    runtime::Relation& outer, const std::string& outerKey,
+                    runtime::Relation& inner, const std::string& innerKey) {
+   auto outerKeys = outer[outerKey].data<types::Integer>();
+   auto innerKeys = inner[innerKey].data<types::Integer>();
+
+   // index tasks may run on threads without a worker, the entries are
+   // allocated from a pool which is released with the index build
+   runtime::GlobalPool pool;
+   runtime::WorkerScope scope;
+   runtime::Worker worker(nullptr, nullptr, pool);
+
+   using hash = runtime::CRC32Hash;
+   Hashmapx<types::Integer, size_t, hash> ht;
+   runtime::Stack<decltype(ht)::Entry> entries;
+   size_t count = 0;
+   for (size_t i = inner.nrTuples - 1;; i--) {
+      entries.emplace_back(ht.hash(innerKeys[i]), innerKeys[i], i);
+      count++;
+      if (i == 0) break;
+   }
+   ht.setSize(count);
+   ht.insertAll(entries);
+
+   // iterate over outer table
+   size_t cnt = 0;
+   for (size_t i = 0; i < outer.nrTuples; i++) {
+      auto h = ht.hash(outerKeys[i]);
+
+      auto entry =
+          reinterpret_cast<decltype(ht)::Entry*>(ht.find_chain_tagged(h));
+
+      for (; entry != ht.end();
+           entry = reinterpret_cast<decltype(ht)::Entry*>(entry->h.next))
+         if (entry->h.hash == h && entry->k == outerKeys[i]) {
+#ifdef VERBOSE
+            cout << "*"
+                 << "\t" << i << "\t" << outerKeys[i] << "\t" << entry->v
+                 << endl;
+#endif
+            indexVals.emplace_back(entry->v);
+            cnt++;
+         }
+      index.emplace_back(cnt);
+   }
+}
+
 namespace runtime {
-void importTPCH(std::string dir, Database& db) {
+std::vector<TableLoad> importTPCH(std::string dir, Database& db) {
+   LoadGraph loads(dir);
 
    //--------------------------------------------------------------------------------
    // part
@@ -319,7 +1421,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"p_container", make_unique<algebra::Char>(10)},
                    {"p_retailprice", make_unique<algebra::Numeric>(12, 2)},
                    {"p_comment", make_unique<algebra::Varchar>(23)}});
-      parseColumns(rel, columns, dir, "part");
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // supplier
@@ -334,7 +1436,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"s_phone", make_unique<algebra::Char>(15)},
                    {"s_acctbal", make_unique<algebra::Numeric>(12, 2)},
                    {"s_comment", make_unique<algebra::Varchar>(101)}});
-      parseColumns(rel, columns, dir, "supplier");
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // partsupp
@@ -347,7 +1449,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"ps_availqty", make_unique<algebra::Integer>()},
                    {"ps_supplycost", make_unique<algebra::Numeric>(12, 2)},
                    {"ps_comment", make_unique<algebra::Varchar>(199)}});
-      parseColumns(rel, columns, dir, "partsupp");
+      loads.table(rel, move(columns));
    }
    //------------------------------------------------------------------------------
    // customer
@@ -364,7 +1466,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"c_mktsegment", make_unique<algebra::Char>(10)},
                    {"c_comment", make_unique<algebra::Varchar>(117)}});
 
-      parseColumns(cu, columns, dir, "customer");
+      loads.table(cu, move(columns));
    }
 
    //------------------------------------------------------------------------------
@@ -382,7 +1484,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"o_clerk", make_unique<algebra::Char>(15)},
                    {"o_shippriority", make_unique<algebra::Integer>()},
                    {"o_comment", make_unique<algebra::Varchar>(79)}});
-      parseColumns(od, columns, dir, "orders");
+      loads.table(od, move(columns));
    }
    //--------------------------------------------------------------------------------
    // lineitem
@@ -407,7 +1509,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"l_shipmode", make_unique<algebra::Char>(10)},
                    {"l_comment", make_unique<algebra::Varchar>(44)}});
 
-      parseColumns(li, columns, dir, "lineitem");
+      loads.table(li, move(columns));
    }
    //--------------------------------------------------------------------------------
    // nation
@@ -419,7 +1521,7 @@ void importTPCH(std::string dir, Database& db) {
                    {"n_name", make_unique<algebra::Char>(25)},
                    {"n_regionkey", make_unique<algebra::Integer>()},
                    {"n_comment", make_unique<algebra::Varchar>(152)}});
-      parseColumns(rel, columns, dir, "nation");
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // region
@@ -430,112 +1532,33 @@ void importTPCH(std::string dir, Database& db) {
           configX({{"r_regionkey", make_unique<algebra::Integer>()},
                    {"r_name", make_unique<algebra::Char>(25)},
                    {"r_comment", make_unique<algebra::Varchar>(152)}});
-      parseColumns(rel, columns, dir, "region");
-   }
-   {
-      auto start = gettime();
-
-      // build indexes
-      {
-         auto& indx = db.getindex("cust_ord");
-         auto& indx_val = db.getindex("cust_ord_vals");
-
-         auto& cu = db["customer"];
-         auto& ord = db["orders"];
-
-         auto c_custkey = cu["c_custkey"].data<types::Integer>();
-         auto o_custkey = ord["o_custkey"].data<types::Integer>();
-         //  auto o_orderkey = ord["o_orderkey"].data<types::Integer>();
-
-         using hash = runtime::CRC32Hash;
-         Hashmapx<types::Integer, size_t, hash> ht;
-         runtime::Stack<decltype(ht)::Entry> entries;
-         size_t count = 0;
-         for (size_t i = ord.nrTuples - 1;; i--) {
-            entries.emplace_back(ht.hash(o_custkey[i]), o_custkey[i], i);
-            count++;
-            if (i == 0) break;
-         }
-         ht.setSize(count);
-         ht.insertAll(entries);
-         // cout << "+++++++++++++++++++++++++++++++++++++" << endl;
-         // iterate over customer table
-         size_t cnt = 0;
-         for (size_t i = 0; i < cu.nrTuples; i++) {
-            auto h = ht.hash(c_custkey[i]);
-
-            auto entry =
-                reinterpret_cast<decltype(ht)::Entry*>(ht.find_chain_tagged(h));
-
-            for (; entry != ht.end();
-                 entry = reinterpret_cast<decltype(ht)::Entry*>(entry->h.next))
-               if (entry->h.hash == h && entry->k == c_custkey[i]) {
-#ifdef VERBOSE
-                  cout << "*"
-                       << "\t" << i << "\t" << c_custkey[i] << "\t" << entry->v
-                       << endl;
-#endif
-                  indx_val.emplace_back(entry->v);
-                  cnt++;
-               }
-            indx.emplace_back(cnt);
-         }
-      }
-
-      // build indexes
-      {
-         auto& indx = db.getindex("ord_li");
-         auto& indx_val = db.getindex("ord_li_vals");
-
-         auto& ord = db["orders"];
-         auto& li = db["lineitem"];
-
-         auto l_orderkey = li["l_orderkey"].data<types::Integer>();
-         auto o_orderkey = ord["o_orderkey"].data<types::Integer>();
-
-         using hash = runtime::CRC32Hash;
-         Hashmapx<types::Integer, size_t, hash> ht;
-         runtime::Stack<decltype(ht)::Entry> entries;
-         size_t count = 0;
-         //  cout << "+++++++++++++++++++++++++++++++++++" << endl;
-         for (size_t i = li.nrTuples - 1;; i--) {
-            entries.emplace_back(ht.hash(l_orderkey[i]), l_orderkey[i], i);
-            count++;
-            if (i == 0) break;
-         }
-         // cout << "count " << count << endl;
-         ht.setSize(count);
-         ht.insertAll(entries);
-
-         // iterate over orders table
-         size_t cnt = 0;
-         for (size_t i = 0; i < ord.nrTuples; i++) {
-            auto h = ht.hash(o_orderkey[i]);
-
-            auto entry =
-                reinterpret_cast<decltype(ht)::Entry*>(ht.find_chain_tagged(h));
-
-            for (; entry != ht.end();
-                 entry =
-                     reinterpret_cast<decltype(ht)::Entry*>(entry->h.next)) {
-               if (entry->h.hash == h && entry->k == o_orderkey[i]) {
-#ifdef VERBOSE
-                  cout << "*"
-                       << "\t" << i << "\t" << o_orderkey[i] << "\t" << entry->v
-                       << endl;
-#endif
-                  indx_val.emplace_back(entry->v);
-                  cnt++;
-               }
-            }
-            indx.emplace_back(cnt);
-         }
-         // cout << "cnt " << cnt << endl;
-      }
-      auto end = gettime();
-
-      cerr << "Building index time " << (end - start) << endl;
+      loads.table(rel, move(columns));
    }
+   // build indexes once the tables they read are loaded, the tasks only get
+   // references as the database must not change concurrently
+   auto& cu = db["customer"];
+   auto& ord = db["orders"];
+   auto& li = db["lineitem"];
+   auto& cust_ord = db.getindex("cust_ord");
+   auto& cust_ord_vals = db.getindex("cust_ord_vals");
+   loads.index("cust_ord", {"customer", "orders"}, [&]() {
+      buildJoinIndex(cust_ord, cust_ord_vals, cu, "c_custkey", ord,
+                     "o_custkey");
+   });
+   auto& ord_li = db.getindex("ord_li");
+   auto& ord_li_vals = db.getindex("ord_li_vals");
+   loads.index("ord_li", {"orders", "lineitem"}, [&]() {
+      buildJoinIndex(ord_li, ord_li_vals, ord, "o_orderkey", li, "l_orderkey");
+   });
+   auto& orders_key = db.getKeyIndex("orders_key");
+   loads.index("orders_key", {"orders"}, [&]() {
+      keyIndex(orders_key, ord, "o_orderkey", dir, "orders");
+   });
+   auto& customer_key = db.getKeyIndex("customer_key");
+   loads.index("customer_key", {"customer"}, [&]() {
+      keyIndex(customer_key, cu, "c_custkey", dir, "customer");
+   });
+   auto report = loads.run();
 #ifdef VERBOSE
    cout << "______________________________________________" << endl;
    {
@@ -562,42 +1585,11 @@ void importTPCH(std::string dir, Database& db) {
    }
    cout << "______________________________________________" << endl;
 #endif
-
-   {
-      auto& indx = db.getindex("orders_key");
-
-      auto& ord = db["orders"];
-
-      auto o_orderkey = ord["o_orderkey"].data<types::Integer>();
-      auto max_order_key = o_orderkey[0];
-      for (size_t i = 1; i < ord.nrTuples; i++)
-         max_order_key = max(max_order_key, o_orderkey[i]);
-
-      indx.resize(max_order_key.value);
-      for (size_t i = 0; i < ord.nrTuples; i++) {
-         auto j = o_orderkey[i].value;
-         indx[j] = i;
-      }
-   }
-
-   {
-      auto& indx = db.getindex("customer_key");
-      auto& cu = db["customer"];
-      auto c_custkey = cu["c_custkey"].data<types::Integer>();
-
-      auto max_cust_key = c_custkey[0];
-      for (size_t i = 1; i < cu.nrTuples; i++)
-         max_cust_key = max(max_cust_key, c_custkey[i]);
-
-      indx.resize(max_cust_key.value);
-      for (size_t i = 0; i < cu.nrTuples; i++) {
-         auto j = c_custkey[i].value;
-         indx[j] = i;
-      }
-   }
+   return report;
 }
 
-void importSSB(std::string dir, Database& db) {
+std::vector<TableLoad> importSSB(std::string dir, Database& db) {
+   LoadGraph loads(dir);
 
    //--------------------------------------------------------------------------------
    // lineorder
@@ -622,7 +1614,7 @@ void importSSB(std::string dir, Database& db) {
                    {"lo_tax", make_unique<algebra::Integer>()},
                    {"lo_commitdate", make_unique<algebra::Integer>()},
                    {"lo_shopmode", make_unique<algebra::Char>(10)}});
-      parseColumns(rel, columns, dir, rel.name);
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // part
@@ -638,7 +1630,7 @@ void importSSB(std::string dir, Database& db) {
                               {"p_type", make_unique<algebra::Varchar>(25)},
                               {"p_size", make_unique<algebra::Integer>()},
                               {"p_container", make_unique<algebra::Char>(10)}});
-      parseColumns(rel, columns, dir, rel.name);
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // supplier
@@ -652,7 +1644,7 @@ void importSSB(std::string dir, Database& db) {
                               {"s_nation", make_unique<algebra::Char>(15)},
                               {"s_region", make_unique<algebra::Char>(12)},
                               {"s_phone", make_unique<algebra::Char>(15)}});
-      parseColumns(rel, columns, dir, rel.name);
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // customer
@@ -668,7 +1660,7 @@ void importSSB(std::string dir, Database& db) {
                    {"c_region", make_unique<algebra::Char>(12)},
                    {"c_phone", make_unique<algebra::Char>(15)},
                    {"c_mktsegment", make_unique<algebra::Char>(10)}});
-      parseColumns(rel, columns, dir, rel.name);
+      loads.table(rel, move(columns));
    }
    //--------------------------------------------------------------------------------
    // date
@@ -693,7 +1685,50 @@ void importSSB(std::string dir, Database& db) {
                    {"d_lastdayinmonthfl", make_unique<algebra::Integer>()},
                    {"d_holidayfl", make_unique<algebra::Integer>()},
                    {"d_weekdayfl", make_unique<algebra::Integer>()}});
-      parseColumns(rel, columns, dir, rel.name);
+      loads.table(rel, move(columns));
    }
+   return loads.run();
+}
+
+std::future<void> mergeDelta(Relation& rel) {
+   return std::async(std::launch::async, [&rel]() {
+      auto start = gettime();
+      for (auto& attr : rel.attributes) {
+         auto& data = attr.second.data_;
+         auto& path = data.path();
+         if (path.empty())
+            throw runtime_error("Attribute " + attr.first + " of " + rel.name +
+                                " was not imported from a cached column");
+         auto typeSize = attr.second.type->rt_size();
+         auto bytes = rel.nrTuples * typeSize;
+         auto merged = path + ".merge";
+         runtime::Vector<uint8_t> out;
+         out.createBinary(merged.c_str(), bytes, sizeof(ColumnHeader));
+         auto in = reinterpret_cast<const uint8_t*>(data.data());
+         tbb::parallel_for(tbb::blocked_range<size_t>(0, bytes, 1024 * 1024),
+                           [&](const tbb::blocked_range<size_t>& r) {
+                              memcpy(out.data() + r.begin(), in + r.begin(),
+                                     r.size());
+                           });
+         // same source as before, the cache stays valid but can no longer
+         // be rebuilt from it
+         auto& header = *reinterpret_cast<ColumnHeader*>(out.header());
+         ifstream(path, ios::binary)
+             .read(reinterpret_cast<char*>(&header), sizeof(header));
+         header.flags |= ColumnHeader::deltaMerged;
+         header.count = rel.nrTuples;
+         header.checksum = checksum(out.data(), bytes);
+         if (rename(merged.c_str(), path.c_str()))
+            throw runtime_error("Could not replace " + path + ": " +
+                                strerror(errno));
+         // encodings of the old tuples are rebuilt by the next import
+         for (auto ext :
+              {".dict", ".codes", ".zone", ".packed", ".offsets", ".heap",
+               ".stats", ".narrow", ".index"})
+            unlink((path + ext).c_str());
+      }
+      cerr << "Merging " << rel.name << " time " << (gettime() - start)
+           << endl;
+   });
 }
 } // namespace runtime
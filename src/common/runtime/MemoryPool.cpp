@@ -73,6 +73,8 @@ GlobalPool* Allocator::setSource(GlobalPool* source) {
    auto previousSource = memorySource;
    memorySource = source;
    if (source) {
+      // the block size grew with the demand of the previous source
+      allocSize = initialAllocSize;
       start = (uint8_t*)memorySource->allocate(allocSize);
       free = allocSize;
    }
@@ -2,15 +2,6 @@
 
 using namespace std;
 
-inline bool fmemcmp(const char* __restrict__ left,
-                    const char* __restrict__ right, uint32_t size) {
-  for (uint32_t i = 0; i < size; ++i)
-    if (left[i] != right[i]) {
-      return false;
-    }
-  return true;
-}
-
 SmallStringView::SmallStringView(std::string_view& s) { assign(s); }
 
 SmallStringView::SmallStringView(const char* start, uint32_t end) {
@@ -23,20 +14,6 @@ SmallStringView::SmallStringView(const SmallStringView& o) {
 
 SmallStringView::SmallStringView() { raw.first = 0; }
 
-bool operator==(const SmallStringView& lhs, const SmallStringView& rhs) {
-  if (lhs.raw.first != rhs.raw.first) return false;
-  if (lhs.isInlined()) return lhs.raw.second == rhs.raw.second;
-  return fmemcmp(lhs.data(), rhs.data(), lhs.size());
-}
-
-bool operator==(const SmallStringView& lhs, const std::string_view& rhs) {
-  auto size = lhs.size();
-  if (size != rhs.size()) return false;
-  return fmemcmp(lhs.data(), rhs.data(), size);
-}
-
-bool SmallStringView::isInlined() const { return size() <= foldCapacity; }
-
 std::ostream& operator<<(std::ostream& os, const SmallStringView& str) {
   os.write(str.data(), str.size());
   return os;
@@ -58,21 +35,5 @@ void SmallStringView::assign(const char* start, uint32_t size) {
   }
 }
 
-void SmallStringView::assign(string& data) { assign(data.data(), data.size()); }
-
-void SmallStringView::assign(std::string_view& data) {
-  assign(data.data(), data.size());
-}
-
 void SmallStringView::clear() { raw.first = 0; }
 
-inline uint32_t SmallStringView::size() const { return inlined.size; }
-inline const char* SmallStringView::data() const {
-  if (isInlined())
-    return inlined.data;
-  else
-    return heap.data;
-}
-
-inline void SmallStringView::setSize(uint32_t s) { inlined.size = s; }
-inline void SmallStringView::setStrPtr(const char* str) { heap.data = str; }
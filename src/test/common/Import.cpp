@@ -0,0 +1,666 @@
+#include "common/runtime/Import.hpp"
+#include "common/runtime/Tokenizer.hpp"
+#include "common/runtime/Types.hpp"
+#include <algorithm>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace runtime;
+using namespace std;
+
+class Import : public ::testing::Test {
+ public:
+   static constexpr size_t nrOrders = 40000;
+   static constexpr size_t linesPerOrder = 4;
+   std::string dir;
+
+   void SetUp() override {
+      dir = "/tmp/import_test_" + to_string(getpid()) + "/";
+      ASSERT_EQ(system(("rm -rf " + dir + " && mkdir -p " + dir).c_str()), 0);
+      write("part", {"1|part one|Manufacturer#1|Brand#13|PROMO "
+                     "BURNISHED|7|JUMBO PKG|901.00|comment|"});
+      write("supplier",
+            {"1|Supplier#1|address|3|27-918-335-1736|5755.94|comment|"});
+      write("partsupp", {"1|1|3325|771.64|comment|"});
+      write("nation", {"0|ALGERIA|0|comment|", "1|ARGENTINA|1|comment|"});
+      write("region", {"0|AFRICA|comment|", "1|AMERICA|comment|"});
+      write("customer", {"1|Customer#1|address|15|25-989-741-2988|711.56|"
+                         "BUILDING|comment|",
+                         "2|Customer#2|address|13|23-768-687-3665|121.65|"
+                         "AUTOMOBILE|comment|"});
+      // enough lineitems to be split into several parse ranges
+      ofstream orders(dir + "orders.tbl"), lineitem(dir + "lineitem.tbl");
+      for (size_t o = 1; o <= nrOrders; o++) {
+         orders << o << "|" << (o % 2 + 1) << "|O|" << o << ".25|1996-01-02|"
+                << "5-LOW|Clerk#" << o << "|0|comment|\n";
+         for (size_t l = 1; l <= linesPerOrder; l++)
+            lineitem << o << "|1|1|" << l << "|" << l << ".00|" << o
+                     << ".50|0.04|0.02|N|O|1996-03-13|1996-02-12|1996-03-22|"
+                        "DELIVER IN PERSON|TRUCK|egular courts above the|\n";
+      }
+   }
+   void TearDown() override {
+      ASSERT_EQ(system(("rm -rf " + dir).c_str()), 0);
+   }
+   void write(std::string table, std::initializer_list<std::string> lines) {
+      ofstream out(dir + table + ".tbl");
+      for (auto& line : lines) out << line << "\n";
+   }
+   /// Sets the unused last header word of a cached column, it survives only
+   /// as long as the column is not rebuilt
+   void mark(std::string column, uint64_t marker) {
+      fstream file(dir + "cached/" + column,
+                   ios::in | ios::out | ios::binary);
+      file.seekp(56);
+      file.write(reinterpret_cast<char*>(&marker), sizeof(marker));
+   }
+   uint64_t marker(std::string column) {
+      ifstream file(dir + "cached/" + column, ios::binary);
+      uint64_t marker = 0;
+      file.seekg(56);
+      file.read(reinterpret_cast<char*>(&marker), sizeof(marker));
+      return marker;
+   }
+   void verify(Database& db) {
+      auto& li = db["lineitem"];
+      ASSERT_EQ(li.nrTuples, nrOrders * linesPerOrder);
+      auto l_orderkey = li["l_orderkey"].data<types::Integer>();
+      auto l_linenumber = li["l_linenumber"].data<types::Integer>();
+      auto l_extendedprice =
+          li["l_extendedprice"].data<types::Numeric<12, 2>>();
+      auto l_shipmode = li["l_shipmode"].data<types::Char<10>>();
+      auto l_shipdate = li["l_shipdate"].data<types::Date>();
+      auto truck = types::Char<10>::castString("TRUCK");
+      auto date = types::Date::castString("1996-03-13");
+      for (size_t i = 0; i < li.nrTuples; i++) {
+         int32_t order = i / linesPerOrder + 1;
+         ASSERT_EQ(l_orderkey[i].value, order);
+         ASSERT_EQ(size_t(l_linenumber[i].value), i % linesPerOrder + 1);
+         ASSERT_EQ(l_extendedprice[i].value, order * 100 + 50);
+         ASSERT_TRUE(l_shipmode[i] == truck);
+         ASSERT_TRUE(l_shipdate[i] == date);
+      }
+      auto& cu = db["customer"];
+      ASSERT_EQ(cu.nrTuples, size_t(2));
+      auto c_mktsegment = cu["c_mktsegment"].data<types::Char<10>>();
+      EXPECT_TRUE(c_mktsegment[0] == types::Char<10>::castString("BUILDING"));
+      EXPECT_EQ(db["orders"].nrTuples, nrOrders);
+      EXPECT_EQ(db["region"].nrTuples, size_t(2));
+   }
+};
+
+TEST_F(Import, parseAndReloadCache) {
+   {
+      Database db;
+      importTPCH(dir, db);
+      verify(db);
+   }
+   // second import maps the cached columns
+   Database db;
+   importTPCH(dir, db);
+   verify(db);
+}
+
+TEST_F(Import, loadReport) {
+   auto find = [](const std::vector<TableLoad>& report, std::string name) {
+      return *std::find_if(report.begin(), report.end(),
+                           [&](const TableLoad& l) { return l.name == name; });
+   };
+   std::vector<TableLoad> first, second;
+   {
+      Database db;
+      first = importTPCH(dir, db);
+   }
+   Database db;
+   second = importTPCH(dir, db);
+   verify(db);
+   // 8 tables and 4 indexes
+   ASSERT_EQ(first.size(), 12u);
+   ASSERT_EQ(second.size(), 12u);
+   struct stat sb;
+   ASSERT_EQ(stat((dir + "lineitem.tbl").c_str(), &sb), 0);
+   EXPECT_EQ(find(first, "lineitem").bytesParsed, size_t(sb.st_size));
+   for (auto& load : second) EXPECT_EQ(load.bytesParsed, 0u) << load.name;
+   // l_orderkey alone maps 4 bytes per tuple
+   EXPECT_GT(find(second, "lineitem").bytesMapped,
+             nrOrders * linesPerOrder * 4);
+   EXPECT_EQ(find(second, "ord_li").bytesMapped, 0u);
+   EXPECT_EQ(db.getindex("ord_li").size(), nrOrders);
+   EXPECT_EQ(db.getKeyIndex("orders_key").size(), nrOrders + 1);
+}
+
+TEST_F(Import, rebuildOutdatedColumns) {
+   { Database db; importTPCH(dir, db); }
+   mark("lineitem_l_orderkey", 42);
+   mark("lineitem_l_shipmode", 42);
+   // corrupt a single column
+   { ofstream(dir + "cached/lineitem_l_shipdate") << "garbage"; }
+   {
+      Database db;
+      importTPCH(dir, db);
+      verify(db);
+   }
+   EXPECT_EQ(marker("lineitem_l_orderkey"), uint64_t(42));
+   EXPECT_EQ(marker("lineitem_l_shipmode"), uint64_t(42));
+
+   // a modified .tbl file invalidates all its columns
+   struct timespec times[2] = {{0, UTIME_OMIT}, {1000000000, 0}};
+   ASSERT_EQ(utimensat(AT_FDCWD, (dir + "lineitem.tbl").c_str(), times, 0), 0);
+   Database db;
+   importTPCH(dir, db);
+   verify(db);
+   EXPECT_EQ(marker("lineitem_l_orderkey"), uint64_t(0));
+   EXPECT_EQ(marker("lineitem_l_shipmode"), uint64_t(0));
+}
+
+TEST_F(Import, verifyChecksum) {
+   { Database db; importTPCH(dir, db); }
+   {
+      // flip a value behind the header
+      fstream file(dir + "cached/lineitem_l_orderkey",
+                   ios::in | ios::out | ios::binary);
+      file.seekp(64);
+      file.put(char(0xff));
+   }
+   setenv("verifyCache", "1", 1);
+   Database db;
+   importTPCH(dir, db);
+   unsetenv("verifyCache");
+   verify(db);
+}
+
+TEST_F(Import, dictionaries) {
+   {
+      // dictionary encoding is optional
+      Database db;
+      importTPCH(dir, db);
+      EXPECT_FALSE(db["lineitem"]["l_shipmode"].dictionary);
+   }
+   setenv("dictionaries", "1", 1);
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached dictionaries
+      Database db;
+      importTPCH(dir, db);
+      auto& l_shipmode = db["lineitem"]["l_shipmode"];
+      ASSERT_TRUE(l_shipmode.dictionary);
+      auto& shipmodes = *l_shipmode.dictionary;
+      ASSERT_EQ(shipmodes.codeSize, sizeof(int8_t));
+      ASSERT_EQ(shipmodes.values<types::Char<10>>().size(), size_t(1));
+      auto truck = types::Char<10>::castString("TRUCK");
+      EXPECT_EQ(shipmodes.code(truck), 0);
+      auto codes = shipmodes.codes<int8_t>();
+      for (size_t i = 0; i < nrOrders * linesPerOrder; i++)
+         ASSERT_EQ(codes[i], 0);
+
+      // codes follow the order of the values
+      auto& c_mktsegment = db["customer"]["c_mktsegment"];
+      ASSERT_TRUE(c_mktsegment.dictionary);
+      auto& segments = *c_mktsegment.dictionary;
+      auto building = types::Char<10>::castString("BUILDING");
+      EXPECT_EQ(segments.code(types::Char<10>::castString("AUTOMOBILE")), 0);
+      EXPECT_EQ(segments.code(building), 1);
+      EXPECT_EQ(segments.code(types::Char<10>::castString("MACHINERY")), -1);
+      EXPECT_EQ(segments.lowerBound(types::Char<10>::castString("B")), 1);
+      EXPECT_EQ(segments.codes<int8_t>()[0], 1);
+      EXPECT_EQ(segments.codes<int8_t>()[1], 0);
+
+      // too many distinct values
+      EXPECT_FALSE(db["orders"]["o_clerk"].dictionary);
+      EXPECT_FALSE(db["lineitem"]["l_comment"].dictionary);
+   }
+   unsetenv("dictionaries");
+}
+
+TEST_F(Import, zoneMaps) {
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached zone maps
+      Database db;
+      importTPCH(dir, db);
+      auto& li = db["lineitem"];
+      auto& l_orderkey = li["l_orderkey"];
+      ASSERT_TRUE(l_orderkey.zoneMap);
+      auto blockSize = ZoneMap::blockSize;
+      auto nrBlocks = (li.nrTuples + blockSize - 1) / blockSize;
+      ASSERT_EQ(l_orderkey.zoneMap->nrBlocks(), nrBlocks);
+      auto bounds = l_orderkey.zoneMap->bounds<types::Integer>();
+      for (size_t b = 0; b < nrBlocks; b++) {
+         auto last = min(li.nrTuples, (b + 1) * blockSize) - 1;
+         ASSERT_EQ(size_t(bounds[b].first.value), b * blockSize / 4 + 1);
+         ASSERT_EQ(size_t(bounds[b].second.value), last / 4 + 1);
+      }
+      EXPECT_TRUE(li["l_shipdate"].zoneMap);
+      EXPECT_TRUE(li["l_extendedprice"].zoneMap);
+      EXPECT_FALSE(li["l_shipmode"].zoneMap);
+
+      BlockFilter blocks(li);
+      blocks.restrict(l_orderkey, types::Integer(1), types::Integer(100))
+          .restrict(li["l_shipdate"], types::Date::castString("1996-01-01"),
+                    types::Date::castString("1996-12-31"));
+      EXPECT_EQ(blocks.skipped(), nrBlocks - 1);
+      EXPECT_TRUE(blocks.candidate(0));
+      EXPECT_TRUE(blocks.mayMatch(0, 10));
+      EXPECT_FALSE(blocks.mayMatch(blockSize, li.nrTuples));
+   }
+}
+
+TEST_F(Import, packColumns) {
+   setenv("packColumns", "1", 1);
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached encodings
+      Database db;
+      importTPCH(dir, db);
+      auto& li = db["lineitem"];
+      auto& l_orderkey = li["l_orderkey"];
+      ASSERT_TRUE(l_orderkey.packed);
+      EXPECT_EQ(l_orderkey.packed->base(), 1);
+      EXPECT_EQ(l_orderkey.packed->bits(), 16u);
+      EXPECT_LT(l_orderkey.packed->memory(), li.nrTuples * sizeof(int32_t));
+      vector<int32_t> values(li.nrTuples);
+      l_orderkey.packed->unpack(0, li.nrTuples, values.data());
+      auto l_orderkey_col = l_orderkey.data<types::Integer>();
+      for (size_t i = 0; i < li.nrTuples; i++)
+         ASSERT_EQ(values[i], l_orderkey_col[i].value);
+
+      // constant dates need a single bit
+      auto& l_shipdate = li["l_shipdate"];
+      ASSERT_TRUE(l_shipdate.packed);
+      EXPECT_EQ(l_shipdate.packed->bits(), 1u);
+      int32_t date;
+      l_shipdate.packed->unpack(li.nrTuples - 1, 1, &date);
+      EXPECT_EQ(date, types::Date::castString("1996-03-13").value);
+      EXPECT_FALSE(li["l_extendedprice"].packed);
+   }
+   unsetenv("packColumns");
+}
+
+TEST_F(Import, stringHeap) {
+   setenv("stringHeap", "1", 1);
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached heaps
+      Database db;
+      importTPCH(dir, db);
+      auto& li = db["lineitem"];
+      auto& l_comment = li["l_comment"];
+      ASSERT_TRUE(l_comment.strings);
+      auto& strings = *l_comment.strings;
+      auto values = l_comment.data<types::Varchar<44>>();
+      for (size_t i = 0; i < li.nrTuples; i++) {
+         ASSERT_EQ(strings.size(i), values[i].length());
+         ASSERT_EQ(
+             memcmp(strings.data(i), values[i].begin(), values[i].length()),
+             0);
+      }
+      EXPECT_FALSE(strings.view(0).isInlined());
+      EXPECT_TRUE(strings.view(0).startsWith("egular", 6));
+      EXPECT_LT(l_comment.strings->heap_.size(),
+                li.nrTuples * sizeof(types::Varchar<44>));
+      auto& p_name = db["part"]["p_name"];
+      ASSERT_TRUE(p_name.strings);
+      EXPECT_TRUE(p_name.strings->view(0).isInlined());
+      EXPECT_TRUE(p_name.strings->view(0) == string_view("part one"));
+      EXPECT_FALSE(li["l_shipmode"].strings);
+   }
+   unsetenv("stringHeap");
+}
+
+TEST_F(Import, keyIndexes) {
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached indexes
+      Database db;
+      importTPCH(dir, db);
+      auto& ord = db["orders"];
+      auto& orders_key = db.getKeyIndex("orders_key");
+      EXPECT_EQ(orders_key.rowIdSize, sizeof(uint32_t));
+      auto o_orderkey = ord["o_orderkey"].data<types::Integer>();
+      ASSERT_EQ(orders_key.size(), nrOrders + 1);
+      for (size_t i = 0; i < ord.nrTuples; i++)
+         ASSERT_EQ(orders_key[o_orderkey[i].value], i);
+      auto& customer_key = db.getKeyIndex("customer_key");
+      ASSERT_EQ(customer_key.size(), 3u);
+      EXPECT_EQ(customer_key[1], 0u);
+      EXPECT_EQ(customer_key[2], 1u);
+   }
+   EXPECT_EQ(access((dir + "cached/orders_o_orderkey.index").c_str(), F_OK),
+             0);
+}
+
+TEST_F(Import, numaPlacement) {
+   std::vector<types::Integer> reference;
+   {
+      Database db;
+      importTPCH(dir, db);
+      EXPECT_TRUE(db["lineitem"].nodeBounds.empty());
+      auto l_orderkey = db["lineitem"]["l_orderkey"].data<types::Integer>();
+      reference.assign(l_orderkey, l_orderkey + db["lineitem"].nrTuples);
+   }
+   setenv("numaPlacement", "1", 1);
+   Database db;
+   importTPCH(dir, db);
+   unsetenv("numaPlacement");
+   auto& li = db["lineitem"];
+   ASSERT_FALSE(li.nodeBounds.empty());
+   EXPECT_EQ(li.nodeBounds.front(), 0u);
+   EXPECT_EQ(li.nodeBounds.back(), li.nrTuples);
+   auto l_orderkey = li["l_orderkey"].data<types::Integer>();
+   for (size_t i = 0; i < li.nrTuples; i++)
+      ASSERT_EQ(l_orderkey[i], reference[i]);
+   EXPECT_EQ(db["orders"].nodeBounds.back(), nrOrders);
+}
+
+TEST_F(Import, hugePages) {
+   const uintptr_t hugePage = 2 * 1024 * 1024;
+   auto onHugePages = [&](Database& db, string table, string column) {
+      auto& data = db[table][column].data_;
+      // huge pages start at huge page boundaries
+      return data.onHugePages() &&
+             reinterpret_cast<uintptr_t>(data.data()) % hugePage == 0;
+   };
+   setenv("hugePages", "orders.o_orderkey,customer", 1);
+   {
+      Database db;
+      importTPCH(dir, db);
+      verify(db);
+      EXPECT_TRUE(onHugePages(db, "orders", "o_orderkey"));
+      EXPECT_TRUE(onHugePages(db, "customer", "c_custkey"));
+      EXPECT_TRUE(onHugePages(db, "customer", "c_name"));
+      EXPECT_FALSE(onHugePages(db, "orders", "o_custkey"));
+      EXPECT_FALSE(onHugePages(db, "lineitem", "l_orderkey"));
+   }
+   // together with the placement on NUMA nodes
+   setenv("numaPlacement", "1", 1);
+   Database db;
+   importTPCH(dir, db);
+   unsetenv("numaPlacement");
+   unsetenv("hugePages");
+   verify(db);
+   EXPECT_TRUE(onHugePages(db, "orders", "o_orderkey"));
+   EXPECT_FALSE(onHugePages(db, "orders", "o_custkey"));
+}
+
+TEST_F(Import, warmUp) {
+   Database db;
+   importTPCH(dir, db);
+   auto& l_orderkey = db["lineitem"]["l_orderkey"];
+   auto begin = reinterpret_cast<uintptr_t>(l_orderkey.data());
+   auto page = size_t(sysconf(_SC_PAGESIZE));
+   auto first = begin - begin % page;
+   auto length = begin + db["lineitem"].nrTuples * sizeof(types::Integer) -
+                 first;
+   for (auto mode : {Database::WarmUpMode::Off, Database::WarmUpMode::Advise,
+                     Database::WarmUpMode::Populate}) {
+      db.warmUpMode = mode;
+      db.warmUp("lineitem", {"l_orderkey", "l_shipdate"});
+   }
+   std::vector<unsigned char> resident((length + page - 1) / page);
+   ASSERT_EQ(mincore(reinterpret_cast<void*>(first), length, resident.data()),
+             0);
+   for (auto r : resident) ASSERT_TRUE(r & 1);
+   EXPECT_EQ(l_orderkey.data<types::Integer>()[0], types::Integer(1));
+   EXPECT_THROW(db.warmUp("lineitem", {"l_unknown"}), std::range_error);
+}
+
+TEST_F(Import, sortKeys) {
+   setenv("sortKeys", "lineitem.l_quantity,orders.o_custkey", 1);
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the sorted columns
+      Database db;
+      importTPCH(dir, db);
+      if (run == 0) mark("lineitem_by_l_quantity_l_orderkey", 42);
+      auto& li = db["lineitem"];
+      EXPECT_EQ(li.sortKey, "l_quantity");
+      auto l_orderkey = li["l_orderkey"].data<types::Integer>();
+      auto l_linenumber = li["l_linenumber"].data<types::Integer>();
+      auto l_extendedprice =
+          li["l_extendedprice"].data<types::Numeric<12, 2>>();
+      for (size_t i = 0; i < li.nrTuples; i++) {
+         ASSERT_EQ(size_t(l_linenumber[i].value), i / nrOrders + 1);
+         ASSERT_EQ(size_t(l_orderkey[i].value), i % nrOrders + 1);
+         ASSERT_EQ(l_extendedprice[i].value, l_orderkey[i].value * 100 + 50);
+      }
+      auto rows = li.sortedRange("l_quantity",
+                                 types::Numeric<12, 2>::castString("2.00"),
+                                 types::Numeric<12, 2>::castString("3.00"));
+      EXPECT_EQ(rows.first, nrOrders);
+      EXPECT_EQ(rows.second, 3 * nrOrders);
+      auto all = li.sortedRange("l_orderkey", types::Integer(1),
+                                types::Integer(2));
+      EXPECT_EQ(all.second - all.first, li.nrTuples);
+
+      // the key index follows the sorted orders
+      auto& ord = db["orders"];
+      auto o_custkey = ord["o_custkey"].data<types::Integer>();
+      auto o_orderkey = ord["o_orderkey"].data<types::Integer>();
+      EXPECT_EQ(o_custkey[0].value, 1);
+      EXPECT_EQ(o_custkey[ord.nrTuples - 1].value, 2);
+      auto& orders_key = db.getKeyIndex("orders_key");
+      for (size_t i = 0; i < ord.nrTuples; i++)
+         ASSERT_EQ(orders_key[o_orderkey[i].value], i);
+   }
+   EXPECT_EQ(marker("lineitem_by_l_quantity_l_orderkey"), 42u);
+   unsetenv("sortKeys");
+   // without sort keys the .tbl order is back
+   Database db;
+   importTPCH(dir, db);
+   EXPECT_TRUE(db["lineitem"].sortKey.empty());
+   verify(db);
+   EXPECT_EQ(db.getKeyIndex("orders_key")[1], 0u);
+}
+
+TEST_F(Import, appendAndMerge) {
+   setenv("dictionaries", "1", 1);
+   {
+      Database db;
+      importTPCH(dir, db);
+      auto& nation = db["nation"];
+      ASSERT_TRUE(nation["n_name"].dictionary);
+      auto before = nation["n_nationkey"].data<types::Integer>();
+      // more tuples than fit behind the last page of the mapping
+      const size_t n = 5000;
+      std::vector<types::Integer> keys, regions;
+      std::vector<types::Char<25>> names;
+      std::vector<types::Varchar<152>> comments;
+      for (size_t i = 0; i < n; i++) {
+         keys.push_back(types::Integer(i + 2));
+         regions.push_back(types::Integer(i % 2));
+         names.push_back(types::Char<25>::castString("NATION"));
+         comments.push_back(types::Varchar<152>::castString("appended", 8));
+      }
+      EXPECT_THROW(db.append("nation", {{"n_nationkey", keys.data()}}, n),
+                   std::runtime_error);
+      db.append("nation",
+                {{"n_nationkey", keys.data()},
+                 {"n_name", names.data()},
+                 {"n_regionkey", regions.data()},
+                 {"n_comment", comments.data()}},
+                n);
+      ASSERT_EQ(nation.nrTuples, n + 2);
+      EXPECT_FALSE(nation["n_name"].dictionary);
+      auto n_nationkey = nation["n_nationkey"].data<types::Integer>();
+      EXPECT_NE(n_nationkey, before);
+      for (size_t i = 0; i < nation.nrTuples; i++)
+         ASSERT_EQ(size_t(n_nationkey[i].value), i);
+      EXPECT_TRUE(nation["n_name"].data<types::Char<25>>()[1] ==
+                  types::Char<25>::castString("ARGENTINA"));
+      EXPECT_TRUE(nation["n_name"].data<types::Char<25>>()[2] ==
+                  types::Char<25>::castString("NATION"));
+      mergeDelta(nation).get();
+   }
+   // the next import maps the merged columns
+   Database db;
+   importTPCH(dir, db);
+   auto& nation = db["nation"];
+   ASSERT_EQ(nation.nrTuples, 5002u);
+   auto n_regionkey = nation["n_regionkey"].data<types::Integer>();
+   EXPECT_EQ(n_regionkey[1].value, 1);
+   EXPECT_EQ(n_regionkey[5001].value, 1);
+   EXPECT_EQ(nation["n_comment"].data<types::Varchar<152>>()[5001].length(),
+             8u);
+   ASSERT_TRUE(nation["n_name"].dictionary);
+   EXPECT_EQ(nation["n_name"].dictionary->code(
+                 types::Char<25>::castString("NATION")),
+             2);
+
+   // rebuilding from the .tbl file would lose the merged tuples
+   unlink((dir + "cached/nation_n_comment").c_str());
+   Database outdated;
+   EXPECT_THROW(importTPCH(dir, outdated), std::runtime_error);
+   unsetenv("dictionaries");
+}
+
+TEST_F(Import, appendToIndexedAndPlaced) {
+   setenv("numaPlacement", "1", 1);
+   setenv("hugePages", "orders.o_orderkey", 1);
+   Database db;
+   importTPCH(dir, db);
+   unsetenv("numaPlacement");
+   unsetenv("hugePages");
+   auto& ord = db["orders"];
+   // copies of the first order, with keys behind a gap
+   const size_t n = 100000;
+   std::unordered_map<std::string, std::vector<uint8_t>> columns;
+   std::unordered_map<std::string, const void*> values;
+   for (auto& attr : ord.attributes) {
+      auto size = attr.second.type->rt_size();
+      auto first = reinterpret_cast<uint8_t*>(attr.second.data());
+      auto& column = columns[attr.first];
+      for (size_t i = 0; i < n; i++)
+         column.insert(column.end(), first, first + size);
+      values[attr.first] = column.data();
+   }
+   auto keys = reinterpret_cast<types::Integer*>(columns["o_orderkey"].data());
+   for (size_t i = 0; i < n; i++) keys[i] = types::Integer(nrOrders + 10 + i);
+   db.append("orders", values, n);
+   ASSERT_EQ(ord.nrTuples, nrOrders + n);
+
+   // the key index covers the appended tuples
+   auto& orders_key = db.getKeyIndex("orders_key");
+   ASSERT_EQ(orders_key.size(), nrOrders + 10 + n);
+   auto o_orderkey = ord["o_orderkey"].data<types::Integer>();
+   for (size_t i = 0; i < ord.nrTuples; i++)
+      ASSERT_EQ(orders_key[o_orderkey[i].value], i);
+   // and the grown columns are placed like the imported ones
+   EXPECT_EQ(ord.nodeBounds.front(), 0u);
+   EXPECT_EQ(ord.nodeBounds.back(), ord.nrTuples);
+   EXPECT_TRUE(ord["o_orderkey"].data_.onHugePages());
+   EXPECT_FALSE(ord["o_custkey"].data_.onHugePages());
+   EXPECT_EQ(ord["o_custkey"].data<types::Integer>()[nrOrders + n - 1].value,
+             ord["o_custkey"].data<types::Integer>()[0].value);
+}
+
+TEST_F(Import, statistics) {
+   {
+      // by default only for the attributes the queries estimate from
+      Database db;
+      importTPCH(dir, db);
+      EXPECT_TRUE(db["lineitem"]["l_orderkey"].statistics);
+      EXPECT_FALSE(db["lineitem"]["l_linenumber"].statistics);
+      EXPECT_FALSE(db["region"]["r_regionkey"].statistics);
+   }
+   setenv("statistics", "lineitem,region", 1);
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached statistics
+      Database db;
+      importTPCH(dir, db);
+      auto& li = db["lineitem"];
+      auto& stats = li["l_orderkey"].statistics;
+      ASSERT_TRUE(stats);
+      EXPECT_EQ(stats->count(), li.nrTuples);
+      EXPECT_EQ(stats->min(), 1);
+      EXPECT_EQ(stats->max(), int64_t(nrOrders));
+      EXPECT_NEAR(double(li.distinct("l_orderkey")), nrOrders, nrOrders * 0.05);
+      EXPECT_EQ(li.distinct("l_linenumber"), linesPerOrder);
+      EXPECT_EQ(li.distinct("l_shipmode"), 1u);
+      EXPECT_EQ(li.distinct("l_comment"), 1u);
+      // equi-depth buckets of 2500 values
+      for (size_t b = 0; b < ColumnStatistics::histogramBuckets; b++)
+         EXPECT_NEAR(double(stats->buckets()[b]),
+                     (b + 1) * nrOrders / ColumnStatistics::histogramBuckets,
+                     nrOrders * 0.01);
+      auto lines = li.estimate("l_orderkey", types::Integer(1),
+                               types::Integer(nrOrders / 4));
+      EXPECT_NEAR(double(lines), li.nrTuples / 4, li.nrTuples * 0.02);
+      EXPECT_EQ(li.estimate("l_orderkey", types::Integer(nrOrders + 1),
+                            types::Integer(2 * nrOrders)),
+                0u);
+   }
+   Database db;
+   importTPCH(dir, db);
+   auto& region = db["region"];
+   ASSERT_TRUE(region["r_regionkey"].statistics);
+   auto key = types::Integer(2);
+   auto name = types::Char<25>::castString("ASIA");
+   auto comment = types::Varchar<152>::castString("appended", 8);
+   db.append("region",
+             {{"r_regionkey", &key}, {"r_name", &name}, {"r_comment", &comment}},
+             1);
+   // appended tuples are not covered by the statistics
+   EXPECT_FALSE(region["r_regionkey"].statistics);
+   EXPECT_EQ(region.distinct("r_regionkey"), 3u);
+   unsetenv("statistics");
+}
+
+TEST_F(Import, narrowColumns) {
+   setenv("narrowColumns", "1", 1);
+   for (size_t run = 0; run < 2; run++) {
+      // the second run maps the cached narrow columns
+      Database db;
+      importTPCH(dir, db);
+      auto& li = db["lineitem"];
+      // small values keep their representation
+      auto& l_linenumber = li["l_linenumber"];
+      ASSERT_TRUE(l_linenumber.narrow);
+      EXPECT_EQ(l_linenumber.narrow->width(), 1u);
+      EXPECT_EQ(l_linenumber.narrow->base(), 0);
+      auto l_quantity = li["l_quantity"].narrow.get();
+      ASSERT_TRUE(l_quantity);
+      EXPECT_EQ(l_quantity->width(), 2u);
+      EXPECT_EQ(l_quantity->values<int16_t>()[li.nrTuples - 1], 400);
+      // values beyond the range of int16_t are shifted by the base
+      auto& l_orderkey = li["l_orderkey"];
+      ASSERT_TRUE(l_orderkey.narrow);
+      EXPECT_EQ(l_orderkey.narrow->width(), 2u);
+      EXPECT_LT(l_orderkey.narrow->memory(), li.nrTuples * sizeof(int32_t));
+      auto values = l_orderkey.narrow->values<int16_t>();
+      auto l_orderkey_col = l_orderkey.data<types::Integer>();
+      for (size_t i = 0; i < li.nrTuples; i++)
+         ASSERT_EQ(values[i] + l_orderkey.narrow->base(),
+                   l_orderkey_col[i].value);
+      EXPECT_EQ(li["l_extendedprice"].narrow->width(), 4u);
+      EXPECT_EQ(li["l_shipdate"].narrow->width(), 1u);
+      EXPECT_FALSE(li["l_shipmode"].narrow);
+      // constants outside of the value range saturate
+      auto& narrow = *l_orderkey.narrow;
+      EXPECT_EQ(narrow.narrow<int16_t>(types::Integer(1)), -32767);
+      EXPECT_EQ(narrow.narrow<int16_t>(types::Integer(-5)), -32768);
+      EXPECT_EQ(narrow.narrow<int16_t>(types::Integer(100000)), 32767);
+   }
+   unsetenv("narrowColumns");
+}
+
+TEST(Tokenizer, findDelimiters) {
+   mt19937 gen(1337);
+   uniform_int_distribution<int> dist(0, 9);
+   string input;
+   for (size_t i = 0; i < 1000; i++) {
+      auto c = dist(gen);
+      input += c == 0 ? '|' : c == 1 ? '\n' : char('a' + c);
+   }
+   // all lengths to cover the scalar tail after the 64 byte blocks
+   vector<uint32_t> delimiters(input.size());
+   for (size_t size = 0; size < 200; size++) {
+      auto n = findDelimiters(input.data(), input.data() + size,
+                              delimiters.data());
+      size_t expected = 0;
+      for (size_t i = 0; i < size; i++)
+         if (input[i] == '|' || input[i] == '\n') {
+            ASSERT_LT(expected, n);
+            ASSERT_EQ(delimiters[expected++], i);
+         }
+      ASSERT_EQ(n, expected);
+   }
+}
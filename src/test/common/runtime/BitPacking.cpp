@@ -0,0 +1,50 @@
+#include "common/runtime/BitPacking.hpp"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace runtime;
+
+TEST(BitPacking, bitsFor) {
+   EXPECT_EQ(bitsFor(0), 1u);
+   EXPECT_EQ(bitsFor(1), 1u);
+   EXPECT_EQ(bitsFor(2), 2u);
+   EXPECT_EQ(bitsFor(255), 8u);
+   EXPECT_EQ(bitsFor(256), 9u);
+   EXPECT_EQ(bitsFor(std::numeric_limits<uint32_t>::max()), 32u);
+}
+
+TEST(BitPacking, packAndUnpack) {
+   std::mt19937 gen(1337);
+   const size_t n = 1000;
+   for (unsigned bits = 1; bits <= 32; bits++) {
+      // stay within the range of int32_t
+      int32_t base = bits < 32 ? -1000 : std::numeric_limits<int32_t>::min();
+      // values using all bits
+      uint64_t range = (uint64_t(1) << bits) - 1;
+      std::uniform_int_distribution<uint64_t> dist(0, range);
+      std::vector<int32_t> values(n);
+      for (auto& v : values) v = int32_t(int64_t(base) + dist(gen));
+      values[0] = base;
+      values[1] = int32_t(int64_t(base) + range);
+      ASSERT_EQ(bitsFor(range), bits);
+
+      std::vector<uint8_t> packed(packedSize(n, bits));
+      for (size_t c = 0; c * packChunkSize < n; c++)
+         packChunk(values.data() + c * packChunkSize,
+                   std::min(packChunkSize, n - c * packChunkSize), base, bits,
+                   packed.data() + c * bits * 8);
+      // unaligned ranges of all lengths around the vectorized steps
+      std::vector<int32_t> out(n);
+      for (size_t begin : {0, 1, 3, 63, 64, 65, 500})
+         for (size_t length : {0, 1, 3, 4, 5, 17, 64, 200}) {
+            auto count = std::min(length, n - begin);
+            unpack(packed.data(), begin, count, bits, base, out.data());
+            for (size_t i = 0; i < count; i++)
+               ASSERT_EQ(out[i], values[begin + i])
+                   << "bits " << bits << " value " << begin + i;
+         }
+   }
+}
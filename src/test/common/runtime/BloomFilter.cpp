@@ -0,0 +1,33 @@
+#include "common/runtime/BloomFilter.hpp"
+#include "common/runtime/HyperLogLog.hpp"
+#include <gtest/gtest.h>
+
+using namespace runtime;
+
+TEST(BloomFilter, noFalseNegatives) {
+   const uint64_t n = 100000;
+   BloomFilter filter;
+   EXPECT_FALSE(filter.active());
+   EXPECT_TRUE(filter.contains(HyperLogLog::hash(1)));
+   filter.setSize(n);
+   ASSERT_TRUE(filter.active());
+   for (uint64_t i = 0; i < n; i++) filter.insert(HyperLogLog::hash(i));
+   for (uint64_t i = 0; i < n; i++)
+      ASSERT_TRUE(filter.contains(HyperLogLog::hash(i))) << i;
+   // hashes which were not inserted pass rarely
+   size_t falsePositives = 0;
+   for (uint64_t i = n; i < 11 * n; i++)
+      falsePositives += filter.contains(HyperLogLog::hash(i));
+   EXPECT_LT(falsePositives, 10 * n * 0.03);
+}
+
+TEST(BloomFilter, singleBlock) {
+   BloomFilter filter;
+   filter.setSize(1);
+   filter.insert(HyperLogLog::hash(7));
+   EXPECT_TRUE(filter.contains(HyperLogLog::hash(7)));
+   size_t falsePositives = 0;
+   for (uint64_t i = 100; i < 1100; i++)
+      falsePositives += filter.contains(HyperLogLog::hash(i));
+   EXPECT_LT(falsePositives, 10u);
+}
@@ -0,0 +1,27 @@
+#include "common/runtime/HyperLogLog.hpp"
+#include <gtest/gtest.h>
+
+using namespace runtime;
+
+TEST(HyperLogLog, estimate) {
+   for (uint64_t n : {uint64_t(0), uint64_t(10), uint64_t(1000),
+                      uint64_t(100000), uint64_t(1000000)}) {
+      HyperLogLog sketch;
+      // every value twice
+      for (uint64_t i = 0; i < 2 * n; i++)
+         sketch.add(HyperLogLog::hash(i % n));
+      EXPECT_NEAR(double(sketch.estimate()), n, n * 0.05 + 1) << n;
+   }
+}
+
+TEST(HyperLogLog, merge) {
+   HyperLogLog a, b, both;
+   for (uint64_t i = 0; i < 200000; i++) {
+      auto h = HyperLogLog::hash(i);
+      (i % 3 ? a : b).add(h);
+      both.add(h);
+   }
+   a.merge(b);
+   EXPECT_EQ(a.estimate(), both.estimate());
+   EXPECT_NEAR(double(a.estimate()), 200000, 10000);
+}
@@ -0,0 +1,62 @@
+#include "common/runtime/Numa.hpp"
+#include <atomic>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+using namespace runtime;
+
+TEST(Numa, partitionBounds) {
+   for (size_t n : {size_t(0), size_t(1000), size_t(10000000)}) {
+      auto bounds = numa::partitionBounds(n);
+      ASSERT_EQ(bounds.size(), numa::nodes() + 1);
+      EXPECT_EQ(bounds.front(), 0u);
+      EXPECT_EQ(bounds.back(), n);
+      for (size_t i = 0; i + 1 < bounds.size(); i++) {
+         EXPECT_LE(bounds[i], bounds[i + 1]);
+         if (bounds[i] < n) {
+            EXPECT_EQ(bounds[i] % numa::partitionAlignment, 0u);
+         }
+      }
+   }
+   EXPECT_LT(numa::currentNode(), numa::nodes());
+}
+
+TEST(Numa, localMorselsFirst) {
+   NodeMorsels morsels;
+   std::vector<size_t> bounds = {0, 100, 250};
+   size_t begin, end;
+   // node 1 starts with its own partition
+   ASSERT_TRUE(morsels.next(bounds, 1, 60, begin, end));
+   EXPECT_EQ(begin, 100u);
+   EXPECT_EQ(end, 160u);
+   ASSERT_TRUE(morsels.next(bounds, 1, 60, begin, end));
+   EXPECT_EQ(begin, 160u);
+   ASSERT_TRUE(morsels.next(bounds, 1, 60, begin, end));
+   EXPECT_EQ(begin, 220u);
+   EXPECT_EQ(end, 250u);
+   // and steals from node 0 afterwards
+   ASSERT_TRUE(morsels.next(bounds, 1, 60, begin, end));
+   EXPECT_EQ(begin, 0u);
+   EXPECT_EQ(end, 60u);
+   ASSERT_TRUE(morsels.next(bounds, 0, 60, begin, end));
+   EXPECT_EQ(begin, 60u);
+   EXPECT_EQ(end, 100u);
+   EXPECT_FALSE(morsels.next(bounds, 0, 60, begin, end));
+   EXPECT_FALSE(morsels.next(bounds, 1, 60, begin, end));
+}
+
+TEST(Numa, everyMorselOnce) {
+   NodeMorsels morsels;
+   std::vector<size_t> bounds = {0, 70000, 70000, 200000};
+   std::vector<std::atomic<uint8_t>> seen(bounds.back());
+   std::vector<std::thread> threads;
+   for (unsigned t = 0; t < 8; t++)
+      threads.emplace_back([&, t]() {
+         size_t begin, end;
+         while (morsels.next(bounds, t % 3, 1000, begin, end))
+            for (auto i = begin; i < end; i++) seen[i]++;
+      });
+   for (auto& t : threads) t.join();
+   for (auto& s : seen) ASSERT_EQ(s.load(), 1);
+}
@@ -0,0 +1,40 @@
+#include "common/runtime/String.hpp"
+#include <gtest/gtest.h>
+#include <string>
+
+TEST(SmallStringView, inlinedAndHeap) {
+   std::string shortString = "green";
+   std::string longString = "forest green almond";
+   SmallStringView s(shortString.data(), shortString.size());
+   SmallStringView l(longString.data(), longString.size());
+   EXPECT_TRUE(s.isInlined());
+   EXPECT_FALSE(l.isInlined());
+   EXPECT_EQ(s.size(), shortString.size());
+   EXPECT_EQ(l.data(), longString.data());
+   std::string_view view(longString);
+   EXPECT_TRUE(l == view);
+   std::string copy = longString;
+   EXPECT_TRUE(l == SmallStringView(copy.data(), copy.size()));
+   copy.back() = 'x';
+   EXPECT_FALSE(l == SmallStringView(copy.data(), copy.size()));
+}
+
+TEST(SmallStringView, startsWith) {
+   std::string longString = "forest green almond";
+   SmallStringView l(longString.data(), longString.size());
+   EXPECT_TRUE(l.startsWith("fore", 4));
+   EXPECT_TRUE(l.startsWith("forest g", 8));
+   EXPECT_FALSE(l.startsWith("fora", 4));
+   EXPECT_FALSE(l.startsWith("forest x", 8));
+   // prefixes up to 4 bytes never read the heap
+   longString[5] = 'x';
+   EXPECT_TRUE(l.startsWith("for", 3));
+   EXPECT_FALSE(l.startsWith("forest", 6));
+
+   std::string shortString = "green";
+   SmallStringView s(shortString.data(), shortString.size());
+   EXPECT_TRUE(s.startsWith("gree", 4));
+   EXPECT_TRUE(s.startsWith("green", 5));
+   EXPECT_FALSE(s.startsWith("greens", 6));
+   EXPECT_TRUE(s.startsWith("", 0));
+}
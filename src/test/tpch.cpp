@@ -226,6 +226,20 @@ TEST(TPCH, q6) {
       ASSERT_EQ(size_t(1), revenue.size());
       ASSERT_EQ(revenue[0], expected);
    }
+
+   {
+      // compare l_quantity and l_discount in their narrow representation
+      setenv("narrowColumns", "1", 1);
+      Database narrow;
+      importTPCH(std::string(DATADIR) + "/tpch/sf1/", narrow);
+      unsetenv("narrowColumns");
+      ASSERT_TRUE(narrow["lineitem"]["l_quantity"].narrow);
+      auto result = q6_vectorwise(narrow, threads, vectorSize);
+      EXPECT_EQ(result.nrTuples, size_t(1));
+      auto& revenue = result["revenue"].typedAccess<types::Numeric<12, 4>>();
+      ASSERT_EQ(size_t(1), revenue.size());
+      ASSERT_EQ(revenue[0], expected);
+   }
 }
 
 
@@ -1,6 +1,7 @@
 #include "../TPCH.hpp"
 #include "benchmarks/tpch/Queries.hpp"
 #include "common/runtime/Concurrency.hpp"
+#include "common/runtime/Cpu.hpp"
 #include "common/runtime/Import.hpp"
 #include "common/runtime/MemoryPool.hpp"
 #include "common/runtime/Types.hpp"
@@ -9,6 +10,7 @@
 #include "vectorwise/QueryBuilder.hpp"
 #include <gtest/gtest.h>
 #include <map>
+#include <set>
 #include <unordered_set>
 #include <vector>
 
@@ -51,29 +53,57 @@ TEST_F(SelectTest, buildingEQ) {
 }
 
 struct SimpleJoinBuilder : public Query, public vectorwise::QueryBuilder {
-   enum { buildValue, probe_matches };
+   enum { buildValue, probe_matches, match_flags };
    struct Result {
       int32_t* r;
+      int32_t* flags;
+      /// Probe keys of the current probe vector
+      void* probeKeys;
       std::unique_ptr<vectorwise::Operator> rootOp;
    };
    runtime::GlobalPool pool;
-   SimpleJoinBuilder(runtime::Database& db, size_t v = 1024)
-       : Query(), QueryBuilder(db, shared, v) {
+   Hashjoin::Partitioning partitioning;
+   /// Whether to push a join filter into the probe scan
+   bool probeFilter;
+   Hashjoin::Mode mode = Hashjoin::Mode::Inner;
+   /// Whether to join on the value column as second key
+   bool secondKey = false;
+   pos_t (Hashjoin::*joinFun)() = &Hashjoin::joinAllParallel;
+   SimpleJoinBuilder(
+       runtime::Database& db, size_t v = 1024,
+       Hashjoin::Partitioning p = Hashjoin::Partitioning::Auto,
+       bool filter = false)
+       : Query(), QueryBuilder(db, shared, v), partitioning(p),
+         probeFilter(filter) {
       previous = runtime::this_worker->allocator.setSource(&pool);
    }
    unique_ptr<Result> getQuery() {
       auto r = make_unique<Result>();
       auto build = Scan("build");
       auto probe = Scan("probe");
-      HashJoin(Buffer(probe_matches, sizeof(pos_t)))
-          .addBuildKey(Column(build, "k"), conf.hash_int32_t_col(),
+      auto join = HashJoin(Buffer(probe_matches, sizeof(pos_t)), joinFun);
+      join.addBuildKey(Column(build, "k"), conf.hash_int32_t_col(),
                        primitives::scatter_int32_t_col)
           .addProbeKey(Column(probe, "b"), conf.hash_int32_t_col(),
                        primitives::keys_equal_int32_t_col)
           .addBuildValue(Column(build, "v"), primitives::scatter_int32_t_col,
                          Buffer(buildValue, sizeof(int32_t)),
-                         primitives::gather_col_int32_t_col);
+                         primitives::gather_col_int32_t_col)
+          .setPartitioning(partitioning)
+          .setMode(mode)
+          .setMatchFlags(Buffer(match_flags, sizeof(int32_t)));
+      if (secondKey)
+         join.addBuildKey(Column(build, "v"), conf.hash_int32_t_col(),
+                          primitives::scatter_int32_t_col)
+             .addProbeKey(Column(probe, "v"), conf.hash_int32_t_col(),
+                          primitives::keys_equal_int32_t_col);
+      if (probeFilter)
+         join.addProbeFilter(Column(probe, "b"), conf.hash_int32_t_col());
       r->r = reinterpret_cast<int32_t*>(Buffer(buildValue).data);
+      r->flags = reinterpret_cast<int32_t*>(Buffer(match_flags).data);
+      auto probeKeys = Column(probe, "b");
+      r->probeKeys = probeKeys.data;
+      probeKeys.registerDS(&r->probeKeys);
       r->rootOp = popOperator();
       return r;
    }
@@ -196,6 +226,200 @@ TEST(Join, simpleJoinWithSmallBuffers) {
 
    ASSERT_EQ(expectedKeys.size(), found);
 }
+TEST(Join, radixPartitionedJoin) {
+   /// Partitions the build side in two radix passes
+   const int32_t nrKeys = 2000000;
+   runtime::Database db;
+   std::vector<int32_t> keys, values, probes;
+   for (int32_t k = 0; k < nrKeys; k++) {
+      keys.push_back(k);
+      values.push_back(k + 1000000);
+   }
+   // every even key matches twice, duplicates follow chains across vectors
+   keys.insert(keys.end(), keys.begin(), keys.begin() + nrKeys / 2);
+   values.insert(values.end(), values.begin(), values.begin() + nrKeys / 2);
+   for (int32_t p = 0; p < 3 * nrKeys; p += 3) probes.push_back(p);
+   db["build"].nrTuples = keys.size();
+   db["probe"].nrTuples = probes.size();
+   db["build"].insert("k", make_unique<algebra::Integer>()) = move(keys);
+   db["build"].insert("v", make_unique<algebra::Integer>()) = move(values);
+   db["probe"].insert("b", make_unique<algebra::Integer>()) = move(probes);
+
+   SimpleJoinBuilder b(db, 1024, Hashjoin::Partitioning::On);
+   auto query = b.getQuery();
+   auto join = dynamic_cast<Hashjoin*>(query->rootOp.get());
+   ASSERT_NE(nullptr, join);
+   size_t found = 0;
+   while (auto n = query->rootOp->next()) {
+      found += n;
+      for (size_t i = 0; i < n; i++) {
+         auto key = *addBytes(reinterpret_cast<int32_t*>(join->buildMatches[i]),
+                              sizeof(runtime::Hashmap::EntryHeader));
+         ASSERT_EQ(0, key % 3);
+         ASSERT_EQ(key + 1000000, query->r[i]);
+      }
+   }
+   // probes 0, 3, ... < nrKeys, the ones below nrKeys / 2 twice
+   ASSERT_EQ(size_t((nrKeys + 2) / 3 + (nrKeys / 2 + 2) / 3), found);
+}
+
+TEST(Join, probeFilter) {
+   /// Probe tuples without build partner are dropped by the scan
+   runtime::Database db;
+   std::vector<int32_t> probes;
+   for (int32_t p = 0; p < 100000; p++) probes.push_back(p % 5000);
+   db["build"].nrTuples = 4;
+   db["probe"].nrTuples = probes.size();
+   db["build"].insert("k", make_unique<algebra::Integer>()) =
+       std::vector<int32_t>{1, 3, 4, 8};
+   db["build"].insert("v", make_unique<algebra::Integer>()) =
+       std::vector<int32_t>{101, 103, 104, 108};
+   db["probe"].insert("b", make_unique<algebra::Integer>()) = move(probes);
+
+   SimpleJoinBuilder b(db, 1024, Hashjoin::Partitioning::Auto, true);
+   auto query = b.getQuery();
+   auto join = dynamic_cast<Hashjoin*>(query->rootOp.get());
+   ASSERT_NE(nullptr, join);
+   size_t found = 0, calls = 0;
+   while (auto n = query->rootOp->next()) {
+      found += n;
+      calls++;
+      for (size_t i = 0; i < n; i++) ASSERT_GT(query->r[i], 100);
+   }
+   EXPECT_TRUE(join->filter().active());
+   ASSERT_EQ(size_t(4 * 100000 / 5000), found);
+   // vectors without tuples passing the filter are skipped
+   EXPECT_LT(calls, 100000u / 1024);
+}
+
+TEST(Join, probeFilterNeedsSingleKey) {
+   /// The filter holds the combined hash of all keys, the scan hashes one
+   runtime::Database db;
+   for (auto rel : {"build", "probe"})
+      for (auto attr : {"k", "v", "b"})
+         db[rel].insert(attr, make_unique<algebra::Integer>()) =
+             std::vector<int32_t>{1, 2};
+   SimpleJoinBuilder b(db, 1024, Hashjoin::Partitioning::Auto, true);
+   b.secondKey = true;
+   EXPECT_THROW(b.getQuery(), runtime_error);
+}
+
+/// Probe and build values of all rows a join with the given mode returns.
+/// Build values are 0 for anti joins, the missing side of outer rows is -1.
+static std::multiset<std::pair<int32_t, int32_t>>
+joinRows(runtime::Database& db, Hashjoin::Mode mode, size_t vecSize,
+         pos_t (Hashjoin::*joinFun)() = &Hashjoin::joinAllParallel) {
+   SimpleJoinBuilder b(db, vecSize);
+   b.mode = mode;
+   b.joinFun = joinFun;
+   auto query = b.getQuery();
+   auto join = dynamic_cast<Hashjoin*>(query->rootOp.get());
+   std::multiset<std::pair<int32_t, int32_t>> rows;
+   while (auto n = query->rootOp->next())
+      for (size_t i = 0; i < n; i++) {
+         auto probe = reinterpret_cast<int32_t*>(query->probeKeys);
+         if (mode == Hashjoin::Mode::LeftAnti) {
+            rows.emplace(probe[join->probeMatches[i]], 0);
+            continue;
+         }
+         auto v = query->r[i];
+         if (query->flags[i])
+            rows.emplace(probe[join->probeMatches[i]], v);
+         else if (mode == Hashjoin::Mode::LeftOuter) {
+            EXPECT_EQ(0, v);
+            rows.emplace(probe[join->probeMatches[i]], -1);
+         } else
+            rows.emplace(-1, v);
+      }
+   return rows;
+}
+
+TEST(Join, simdVariants) {
+   /// Chains of several entries and probe vectors which aren't a multiple of
+   /// the SIMD width
+   runtime::Database db;
+   std::vector<int32_t> keys, values, probes;
+   for (int32_t i = 0; i < 300; i++) {
+      keys.push_back(i % 50);
+      values.push_back(i);
+   }
+   size_t matches = 0;
+   for (int32_t i = 0; i < 1001; i++) {
+      probes.push_back(i % 70);
+      if (i % 70 < 50) matches += 6;
+   }
+   db["build"].nrTuples = keys.size();
+   db["probe"].nrTuples = probes.size();
+   db["build"].insert("k", make_unique<algebra::Integer>()) = move(keys);
+   db["build"].insert("v", make_unique<algebra::Integer>()) = move(values);
+   db["probe"].insert("b", make_unique<algebra::Integer>()) = move(probes);
+
+   const size_t vecSize = 63;
+   auto expected = joinRows(db, Hashjoin::Mode::Inner, vecSize);
+   ASSERT_EQ(matches, expected.size());
+   using runtime::cpu::Isa;
+   if (runtime::cpu::isa() >= Isa::AVX2) {
+      EXPECT_EQ(expected, joinRows(db, Hashjoin::Mode::Inner, vecSize,
+                                   &Hashjoin::joinAllSIMDAVX2));
+   }
+   if (runtime::cpu::isa() >= Isa::AVX512) {
+      EXPECT_EQ(expected, joinRows(db, Hashjoin::Mode::Inner, vecSize,
+                                   &Hashjoin::joinAllSIMD));
+   }
+}
+
+TEST(Join, modes) {
+   runtime::Database db;
+   db["build"].insert("k", make_unique<algebra::Integer>()) =
+       std::vector<int32_t>{1, 3, 4, 8, 3};
+   db["build"].insert("v", make_unique<algebra::Integer>()) =
+       std::vector<int32_t>{101, 103, 104, 108, 203};
+   db["probe"].insert("b", make_unique<algebra::Integer>()) =
+       std::vector<int32_t>{88, 1, 1, 17, 4, 3, 2, 3};
+   db["build"].nrTuples = 5;
+   db["probe"].nrTuples = 8;
+
+   using Mode = Hashjoin::Mode;
+   using Rows = std::multiset<std::pair<int32_t, int32_t>>;
+   // vectors of 2 exercise the continuations
+   const size_t vecSize = 2;
+   EXPECT_EQ(Rows({{1, 101},
+                   {1, 101},
+                   {4, 104},
+                   {3, 103},
+                   {3, 203},
+                   {3, 103},
+                   {3, 203}}),
+             joinRows(db, Mode::Inner, vecSize));
+   // the key 3 has two partners, its probes are returned once
+   auto semi = joinRows(db, Mode::LeftSemi, vecSize);
+   Rows probes;
+   for (auto& row : semi) probes.emplace(row.first, 0);
+   EXPECT_EQ(Rows({{1, 0}, {1, 0}, {4, 0}, {3, 0}, {3, 0}}), probes);
+   EXPECT_EQ(Rows({{88, 0}, {17, 0}, {2, 0}}),
+             joinRows(db, Mode::LeftAnti, vecSize));
+   EXPECT_EQ(Rows({{1, 101},
+                   {1, 101},
+                   {4, 104},
+                   {3, 103},
+                   {3, 203},
+                   {3, 103},
+                   {3, 203},
+                   {88, -1},
+                   {17, -1},
+                   {2, -1}}),
+             joinRows(db, Mode::LeftOuter, vecSize));
+   EXPECT_EQ(Rows({{1, 101},
+                   {1, 101},
+                   {4, 104},
+                   {3, 103},
+                   {3, 203},
+                   {3, 103},
+                   {3, 203},
+                   {-1, 108}}),
+             joinRows(db, Mode::RightOuter, vecSize));
+}
+
 TEST(Join, simpleJoinWithResultOverflow) {
    /// Tests if join works when not all data fits into the buffers
    runtime::Database db;
@@ -467,6 +691,355 @@ TEST_F(HashGroupT, simpleGroup) {
    ASSERT_EQ(found, size_t(5));
 }
 
+class ScanT : public ::testing::Test, public Query, public QueryBuilder {
+
+ protected:
+   runtime::Database db;
+   runtime::GlobalPool pool;
+   ScanT() : Query(), QueryBuilder(db, shared) {
+      previous = runtime::this_worker->allocator.setSource(&pool);
+      auto& rel = db["t"];
+      std::vector<int32_t> v;
+      for (int32_t i = 0; i < 100000; i++) v.push_back(i);
+      auto& attr = rel.insert("v", make_unique<algebra::Integer>());
+      attr = std::move(v);
+      rel.nrTuples = 100000;
+      // zone map over the ascending values
+      attr.zoneMap = make_unique<runtime::ZoneMap>();
+      auto& bounds = attr.zoneMap->typedBoundsForChange<types::Integer>();
+      auto blockSize = runtime::ZoneMap::blockSize;
+      bounds.reset((rel.nrTuples + blockSize - 1) / blockSize);
+      for (size_t b = 0; b * blockSize < rel.nrTuples; b++) {
+         auto last = std::min(rel.nrTuples, (b + 1) * blockSize) - 1;
+         std::pair<types::Integer, types::Integer> block(
+             types::Integer(b * blockSize), types::Integer(last));
+         bounds.push_back(block);
+      }
+   };
+};
+
+TEST_F(ScanT, skipBlocks) {
+   enum { sel_low, sel_high };
+   types::Integer low(40000), high(50000);
+   runtime::BlockFilter blocks(db["t"]);
+   blocks.restrict(db["t"]["v"], low, high);
+   ASSERT_EQ(blocks.nrBlocks(), size_t(7));
+   ASSERT_EQ(blocks.skipped(), size_t(5));
+
+   int64_t count = 0;
+   auto t = Scan("t", &blocks);
+   Select(Expression()
+              .addOp(primitives::sel_greater_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low, sizeof(pos_t)), Column(t, "v"),
+                     Value(&low))
+              .addOp(primitives::selsel_less_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low, sizeof(pos_t)),
+                     Buffer(sel_high, sizeof(pos_t)), Column(t, "v"),
+                     Value(&high)));
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 10001);
+}
+
+TEST_F(ScanT, unpackColumns) {
+   enum { sel_low, sel_high };
+   // bit pack v with a frame of reference of 0
+   auto& attr = db["t"]["v"];
+   auto n = db["t"].nrTuples;
+   auto bits = runtime::bitsFor(n - 1);
+   auto values = reinterpret_cast<int32_t*>(attr.data());
+   attr.packed = make_unique<runtime::PackedColumn>();
+   auto& data = attr.packed->data_;
+   auto size = 8 + runtime::packedSize(n, bits);
+   data.reset(size);
+   uint8_t zero = 0;
+   for (size_t i = 0; i < size; i++) data.push_back(zero);
+   reinterpret_cast<uint32_t*>(data.data())[1] = bits;
+   for (size_t c = 0; c * runtime::packChunkSize < n; c++)
+      runtime::packChunk(values + c * runtime::packChunkSize,
+                         std::min(runtime::packChunkSize,
+                                  n - c * runtime::packChunkSize),
+                         0, bits, data.data() + 8 + c * bits * 8);
+
+   types::Integer low(40000), high(50000);
+   int64_t count = 0;
+   auto t = Scan("t");
+   Select(Expression()
+              .addOp(primitives::sel_greater_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low, sizeof(pos_t)), Column(t, "v"),
+                     Value(&low))
+              .addOp(primitives::selsel_less_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low, sizeof(pos_t)),
+                     Buffer(sel_high, sizeof(pos_t)), Column(t, "v"),
+                     Value(&high)));
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   // the scan reads the packed values only
+   memset(values, 0, n * sizeof(int32_t));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 10001);
+}
+
+TEST_F(ScanT, skipAllBlocks) {
+   types::Integer low(-10), high(-1);
+   runtime::BlockFilter blocks(db["t"]);
+   blocks.restrict(db["t"]["v"], low, high);
+   ASSERT_EQ(blocks.skipped(), blocks.nrBlocks());
+
+   int64_t count = 0;
+   Scan("t", &blocks);
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   auto root = popOperator();
+   root->next();
+   EXPECT_EQ(count, 0);
+}
+
+TEST_F(ScanT, nodePartitions) {
+   enum { sel_low, sel_high };
+   // two partitions, the second is scanned through stealing on one node
+   db["t"].nodeBounds = {0, 65536, 100000};
+   types::Integer low(60000), high(70000);
+   int64_t count = 0;
+   auto t = Scan("t");
+   Select(Expression()
+              .addOp(primitives::sel_greater_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low, sizeof(pos_t)), Column(t, "v"),
+                     Value(&low))
+              .addOp(primitives::selsel_less_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low, sizeof(pos_t)),
+                     Buffer(sel_high, sizeof(pos_t)), Column(t, "v"),
+                     Value(&high)));
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 10001);
+}
+
+TEST_F(ScanT, scanRange) {
+   auto& rel = db["t"];
+   auto all = rel.sortedRange("v", types::Integer(30000), types::Integer(39999));
+   EXPECT_EQ(all.first, 0u);
+   EXPECT_EQ(all.second, rel.nrTuples);
+   rel.sortKey = "v";
+   auto rows = rel.sortedRange("v", types::Integer(30000), types::Integer(39999));
+   ASSERT_EQ(rows.first, 30000u);
+   ASSERT_EQ(rows.second, 40000u);
+
+   // partitions are clipped to the range
+   rel.nodeBounds = {0, 35000, 100000};
+   int64_t count = 0;
+   Scan("t", rows.first, rows.second);
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   auto root = popOperator();
+   root->next();
+   EXPECT_EQ(count, 10000);
+}
+
+TEST_F(ScanT, restrictRows) {
+   runtime::BlockFilter blocks(db["t"]);
+   blocks.restrictRows(20000, 40000);
+   EXPECT_EQ(blocks.rowsBegin(), 20000u);
+   EXPECT_EQ(blocks.rowsEnd(), 40000u);
+   // blocks of 16384 tuples, only 1 and 2 overlap the rows
+   EXPECT_EQ(blocks.skipped(), blocks.nrBlocks() - 2);
+   EXPECT_EQ(blocks.begin(1), 20000u);
+   EXPECT_EQ(blocks.end(2), 40000u);
+   EXPECT_FALSE(blocks.mayMatch(0, 20000));
+   EXPECT_TRUE(blocks.mayMatch(0, 20001));
+}
+
+TEST_F(ScanT, appendedTuples) {
+   enum { sel_low };
+   auto& rel = db["t"];
+   std::vector<int32_t> v;
+   for (int32_t i = 100000; i < 100100; i++) v.push_back(i);
+   db.append("t", {{"v", v.data()}}, v.size());
+   ASSERT_EQ(rel.nrTuples, 100100u);
+
+   types::Integer low(99990);
+   int64_t count = 0;
+   auto t = Scan("t");
+   Select(Expression().addOp(
+       primitives::sel_greater_equal_int32_t_col_int32_t_val,
+       Buffer(sel_low, sizeof(pos_t)), Column(t, "v"), Value(&low)));
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 110);
+}
+
+TEST_F(ScanT, tunedVectorSize) {
+   enum { sel_high };
+   tuneVectorSizes = 2;
+   types::Integer high(50000);
+   int64_t count = 0;
+   auto t = Scan("t");
+   Select(Expression().addOp(
+       primitives::sel_greater_equal_int32_t_col_int32_t_val,
+       Buffer(sel_high, sizeof(pos_t)), Column(t, "v"), Value(&high)));
+   FixedAggregation(Expression().addOp(primitives::aggr_static_count_star,
+                                       Value(&count)));
+   tuneVectorSizes = 0;
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   // sizes change between vectors, but every tuple is scanned exactly once
+   EXPECT_EQ(count, 50000);
+}
+
+TEST_F(ScanT, denseSelection) {
+   enum { sel_low, sel_high, bm_low, bm_high };
+   types::Integer low(1000), high(40000);
+   int64_t count = 0;
+   int32_t sum = 0;
+   auto t = Scan("t");
+   // both representations end in sel_high, which must exist before either
+   // expression is built
+   Buffer(sel_low, sizeof(pos_t));
+   Buffer(sel_high, sizeof(pos_t));
+   Select(Expression()
+              .addOp(primitives::sel_greater_equal_int32_t_col_int32_t_val,
+                     Buffer(sel_low), Column(t, "v"), Value(&low))
+              .addOp(primitives::selsel_less_int32_t_col_int32_t_val,
+                     Buffer(sel_low), Buffer(sel_high), Column(t, "v"),
+                     Value(&high)),
+          Expression()
+              .addOp(primitives::selbm_greater_equal_int32_t_col_int32_t_val,
+                     Bitmap(bm_low), Column(t, "v"), Value(&low))
+              .addOp(primitives::selbmbm_less_int32_t_col_int32_t_val,
+                     Bitmap(bm_low), Bitmap(bm_high), Column(t, "v"),
+                     Value(&high))
+              .addOp(primitives::bitmap_to_sel, Buffer(sel_high),
+                     Bitmap(bm_high)));
+   auto& select = static_cast<class Select&>(*operatorStack.top());
+   FixedAggregation(
+       Expression()
+           .addOp(primitives::aggr_static_sel_plus_int32_t_col,
+                  Buffer(sel_high), Value(&sum), Column(t, "v"))
+           .addOp(primitives::aggr_static_count_star, Value(&count)));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 39000);
+   EXPECT_EQ(sum, 39000 * (1000 + 39999) / 2);
+   // dense once the selectivity is high, sparse again behind the range
+   EXPECT_GT(select.denseVectors, 30u);
+   EXPECT_LT(select.denseVectors, 60u);
+}
+
+TEST_F(ScanT, bitmapConsumers) {
+   enum { bm, diff };
+   types::Integer low(99000);
+   int64_t count = 0;
+   int32_t sum = 0;
+   auto t = Scan("t");
+   Select(Expression().addOp(
+       primitives::selbm_greater_equal_int32_t_col_int32_t_val, Bitmap(bm),
+       Column(t, "v"), Value(&low)));
+   Project().addExpression(
+       Expression().addOp(primitives::proj_bm_minus_int32_t_col_int32_t_val,
+                          Bitmap(bm), Buffer(diff, sizeof(int32_t)),
+                          Column(t, "v"), Value(&low)));
+   FixedAggregation(
+       Expression()
+           .addOp(primitives::aggr_static_bm_plus_int32_t_col, Bitmap(bm),
+                  Value(&sum), Buffer(diff))
+           .addOp(primitives::aggr_static_bm_count_star, Value(&count),
+                  Bitmap(bm)));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 1000);
+   EXPECT_EQ(sum, 999 * 1000 / 2);
+}
+
+TEST_F(ScanT, denseBitmapConsumers) {
+   enum { sel_high, bm_high, diff };
+   types::Integer high(40000);
+   int64_t count = 0;
+   int32_t sum = 0;
+   auto t = Scan("t");
+   Select(Expression().addOp(
+              primitives::sel_less_int32_t_col_int32_t_val,
+              Buffer(sel_high, sizeof(pos_t)), Column(t, "v"), Value(&high)),
+          Expression().addOp(primitives::selbm_less_int32_t_col_int32_t_val,
+                             Bitmap(bm_high), Column(t, "v"), Value(&high)),
+          Bitmap(bm_high));
+   auto& select = static_cast<class Select&>(*operatorStack.top());
+   Buffer(diff, sizeof(int32_t));
+   Project().addExpression(
+       Expression().addOp(primitives::proj_sel_minus_int32_t_col_int32_t_val,
+                          Buffer(sel_high), Buffer(diff), Column(t, "v"),
+                          Value(&high)),
+       Expression().addOp(primitives::proj_bm_minus_int32_t_col_int32_t_val,
+                          Bitmap(bm_high), Buffer(diff), Column(t, "v"),
+                          Value(&high)));
+   FixedAggregation(
+       Expression()
+           .addOp(primitives::aggr_static_plus_int32_t_col, Value(&sum),
+                  Buffer(diff))
+           .addOp(primitives::aggr_static_count_star, Value(&count)),
+       Expression()
+           .addOp(primitives::aggr_static_bm_plus_int32_t_col,
+                  Bitmap(bm_high), Value(&sum), Buffer(diff))
+           .addOp(primitives::aggr_static_bm_count_star, Value(&count),
+                  Bitmap(bm_high)));
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(1));
+   EXPECT_EQ(count, 40000);
+   EXPECT_EQ(sum, -40000 * 40001 / 2);
+   // the consumers read the bitmap until the selection turns sparse
+   EXPECT_GT(select.denseVectors, 0u);
+}
+
+TEST(VectorSizeTuner, fitsCacheAndRefines) {
+   auto l2 = VectorSizeTuner::l2Bytes();
+   EXPECT_EQ(VectorSizeTuner::fitting(l2, 4096), VectorSizeTuner::minSize);
+   EXPECT_EQ(VectorSizeTuner::fitting(1, 4096), size_t(4096));
+   EXPECT_EQ(VectorSizeTuner::fitting(l2 / 2048, 4096), size_t(1024));
+
+   // pipelines which get cheaper with larger vectors grow to the capacity
+   VectorSizeTuner growing("growing", 4096, true);
+   growing.start(l2 / 2048);
+   ASSERT_EQ(growing.size(), size_t(1024));
+   for (size_t i = 0; i < 20 * VectorSizeTuner::window; i++)
+      growing.measured(growing.size(), 1000000 / growing.size());
+   EXPECT_EQ(growing.size(), size_t(4096));
+
+   // and the ones which get more expensive shrink to the minimum
+   VectorSizeTuner shrinking("shrinking", 4096, true);
+   shrinking.start(l2 / 2048);
+   for (size_t i = 0; i < 20 * VectorSizeTuner::window; i++)
+      shrinking.measured(shrinking.size(),
+                         shrinking.size() * shrinking.size());
+   EXPECT_EQ(shrinking.size(), VectorSizeTuner::minSize);
+
+   // without online refinement the initial size stays
+   VectorSizeTuner fixed("fixed", 4096, false);
+   fixed.start(l2 / 2048);
+   fixed.measured(1024, 1);
+   EXPECT_EQ(fixed.size(), size_t(1024));
+}
+
+TEST(VectorAllocator, countsBitmapsInTupleBytes) {
+   runtime::GlobalPool pool;
+   auto previous = runtime::this_worker->allocator.setSource(&pool);
+   VectorAllocator allocator(1024);
+   auto bytes = allocator.getTupleBytes();
+   allocator.get(sizeof(int64_t));
+   EXPECT_EQ(*bytes, sizeof(int64_t));
+   // one byte per tuple holds the bits of eight bitmaps
+   for (size_t i = 0; i < 8; i++) allocator.getBitmap();
+   EXPECT_EQ(*bytes, sizeof(int64_t) + 1);
+   allocator.getBitmap();
+   EXPECT_EQ(*bytes, sizeof(int64_t) + 2);
+   runtime::this_worker->allocator.setSource(previous);
+}
+
 class HashGroupSmallBuf : public ::testing::Test,
                           public Query,
                           public QueryBuilder {
@@ -609,3 +1182,182 @@ TEST_F(HashGroupSmallBuf, groupWithSel) {
 }
 
 } // namespace operatortest
+
+class SortT : public ::testing::Test, public Query, public QueryBuilder {
+
+ protected:
+   runtime::Database db;
+   runtime::GlobalPool pool;
+   SortT() : Query(), QueryBuilder(db, shared, 3) {
+      previous = runtime::this_worker->allocator.setSource(&pool);
+      auto& rel = db["t"];
+      rel.insert("k1", make_unique<algebra::Integer>()) =
+          std::vector<int32_t>{2, -1, 2, 0, -1, 2, 7, 0};
+      rel.insert("k2", make_unique<algebra::BigInt>()) =
+          std::vector<int64_t>{5, 3, -8, 1, 9, 6, -2, 1};
+      rel.insert("v", make_unique<algebra::BigInt>()) =
+          std::vector<int64_t>{0, 1, 2, 3, 4, 5, 6, 7};
+      rel.nrTuples = 8;
+   }
+};
+
+TEST_F(SortT, ascendingAndDescendingKeys) {
+   enum { sorted_k1, sorted_v };
+   auto t = Scan("t");
+   Sort()
+       .addKey(Column(t, "k1"), primitives::normalize_int32_t_col)
+       .addKey(Column(t, "k2"), primitives::normalize_desc_int64_t_col)
+       .addValue(Column(t, "k1"), primitives::scatter_int32_t_col,
+                 Buffer(sorted_k1, sizeof(int32_t)),
+                 primitives::gather_col_int32_t_col)
+       .addValue(Column(t, "v"), primitives::scatter_int64_t_col,
+                 Buffer(sorted_v, sizeof(int64_t)),
+                 primitives::gather_col_int64_t_col);
+   auto root = popOperator();
+   // k1 ascending, then k2 descending, ties of both in any order
+   std::vector<int32_t> expectedK1 = {-1, -1, 0, 0, 2, 2, 2, 7};
+   std::vector<std::set<int64_t>> expectedV = {{4}, {1}, {3, 7}, {3, 7},
+                                               {5}, {0}, {2}, {6}};
+   size_t found = 0;
+   while (auto n = root->next()) {
+      ASSERT_LE(n, size_t(3));
+      auto k1 = (int32_t*)Buffer(sorted_k1).data;
+      auto v = (int64_t*)Buffer(sorted_v).data;
+      for (size_t i = 0; i < n; ++i, ++found) {
+         ASSERT_LT(found, expectedK1.size());
+         EXPECT_EQ(k1[i], expectedK1[found]);
+         EXPECT_EQ(expectedV[found].count(v[i]), size_t(1));
+      }
+   }
+   ASSERT_EQ(found, expectedK1.size());
+}
+
+TEST_F(SortT, topK) {
+   enum { sorted_v };
+   auto t = Scan("t");
+   TopK(3)
+       .addKey(Column(t, "k2"), primitives::normalize_desc_int64_t_col)
+       .addValue(Column(t, "v"), primitives::scatter_int64_t_col,
+                 Buffer(sorted_v, sizeof(int64_t)),
+                 primitives::gather_col_int64_t_col);
+   auto root = popOperator();
+   ASSERT_EQ(root->next(), pos_t(3));
+   auto v = (int64_t*)Buffer(sorted_v).data;
+   EXPECT_EQ(v[0], 4);
+   EXPECT_EQ(v[1], 5);
+   EXPECT_EQ(v[2], 0);
+   ASSERT_EQ(root->next(), EndOfStream);
+}
+
+TEST(Sort, mergeRuns) {
+   Sort::Shared shared;
+   Sort sort(shared);
+   sort.keySize = 8;
+   // runs of normalized 64 bit keys with duplicates across runs
+   std::vector<std::vector<uint64_t>> keys(3);
+   for (uint64_t i = 0; i < 100; ++i) keys[i % 3].push_back(i / 2 * 7 % 61);
+   std::vector<std::vector<uint8_t>> rows(keys.size());
+   std::vector<std::vector<uint8_t*>> runs(keys.size());
+   for (size_t r = 0; r < keys.size(); ++r) {
+      rows[r].resize(keys[r].size() * 8);
+      for (size_t i = 0; i < keys[r].size(); ++i)
+         primitives::normalizeKey(keys[r][i], rows[r].data() + i * 8);
+      for (size_t i = 0; i < keys[r].size(); ++i)
+         runs[r].push_back(rows[r].data() + i * 8);
+      std::sort(runs[r].begin(), runs[r].end(),
+                [&](uint8_t* a, uint8_t* b) { return sort.less(a, b); });
+      shared.runs.push_back(&runs[r]);
+   }
+   sort.planMerge();
+   ASSERT_EQ(shared.partOffsets.size(), keys.size() * Sort::partsPerRun + 1);
+   for (size_t p = 0; p + 1 < shared.partOffsets.size(); ++p)
+      sort.mergePart(p);
+
+   std::vector<uint64_t> expected;
+   for (auto& run : keys)
+      expected.insert(expected.end(), run.begin(), run.end());
+   std::sort(expected.begin(), expected.end());
+   ASSERT_EQ(shared.sorted.size(), expected.size());
+   for (size_t i = 0; i < expected.size(); ++i)
+      ASSERT_EQ(__builtin_bswap64(*(uint64_t*)shared.sorted[i]), expected[i]);
+}
+
+class MergeJoinT : public ::testing::Test, public Query, public QueryBuilder {
+
+ protected:
+   runtime::Database db;
+   runtime::GlobalPool pool;
+   MergeJoinT() : Query(), QueryBuilder(db, shared, 4) {
+      previous = runtime::this_worker->allocator.setSource(&pool);
+      // three build tuples for each even key up to 38
+      std::vector<int32_t> bk;
+      std::vector<int64_t> bv;
+      for (int32_t i = 0; i < 60; ++i) {
+         bk.push_back(i / 3 * 2);
+         bv.push_back(i);
+      }
+      db["b"].insert("k", make_unique<algebra::Integer>()) = move(bk);
+      db["b"].insert("v", make_unique<algebra::BigInt>()) = move(bv);
+      db["b"].nrTuples = 60;
+      // two probe tuples for each key up to 49
+      std::vector<int32_t> pk;
+      std::vector<int64_t> pv;
+      for (int32_t i = 0; i < 100; ++i) {
+         pk.push_back(i / 2);
+         pv.push_back(i);
+      }
+      db["p"].insert("k", make_unique<algebra::Integer>()) = move(pk);
+      db["p"].insert("v", make_unique<algebra::BigInt>()) = move(pv);
+      db["p"].nrTuples = 100;
+   }
+};
+
+TEST_F(MergeJoinT, orderedInputs) {
+   enum { build_v, probe_matches };
+   ASSERT_TRUE(db["b"].orderedBy<types::Integer>("k"));
+   ASSERT_TRUE(db["p"].orderedBy<types::Integer>("k"));
+   auto b = Scan("b");
+   auto p = Scan("p");
+   MergeJoin(Buffer(probe_matches, sizeof(pos_t)))
+       .addBuildKey(Column(b, "k"), primitives::normalize_int32_t_col)
+       .addProbeKey(Column(p, "k"), primitives::normalize_int32_t_col)
+       .addBuildValue(Column(b, "v"), primitives::scatter_int64_t_col,
+                      Buffer(build_v, sizeof(int64_t)),
+                      primitives::gather_col_int64_t_col);
+   auto probeValues = Column(p, "v");
+   void* pv = probeValues.data;
+   probeValues.registerDS(&pv);
+   auto root = popOperator();
+   auto join = dynamic_cast<class MergeJoin*>(root.get());
+
+   std::multiset<std::pair<int64_t, int64_t>> expected, found;
+   for (int64_t i = 0; i < 100; ++i) {
+      auto key = i / 2;
+      if (key % 2 || key > 38) continue;
+      for (int64_t j = 0; j < 3; ++j) expected.emplace(i, key / 2 * 3 + j);
+   }
+   while (auto n = root->next()) {
+      ASSERT_LE(n, size_t(4));
+      auto v = (int64_t*)Buffer(build_v).data;
+      for (size_t i = 0; i < n; ++i)
+         found.emplace(((int64_t*)pv)[join->probeMatches[i]], v[i]);
+   }
+   EXPECT_EQ(expected, found);
+   // every range starts with the first tuple of a key
+   auto& ranges = shared.get<MergeJoin::Shared>(opNr - 1);
+   EXPECT_GT(ranges.probeBounds.size(), size_t(2));
+   for (auto bound : ranges.probeBounds) EXPECT_EQ(bound % 2, size_t(0));
+}
+
+TEST_F(MergeJoinT, unorderedInput) {
+   enum { probe_matches };
+   db["p"]["k"].data<types::Integer>()[50] = types::Integer(3);
+   ASSERT_FALSE(db["p"].orderedBy<types::Integer>("k"));
+   auto b = Scan("b");
+   auto p = Scan("p");
+   MergeJoin(Buffer(probe_matches, sizeof(pos_t)))
+       .addBuildKey(Column(b, "k"), primitives::normalize_int32_t_col)
+       .addProbeKey(Column(p, "k"), primitives::normalize_int32_t_col);
+   auto root = popOperator();
+   EXPECT_THROW(while (root->next()) {}, std::runtime_error);
+}
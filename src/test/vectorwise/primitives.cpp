@@ -1,8 +1,13 @@
 #include "vectorwise/Primitives.hpp"
+#include "vectorwise/Operations.hpp"
+#include "common/runtime/Cpu.hpp"
 #include "common/runtime/Hash.hpp"
 #include "common/runtime/Hashmap.hpp"
 #include "common/runtime/Types.hpp"
 #include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <sstream>
 
 using types::Date;
 using namespace std;
@@ -27,6 +32,59 @@ TEST(GTEQ, Date) {
    for (pos_t i = 0; i < n; ++i) ASSERT_EQ(expected[i], result[i]);
 }
 
+TEST(Flavors, adaptiveSelection) {
+   ASSERT_NE(primitives::flavorsOf(
+                 (void*)primitives::sel_less_int32_t_col_int32_t_val),
+             nullptr);
+   ASSERT_EQ(primitives::flavorsOf((void*)primitives::widen_int8_t_col_int64_t),
+             nullptr);
+   vector<int32_t> values(1024);
+   vector<pos_t> result(values.size());
+   int32_t bound = 0;
+   adaptiveFlavors = true;
+   {
+      F3_Op op(result.data(), values.data(), &bound,
+               primitives::sel_less_int32_t_col_int32_t_val);
+      adaptiveFlavors = false;
+      // every flavor gives the same result while the selectivity changes
+      for (size_t call = 0; call < 3 * Flavors<primitives::F3>::explorePeriod;
+           ++call) {
+         for (size_t i = 0; i < values.size(); ++i)
+            values[i] = (i * 7 + call) % 1024;
+         bound = call % 1024;
+         pos_t expected = 0;
+         for (auto v : values) expected += v < bound;
+         ASSERT_EQ(expected, op.run(values.size()));
+         for (pos_t i = 0; i < expected; ++i)
+            ASSERT_LT(values[result[i]], bound);
+      }
+   }
+   std::stringstream report;
+   printFlavorReport(report);
+   EXPECT_NE(report.str().find("sel_less_int32_t_col_int32_t_val: branching"),
+             std::string::npos);
+   EXPECT_NE(report.str().find("branch free"), std::string::npos);
+}
+
+TEST(Widen, int8_t) {
+   vector<int8_t> narrow = {-128, 0, 5, 127};
+   vector<int64_t> wide(narrow.size());
+   int64_t base = 1000;
+   auto n = primitives::widen_int8_t_col_int64_t(narrow.size(), wide.data(),
+                                                 narrow.data(), &base);
+   ASSERT_EQ(pos_t(4), n);
+   vector<int64_t> expected = {872, 1000, 1005, 1127};
+   for (pos_t i = 0; i < n; ++i) ASSERT_EQ(expected[i], wide[i]);
+
+   vector<pos_t> sel = {1, 3};
+   vector<int32_t> selected(sel.size());
+   n = primitives::widen_sel_int8_t_col_int32_t(
+       sel.size(), sel.data(), selected.data(), narrow.data(), &base);
+   ASSERT_EQ(pos_t(2), n);
+   EXPECT_EQ(1000, selected[0]);
+   EXPECT_EQ(1127, selected[1]);
+}
+
 struct TestData {
    uint64_t a;
    uint8_t b;
@@ -124,10 +182,19 @@ TEST(Partition, uint64_t) {
    for (auto& e : expectedGroupCounts) { ASSERT_EQ(e.second, size_t(0)); }
 }
 
-#ifdef __AVX512F__
 using hash_t = defs::hash_t;
+using runtime::cpu::Isa;
+
+SIMD_AVX512 static void hashSIMD32bits(vector<int32_t>& keys,
+                                       vector<uint32_t>& hashes) {
+   auto simdHash = runtime::MurMurHash3{}.hashKey(
+       Vec16u(keys.data()), Vec16u((uint32_t)vectorwise::primitives::seed));
+   _mm512_mask_storeu_epi64(hashes.data(), ~0, simdHash);
+}
+
 TEST(Hash, SIMD32bits){
    // checks if scalar and simd variants generate the same hashes
+   if (runtime::cpu::isa() < Isa::AVX512) return;
    using runtime::MurMurHash3;
    vector<int32_t> keys = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
    vector<uint32_t> scalarHashes;
@@ -135,8 +202,7 @@ TEST(Hash, SIMD32bits){
 
    for(auto& k : keys) scalarHashes.push_back(MurMurHash3{}(k, (uint32_t)vectorwise::primitives::seed));
 
-   auto simdHash = MurMurHash3{}.hashKey(Vec16u(keys.data()), Vec16u((uint32_t)vectorwise::primitives::seed));
-   _mm512_mask_storeu_epi64(simdHashes.data(), ~0, simdHash);
+   hashSIMD32bits(keys, simdHashes);
 
    size_t i = 0;
    for(auto& scalarHash : scalarHashes){
@@ -144,4 +210,179 @@ TEST(Hash, SIMD32bits){
    }
 
 }
-#endif
+
+TEST(SIMD, variantsMatchScalar) {
+   // the SIMD variants the cpu supports give the results of the scalar ones
+   using namespace vectorwise::primitives;
+   auto isa = runtime::cpu::isa();
+   const pos_t n = 1003; // not a multiple of the vector widths
+   mt19937 gen(42);
+   vector<int32_t> ints(n);
+   vector<int64_t> longs(n), factors(n);
+   vector<pos_t> sel;
+   for (pos_t i = 0; i < n; ++i) {
+      ints[i] = gen() % 1000;
+      longs[i] = int64_t(gen()) - int64_t(gen());
+      factors[i] = (int64_t(gen()) << 20) - int64_t(gen());
+      if (gen() % 3) sel.push_back(i);
+   }
+   const pos_t m = sel.size();
+   int32_t intBound = 500;
+   int64_t longBound = 0;
+
+   auto check = [&](Isa required, F2 hash, F3 hashSel, F2 rehash,
+                    F3 rehashSel, F4 minus, F4 plus, F3 mult, F4 multSel,
+                    F3 less32, F4 ge32, F4 less64, F4 ge64, F4 le64) {
+      if (isa < required) return;
+      SCOPED_TRACE(runtime::cpu::name(required));
+      auto hashes = [&](F2 h, F2 rh, F3 hs, F3 rhs) {
+         vector<hash_t> r(n), rs(n);
+         h(n, r.data(), ints.data());
+         rh(n, r.data(), ints.data());
+         hs(m, sel.data(), rs.data(), ints.data());
+         rhs(m, sel.data(), rs.data(), ints.data());
+         r.insert(r.end(), rs.begin(), rs.begin() + m);
+         return r;
+      };
+      EXPECT_EQ(hashes(hash_int32_t_col, rehash_int32_t_col,
+                       hash_sel_int32_t_col, rehash_sel_int32_t_col),
+                hashes(hash, rehash, hashSel, rehashSel));
+
+      // results of the aligned AVX-512 stores
+      struct alignas(64) Longs {
+         int64_t v[n];
+      };
+      auto projections = [&](F4 mi, F4 pl, F3 mu, F4 mus) {
+         auto r = make_unique<Longs[]>(4);
+         mi(m, sel.data(), r[0].v, &longBound, longs.data());
+         pl(m, sel.data(), r[1].v, longs.data(), &longBound);
+         mu(n, r[2].v, longs.data(), factors.data());
+         mus(m, sel.data(), r[3].v, longs.data(), factors.data());
+         vector<int64_t> all;
+         for (size_t p = 0; p < 4; ++p)
+            all.insert(all.end(), r[p].v, r[p].v + (p == 2 ? n : m));
+         return all;
+      };
+      longBound = 12345;
+      EXPECT_EQ(projections(proj_sel_minus_int64_t_val_int64_t_col,
+                            proj_sel_plus_int64_t_col_int64_t_val,
+                            proj_multiplies_int64_t_col_int64_t_col,
+                            proj_multiplies_sel_int64_t_col_int64_t_col),
+                projections(minus, plus, mult, multSel));
+
+      auto selections = [&](F3 l32, F4 g32, F4 l64, F4 g64, F4 e64) {
+         vector<vector<pos_t>> r(5, vector<pos_t>(n));
+         r[0].resize(l32(n, r[0].data(), ints.data(), &intBound));
+         r[1].resize(g32(m, sel.data(), r[1].data(), ints.data(), &intBound));
+         r[2].resize(l64(m, sel.data(), r[2].data(), longs.data(), &longBound));
+         r[3].resize(g64(m, sel.data(), r[3].data(), longs.data(), &longBound));
+         r[4].resize(e64(m, sel.data(), r[4].data(), longs.data(), &longBound));
+         return r;
+      };
+      // the bound is one of the values, for the equal case
+      longBound = longs[sel[m / 2]];
+      EXPECT_EQ(selections(sel_less_int32_t_col_int32_t_val,
+                           selsel_greater_equal_int32_t_col_int32_t_val,
+                           selsel_less_int64_t_col_int64_t_val,
+                           selsel_greater_equal_int64_t_col_int64_t_val,
+                           selsel_less_equal_int64_t_col_int64_t_val),
+                selections(less32, ge32, less64, ge64, le64));
+   };
+   check(Isa::AVX2, hash4_int32_t_col_avx2, hash4_sel_int32_t_col_avx2,
+         rehash4_int32_t_col_avx2, rehash4_sel_int32_t_col_avx2,
+         proj_sel4_minus_int64_t_val_int64_t_col_avx2,
+         proj_sel4_plus_int64_t_col_int64_t_val_avx2,
+         proj4_multiplies_int64_t_col_int64_t_col_avx2,
+         proj4_multiplies_sel_int64_t_col_int64_t_col_avx2,
+         sel_less_int32_t_col_int32_t_val_avx2,
+         selsel_greater_equal_int32_t_col_int32_t_val_avx2,
+         selsel_less_int64_t_col_int64_t_val_avx2,
+         selsel_greater_equal_int64_t_col_int64_t_val_avx2,
+         selsel_less_equal_int64_t_col_int64_t_val_avx2);
+   check(Isa::AVX512, hash4_int32_t_col, hash4_sel_int32_t_col,
+         rehash4_int32_t_col, rehash4_sel_int32_t_col,
+         proj_sel8_minus_int64_t_val_int64_t_col,
+         proj_sel8_plus_int64_t_col_int64_t_val,
+         proj8_multiplies_int64_t_col_int64_t_col,
+         proj8_multiplies_sel_int64_t_col_int64_t_col,
+         sel_less_int32_t_col_int32_t_val_avx512,
+         selsel_greater_equal_int32_t_col_int32_t_val_avx512,
+         selsel_less_int64_t_col_int64_t_val_avx512,
+         selsel_greater_equal_int64_t_col_int64_t_val_avx512,
+         selsel_less_equal_int64_t_col_int64_t_val_avx512);
+}
+
+TEST(Bitmap, matchesSelectionVectors) {
+   using namespace vectorwise::primitives;
+   const pos_t n = 1003; // ends within a bitmap word
+   mt19937 gen(7);
+   vector<int32_t> ints(n);
+   vector<int64_t> longs(n);
+   vector<int16_t> shorts(n);
+   for (pos_t i = 0; i < n; ++i) {
+      ints[i] = gen() % 100;
+      longs[i] = int64_t(gen()) - int64_t(gen());
+      shorts[i] = gen() % 100;
+   }
+   int32_t intBound = 70;
+   int64_t longBound = 0;
+   int16_t shortBound = 30;
+   vector<uint64_t> first(bitmapWords(n)), second(bitmapWords(n));
+   vector<pos_t> sel(n), expected(n), fromBitmap(n);
+
+   // a selection into a bitmap and one with input bitmap, each converted to
+   // a selection vector
+   auto check = [&](F3 selbm, F4 selbmbm, F3 sel1, F4 selsel2, void* col1,
+                    void* val1, void* col2, void* val2) {
+      auto found = sel1(n, sel.data(), col1, val1);
+      ASSERT_EQ(selbm(n, first.data(), col1, val1), n);
+      ASSERT_EQ(bitmap_to_sel(n, fromBitmap.data(), first.data()), found);
+      for (pos_t i = 0; i < found; ++i) ASSERT_EQ(fromBitmap[i], sel[i]);
+      found = selsel2(found, sel.data(), expected.data(), col2, val2);
+      ASSERT_EQ(selbmbm(n, first.data(), second.data(), col2, val2), n);
+      ASSERT_EQ(bitmap_to_sel(n, fromBitmap.data(), second.data()), found);
+      for (pos_t i = 0; i < found; ++i) ASSERT_EQ(fromBitmap[i], expected[i]);
+      // and back
+      vector<uint64_t> roundTrip(bitmapWords(n));
+      auto tuples = sel_to_bitmap(found, roundTrip.data(), expected.data());
+      ASSERT_EQ(tuples, found ? expected[found - 1] + 1 : 0);
+      for (size_t w = 0; w < bitmapWords(tuples); ++w)
+         ASSERT_EQ(roundTrip[w], second[w]);
+   };
+   check(selbm_less_int32_t_col_int32_t_val,
+         selbmbm_greater_equal_int64_t_col_int64_t_val,
+         sel_less_int32_t_col_int32_t_val,
+         selsel_greater_equal_int64_t_col_int64_t_val, ints.data(), &intBound,
+         longs.data(), &longBound);
+   check(selbm_greater_int64_t_col_int64_t_val,
+         selbmbm_less_equal_int32_t_col_int32_t_val,
+         sel_greater_int64_t_col_int64_t_val,
+         selsel_less_equal_int32_t_col_int32_t_val, longs.data(), &longBound,
+         ints.data(), &intBound);
+   check(selbm_equal_to_int32_t_col_int32_t_val,
+         selbmbm_greater_equal_int16_t_col_int16_t_val,
+         sel_equal_to_int32_t_col_int32_t_val,
+         selsel_greater_equal_int16_t_col_int16_t_val, ints.data(),
+         &intBound, shorts.data(), &shortBound);
+
+   // the mask aware projection and aggregation see the selected tuples only
+   auto found =
+       sel_less_int32_t_col_int32_t_val(n, sel.data(), ints.data(), &intBound);
+   selbm_less_int32_t_col_int32_t_val(n, first.data(), ints.data(), &intBound);
+   vector<int64_t> projected(n), projectedBm(n, -1);
+   proj_sel_plus_int64_t_col_int64_t_val(found, sel.data(), projected.data(),
+                                         longs.data(), &longBound);
+   proj_bm_plus_int64_t_col_int64_t_val(n, first.data(), projectedBm.data(),
+                                        longs.data(), &longBound);
+   for (pos_t i = 0, next = 0; i < n; ++i)
+      if (next < found && sel[next] == i)
+         ASSERT_EQ(projectedBm[i], projected[next++]);
+      else
+         ASSERT_EQ(projectedBm[i], -1);
+   int64_t sum = 0, sumBm = 0, count = 0;
+   aggr_static_sel_plus_int64_t_col(found, sel.data(), &sum, longs.data());
+   aggr_static_bm_plus_int64_t_col(n, first.data(), &sumBm, longs.data());
+   aggr_static_bm_count_star(n, &count, first.data());
+   EXPECT_EQ(sumBm, sum);
+   EXPECT_EQ(count, found);
+}
@@ -1,7 +1,50 @@
 #include "vectorwise/Operations.hpp"
+#include <iomanip>
+#include <map>
+#include <mutex>
 
 namespace vectorwise {
 
+bool adaptiveFlavors = false;
+
+namespace {
+struct FlavorStats {
+   uint64_t calls = 0;
+   /// Operations which settled on the flavor
+   uint64_t best = 0;
+};
+std::mutex flavorReportMutex;
+/// Statistics of the flavors of every primitive group, in group order
+std::map<std::string, std::vector<std::pair<std::string, FlavorStats>>>
+    flavorReport;
+} // namespace
+
+void reportFlavors(const primitives::FlavorGroup& group,
+                   const std::vector<uint64_t>& calls, size_t best) {
+   std::lock_guard<std::mutex> lock(flavorReportMutex);
+   auto& stats = flavorReport[group.name];
+   if (stats.empty())
+      for (auto& flavor : group.flavors)
+         stats.emplace_back(flavor.second, FlavorStats());
+   for (size_t i = 0; i < calls.size(); i++) stats[i].second.calls += calls[i];
+   stats[best].second.best++;
+}
+
+void printFlavorReport(std::ostream& out) {
+   std::lock_guard<std::mutex> lock(flavorReportMutex);
+   for (auto& group : flavorReport) {
+      uint64_t total = 0;
+      for (auto& flavor : group.second) total += flavor.second.calls;
+      out << group.first << ":";
+      for (auto& flavor : group.second)
+         out << " " << flavor.first << " " << std::fixed
+             << std::setprecision(1)
+             << 100.0 * flavor.second.calls / std::max<uint64_t>(total, 1)
+             << "% of calls (best in " << flavor.second.best << " ops)";
+      out << std::endl;
+   }
+}
+
 pos_t Expression::evaluate(pos_t n) {
    pos_t found = n;
    for (auto& op : ops) { found = op->run(found); }
@@ -3,6 +3,7 @@
 #include "common/runtime/Concurrency.hpp"
 #include "common/runtime/SIMD.hpp"
 #include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 #include <tuple>
@@ -16,15 +17,24 @@ size_t Select::next() {
    while (true) {
       auto n = child->next();
       if (n == EndOfStream) return EndOfStream;
-      n = condition->evaluate(n);
-      if (n > 0) return n;
+      auto dense = denseCondition && selectivity >= denseSelectivity;
+      auto found = (dense ? denseCondition : condition)->evaluate(n);
+      denseVectors += dense;
+      denseResult = dense && bitmap;
+      // bitmap primitives return the number of tuples
+      auto selected =
+          denseResult ? primitives::countSelected(n, bitmap) : found;
+      if (n > 0) selectivity = 0.75 * selectivity + 0.25 * selected / n;
+      if (selected > 0) return found;
    }
 }
 
 size_t Project::next() {
    auto n = child->next();
    if (n == EndOfStream) return EndOfStream;
-   for (auto& expression : expressions) expression->evaluate(n);
+   auto dense = denseInput && denseInput->denseResult;
+   for (auto& expression : dense ? denseExpressions : expressions)
+      expression->evaluate(n);
    return n;
 }
 
@@ -32,7 +42,8 @@ size_t FixedAggr::next() {
    if (!consumed) {
       size_t found = 0;
       for (auto n = child->next(); n != EndOfStream; n = child->next()) {
-         found = aggregates.evaluate(n);
+         auto dense = denseInput && denseInput->denseResult;
+         found = (dense ? denseAggregates : aggregates).evaluate(n);
       }
       consumed = true;
       return found;
@@ -41,44 +52,164 @@ size_t FixedAggr::next() {
    }
 }
 
-Scan::Scan(Shared& s, size_t n, size_t v)
-    : shared(s), needsInit(true), currentChunk(0), lastOffset(0), nrTuples(n),
-      vecSize(v) {
-   scanChunkSize = 1;
+Scan::Scan(Shared& s, size_t begin, size_t end, size_t v,
+           const runtime::BlockFilter* f, const std::vector<size_t>& nodeBounds)
+    : shared(s), needsInit(true), currentChunk(0), firstTuple(begin),
+      nrTuples(std::max(begin, end)), vecSize(v), batchSize(v), node(0),
+      filter(f) {
+   size_t scanChunkSize = 1;
    size_t scanMorselSize = 1024 * 10;
    if (vecSize < scanMorselSize) scanChunkSize = scanMorselSize / vecSize + 1;
-   vecInChunk = scanChunkSize;
+   chunkTuples = scanChunkSize * vecSize;
+   posInChunk = chunkTuples;
+   // a chunk belongs to the partition containing its first tuple
+   for (auto bound : nodeBounds) {
+      bound = std::min(std::max(bound, firstTuple), nrTuples) - firstTuple;
+      chunkBounds.push_back((bound + chunkTuples - 1) / chunkTuples);
+   }
 }
 
 void Scan::addConsumer(void** colPtr, size_t typeSize) {
-   consumers.emplace_back(colPtr, vecSize * typeSize);
+   consumers.push_back({colPtr, nullptr, typeSize, {}});
 }
 
-size_t Scan::next() {
-   auto step = 1;
-
-   if (vecInChunk == scanChunkSize) {
-      auto prevChunk = currentChunk;
-      currentChunk = shared.pos.fetch_add(1);
-      auto chunkSkip = currentChunk - prevChunk;
-      if (needsInit) {
-         step = chunkSkip * scanChunkSize;
-         needsInit = false;
+void Scan::addPackedConsumer(void** colPtr,
+                             const runtime::PackedColumn* column) {
+   auto consumer = std::find_if(
+       packedConsumers.begin(), packedConsumers.end(),
+       [&](const PackedConsumer& c) { return c.column == column; });
+   if (consumer == packedConsumers.end()) {
+      packedConsumers.push_back({column, std::vector<int32_t>(vecSize)});
+      consumer = packedConsumers.end() - 1;
+   }
+   *colPtr = consumer->buffer.data();
+}
+
+bool Scan::nextChunk() {
+   // skip chunks without any zone map candidate block
+   do {
+      if (chunkBounds.empty()) {
+         currentChunk = shared.pos.fetch_add(1);
+         if (firstTuple + currentChunk * chunkTuples >= nrTuples) return false;
       } else {
-         chunkSkip -= 1;
-         step = chunkSkip * scanChunkSize + 1;
+         size_t end;
+         if (!shared.chunks.next(chunkBounds, node, 1, currentChunk, end))
+            return false;
+      }
+   } while (filter &&
+            !filter->mayMatch(firstTuple + currentChunk * chunkTuples,
+                              firstTuple + (currentChunk + 1) * chunkTuples));
+   return true;
+}
+
+void Scan::scanPrivately(size_t begin, size_t end) {
+   firstTuple = begin;
+   nrTuples = std::max(begin, end);
+   currentChunk = 0;
+   posInChunk = 0;
+   privateRange = true;
+}
+
+void Scan::tuneVectorSize(std::unique_ptr<VectorSizeTuner> t,
+                          std::shared_ptr<const size_t> b) {
+   tuner = move(t);
+   bufferBytes = move(b);
+}
+
+void Scan::addJoinFilter(const runtime::BloomFilter* filter, const void* keys,
+                         size_t typeSize, primitives::F2 hash) {
+   joinFilters.push_back(
+       {filter, static_cast<const uint8_t*>(keys), typeSize, hash});
+}
+
+size_t Scan::applyJoinFilters(size_t begin, size_t n) {
+   size_t found = n;
+   auto sel = filterSel.data(), selOut = sel + vecSize;
+   bool filtered = false;
+   for (auto& f : joinFilters) {
+      if (!f.filter->active()) continue;
+      f.hash(n, filterHashes.data(),
+             const_cast<uint8_t*>(f.keys + begin * f.typeSize));
+      if (filtered)
+         found = primitives::selsel_bloom_hash_t_col(
+             found, sel, selOut, filterHashes.data(),
+             const_cast<runtime::BloomFilter*>(f.filter));
+      else
+         found = primitives::sel_bloom_hash_t_col(
+             n, selOut, filterHashes.data(),
+             const_cast<runtime::BloomFilter*>(f.filter));
+      std::swap(sel, selOut);
+      filtered = true;
+      if (!found) return 0;
+   }
+   if (found == n) return n;
+   // gather the remaining tuples of every column
+   for (auto& cons : consumers) {
+      auto in = cons.base + begin * cons.typeSize;
+      auto out = cons.buffer.data();
+      auto size = cons.typeSize;
+      for (size_t i = 0; i < found; ++i)
+         std::memcpy(out + i * size, in + sel[i] * size, size);
+      *cons.colPtr = out;
+   }
+   for (auto& cons : packedConsumers)
+      for (size_t i = 0; i < found; ++i) cons.buffer[i] = cons.buffer[sel[i]];
+   return found;
+}
+
+size_t Scan::next() {
+   if (needsInit) {
+      for (auto& cons : consumers) {
+         cons.base = *(uint8_t**)cons.colPtr;
+         if (!joinFilters.empty()) cons.buffer.resize(vecSize * cons.typeSize);
       }
-      vecInChunk = 0;
+      if (!joinFilters.empty()) {
+         filterHashes.resize(vecSize);
+         filterSel.resize(2 * vecSize);
+      }
+      if (!chunkBounds.empty()) node = runtime::numa::currentNode();
+      if (tuner) {
+         auto tupleBytes = *bufferBytes;
+         for (auto& cons : consumers) tupleBytes += cons.typeSize;
+         tupleBytes += packedConsumers.size() * sizeof(int32_t);
+         if (!joinFilters.empty())
+            tupleBytes += sizeof(primitives::hash_t) + 2 * sizeof(pos_t);
+         tuner->start(tupleBytes);
+         batchSize = tuner->size();
+      }
+      needsInit = false;
    }
+   if (tuner && lastVectorSize) {
+      // the time since the last call is what the pipeline spent on the vector
+      tuner->measured(lastVectorSize, __rdtsc() - lastVectorStart);
+      batchSize = tuner->size();
+   }
+   while (true) {
+      auto nextBegin = firstTuple + currentChunk * chunkTuples + posInChunk;
+      if (privateRange) {
+         if (nextBegin >= nrTuples) return EndOfStream;
+      } else if (posInChunk >= chunkTuples || nextBegin >= nrTuples) {
+         if (!nextChunk()) return EndOfStream;
+         posInChunk = 0;
+         nextBegin = firstTuple + currentChunk * chunkTuples;
+      }
 
-   auto nextBegin = lastOffset + step * vecSize;
-   if (nextBegin >= nrTuples) return EndOfStream;
-   auto nextBatchSize = std::min(nrTuples - nextBegin, vecSize);
-   for (auto& cons : consumers)
-      *cons.first = (void*)(*(uint8_t**)cons.first + step * cons.second);
-   lastOffset = nextBegin;
-   vecInChunk++;
-   return nextBatchSize;
+      auto nextBatchSize = std::min(nrTuples - nextBegin, batchSize);
+      if (!privateRange)
+         nextBatchSize = std::min(nextBatchSize, chunkTuples - posInChunk);
+      for (auto& cons : consumers)
+         *cons.colPtr = cons.base + nextBegin * cons.typeSize;
+      for (auto& cons : packedConsumers)
+         cons.column->unpack(nextBegin, nextBatchSize, cons.buffer.data());
+      posInChunk += nextBatchSize;
+      if (tuner) {
+         lastVectorSize = nextBatchSize;
+         lastVectorStart = __rdtsc();
+      }
+      if (joinFilters.empty()) return nextBatchSize;
+      // vectors without any tuple passing the join filters are skipped
+      if (auto n = applyJoinFilters(nextBegin, nextBatchSize)) return n;
+   }
 }
 
 ResultWriter::Input::Input(void* d, size_t size,
@@ -209,14 +340,14 @@ pos_t Hashjoin::joinAllParallel() {
    return found;
 }
 
-pos_t Hashjoin::joinAllSIMD() {
+/// Only to be called if runtime::cpu::isa() supports AVX-512
+SIMD_AVX512 pos_t Hashjoin::joinAllSIMD() {
    size_t found = 0;
    auto followup = contCon.followup;
    auto followupWrite = contCon.followupWrite;
 
    if (followup == followupWrite) {
 
-#ifdef __AVX512F__ // if AVX 512 available, use it!
 #if HASH_SIZE == 32
       size_t rest = cont.numProbes % 8;
       auto ids =
@@ -344,9 +475,6 @@ pos_t Hashjoin::joinAllSIMD() {
          }
       }
 #endif // hash size
-#else
-      const size_t rest = cont.numProbes;
-#endif
       for (size_t i = cont.numProbes - rest, end = cont.numProbes; i < end;
            ++i) {
          auto hash = probeHashes[i];
@@ -403,6 +531,143 @@ pos_t Hashjoin::joinAllSIMD() {
    return found;
 }
 
+pos_t Hashjoin::joinAllSIMDAVX2() { return joinSIMDAVX2<false>(); }
+
+pos_t Hashjoin::joinSelSIMDAVX2() { return joinSIMDAVX2<true>(); }
+
+/// Only to be called if runtime::cpu::isa() supports AVX2. Follows
+/// joinAllSIMD, with 4 lanes and compress stores emulated by permutations.
+template <bool selection> SIMD_AVX2 pos_t Hashjoin::joinSIMDAVX2() {
+   size_t found = 0;
+   auto followup = contCon.followup;
+   auto followupWrite = contCon.followupWrite;
+
+   if (followup == followupWrite) {
+      static_assert(sizeof(pos_t) == 4, "SIMD join assumes sizeof(pos_t) is 4");
+      static_assert(offsetof(runtime::Hashmap::EntryHeader, next) == 0,
+                    "Next is expected to be in first position");
+      size_t rest = cont.numProbes % 4;
+      auto ids = _mm256_setr_epi32(0, 1, 2, 3, 0, 0, 0, 0);
+      const Vec4u hashOffset(offsetof(runtime::Hashmap::EntryHeader, hash));
+      for (size_t i = 0, end = cont.numProbes - rest; i < end; i += 4) {
+         // load hashes
+#if HASH_SIZE == 32
+         Vec4u hashes = _mm256_cvtepu32_epi64(
+             _mm_loadu_si128((const __m128i*)(probeHashes + i)));
+#else
+         Vec4u hashes(probeHashes + i);
+#endif
+         // find entry pointers in ht
+         Vec4uM entries = shared.ht.find_chain_tagged(hashes);
+         // load entry hashes
+         Vec4u entryHashes = _mm256_mask_i64gather_epi64(
+             _mm256_setzero_si256(), nullptr, entries.vec + hashOffset,
+             entries.mask, 1);
+#if HASH_SIZE == 32
+         // the 32 bit hash is followed by the padding of the header
+         entryHashes = entryHashes & Vec4u(0xffffffffull);
+#endif
+         {
+            // Check if hashes match
+            auto hashesEq = _mm256_movemask_pd(_mm256_castsi256_pd(
+                _mm256_and_si256(entries.mask,
+                                 _mm256_cmpeq_epi64(entryHashes, hashes))));
+            // write pointers, the stores may write up to 3 lanes past found
+            _mm256_storeu_si256(
+                (__m256i*)(buildMatches + found),
+                _mm256_permutevar8x32_epi32(entries.vec,
+                                            compressLanes64(hashesEq)));
+            // write selection
+            auto probes =
+                selection ? _mm256_castsi128_si256(_mm_loadu_si128(
+                                (const __m128i*)(probeSel + i)))
+                          : ids;
+            _mm_storeu_si128((__m128i*)(probeMatches + found),
+                             _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+                                 probes, compressLanes(hashesEq))));
+            found += __builtin_popcount(hashesEq);
+         }
+
+         {
+            // write continuations
+            Vec4u nextPtrs = _mm256_mask_i64gather_epi64(
+                _mm256_setzero_si256(), nullptr, entries.vec, entries.mask, 1);
+            auto hasNext = _mm256_movemask_pd(_mm256_castsi256_pd(
+                _mm256_andnot_si256(
+                    _mm256_cmpeq_epi64(nextPtrs,
+                                       Vec4u(uint64_t(shared.ht.end()))),
+                    entries.mask)));
+            if (hasNext) {
+               // write pointers
+               _mm256_storeu_si256(
+                   (__m256i*)(followupEntries + followupWrite),
+                   _mm256_permutevar8x32_epi32(nextPtrs,
+                                               compressLanes64(hasNext)));
+               // write selection
+               _mm_storeu_si128(
+                   (__m128i*)(followupIds + followupWrite),
+                   _mm256_castsi256_si128(_mm256_permutevar8x32_epi32(
+                       ids, compressLanes(hasNext))));
+               followupWrite += __builtin_popcount(hasNext);
+            }
+            ids = _mm256_add_epi32(ids, _mm256_set1_epi32(4));
+         }
+      }
+      for (size_t i = cont.numProbes - rest, end = cont.numProbes; i < end;
+           ++i) {
+         auto hash = probeHashes[i];
+         auto entry = shared.ht.find_chain_tagged(hash);
+         if (entry != shared.ht.end()) {
+            if (entry->hash == hash) {
+               buildMatches[found] = entry;
+               probeMatches[found] = selection ? probeSel[i] : i;
+               found += 1;
+            }
+            if (entry->next != shared.ht.end()) {
+               followupIds[followupWrite] = i;
+               followupEntries[followupWrite] = entry->next;
+               followupWrite += 1;
+            }
+         }
+      }
+   }
+
+   followupWrite %= followupBufferSize;
+
+   while (followup != followupWrite) {
+      auto remainingSpace = batchSize - found;
+      auto nrFollowups = followup <= followupWrite
+                             ? followupWrite - followup
+                             : followupBufferSize - (followup - followupWrite);
+      auto fittingElements = std::min((size_t)nrFollowups, remainingSpace);
+      for (size_t j = 0; j < fittingElements; ++j) {
+         size_t i = followupIds[followup];
+         auto entry = followupEntries[followup];
+         followup = (followup + 1) % followupBufferSize;
+         auto hash = probeHashes[i];
+         if (entry->hash == hash) {
+            buildMatches[found] = entry;
+            probeMatches[found++] = selection ? probeSel[i] : i;
+         }
+         if (entry->next != shared.ht.end()) {
+            followupIds[followupWrite] = i;
+            followupEntries[followupWrite] = entry->next;
+            followupWrite = (followupWrite + 1) % followupBufferSize;
+         }
+      }
+      if (fittingElements < nrFollowups) {
+         // continuation
+         contCon.followupWrite = followupWrite;
+         contCon.followup = followup;
+         return found;
+      }
+   }
+   cont.nextProbe = cont.numProbes;
+   contCon.followup = 0;
+   contCon.followupWrite = 0;
+   return found;
+}
+
 pos_t Hashjoin::joinSel() {
    size_t found = 0;
    // perform continuation
@@ -501,14 +766,14 @@ pos_t Hashjoin::joinSelParallel() {
    return found;
 }
 
-pos_t Hashjoin::joinSelSIMD() {
+/// Only to be called if runtime::cpu::isa() supports AVX-512
+SIMD_AVX512 pos_t Hashjoin::joinSelSIMD() {
    size_t found = 0;
    auto followup = contCon.followup;
    auto followupWrite = contCon.followupWrite;
 
    if (followup == followupWrite) {
 
-#ifdef __AVX512F__ // if AVX 512 available, use it!
 #if HASH_SIZE == 32
       size_t rest = cont.numProbes % 8;
       auto ids =
@@ -637,9 +902,6 @@ pos_t Hashjoin::joinSelSIMD() {
          }
       }
 #endif // hash size
-#else
-      const size_t rest = cont.numProbes;
-#endif
       for (size_t i = cont.numProbes - rest, end = cont.numProbes; i < end;
            ++i) {
          auto hash = probeHashes[i];
@@ -705,6 +967,266 @@ void INTERPRET_SEPARATE insertAllEntries(T& allocations, HT& ht,
    }
 }
 
+/// Copies the entries of entrySize bytes in blocks to out, ordered by the
+/// bits bits of their slot in ht starting at bit shift. bounds receives the
+/// first entry of every partition followed by the number of entries.
+void radixPass(const std::vector<std::pair<void*, size_t>>& blocks,
+               const runtime::Hashmap& ht, unsigned shift, unsigned bits,
+               size_t entrySize, uint8_t* out, std::vector<size_t>& bounds) {
+   const size_t fanout = size_t(1) << bits;
+   auto partition = [&](const uint8_t* entry) {
+      auto hash =
+          reinterpret_cast<const runtime::Hashmap::EntryHeader*>(entry)->hash;
+      return ((hash & ht.mask) >> shift) & (fanout - 1);
+   };
+   bounds.assign(fanout + 1, 0);
+   for (auto& block : blocks) {
+      auto entry = reinterpret_cast<const uint8_t*>(block.first);
+      for (size_t i = 0; i < block.second; ++i, entry += entrySize)
+         bounds[partition(entry) + 1]++;
+   }
+   for (size_t p = 0; p < fanout; ++p) bounds[p + 1] += bounds[p];
+   std::vector<size_t> write(bounds.begin(), bounds.end() - 1);
+   for (auto& block : blocks) {
+      auto entry = reinterpret_cast<const uint8_t*>(block.first);
+      for (size_t i = 0; i < block.second; ++i, entry += entrySize)
+         std::memcpy(out + write[partition(entry)]++ * entrySize, entry,
+                     entrySize);
+   }
+}
+
+unsigned Hashjoin::radixBits(size_t n) {
+   // right outer joins find unmatched entries in the allocations, which a
+   // partitioned build copies before inserting them
+   if (partitioning == Partitioning::Off || mode == Mode::RightOuter)
+      return 0;
+   // entries and their slots
+   auto bytes = n * (ht_entry_size + sizeof(void*));
+   if (partitioning == Partitioning::Auto &&
+       bytes <= runtime::partitioning::cacheBytes())
+      return 0;
+   auto bits = std::max(runtime::partitioning::radixBits(bytes), 1u);
+   // partitions own at least one slot
+   return std::min<unsigned>(bits, __builtin_ctzll(shared.ht.capacity));
+}
+
+void Hashjoin::partitionEntries() {
+   using runtime::partitioning::maxPassBits;
+   size_t n = 0;
+   for (auto& block : allocations) n += block.second;
+   if (!n) return;
+   auto bits = shared.radixBits;
+   auto shift = __builtin_ctzll(shared.ht.capacity) - bits;
+   auto allocate = [&]() {
+      auto out = runtime::this_worker->allocator.allocate(n * ht_entry_size);
+      if (!out) throw std::runtime_error("malloc failed");
+      return reinterpret_cast<uint8_t*>(out);
+   };
+   // the first pass splits by the high bits, the second pass splits each of
+   // its partitions by the low bits
+   auto firstBits = bits > maxPassBits ? bits - bits / 2 : bits;
+   Shared::Run run;
+   run.data = allocate();
+   radixPass(allocations, shared.ht, shift + bits - firstBits, firstBits,
+             ht_entry_size, run.data, run.bounds);
+   if (firstBits < bits) {
+      auto in = run.data;
+      auto firstBounds = std::move(run.bounds);
+      run.data = allocate();
+      run.bounds.assign(1, 0);
+      std::vector<size_t> bounds;
+      for (size_t p = 0; p + 1 < firstBounds.size(); ++p) {
+         auto begin = firstBounds[p];
+         radixPass({{in + begin * ht_entry_size, firstBounds[p + 1] - begin}},
+                   shared.ht, shift, bits - firstBits, ht_entry_size,
+                   run.data + begin * ht_entry_size, bounds);
+         for (size_t q = 1; q < bounds.size(); ++q)
+            run.bounds.push_back(begin + bounds[q]);
+      }
+   }
+   std::lock_guard<std::mutex> lock(shared.runsMutex);
+   shared.runs.push_back(std::move(run));
+}
+
+void Hashjoin::insertPartitions() {
+   auto partitions = size_t(1) << shared.radixBits;
+   // the slots of a partition are written by one worker only
+   for (size_t p; (p = shared.nextPartition++) < partitions;)
+      for (auto& run : shared.runs) {
+         auto first = reinterpret_cast<runtime::Hashmap::EntryHeader*>(
+             run.data + run.bounds[p] * ht_entry_size);
+         shared.ht.insertAll_tagged<false>(
+             first, run.bounds[p + 1] - run.bounds[p], ht_entry_size);
+      }
+}
+
+void Hashjoin::fillFilter() {
+   for (auto& block : allocations) {
+      auto entry = reinterpret_cast<uint8_t*>(block.first);
+      for (size_t i = 0; i < block.second; ++i, entry += ht_entry_size)
+         shared.filter.insert(
+             reinterpret_cast<runtime::Hashmap::EntryHeader*>(entry)->hash);
+   }
+}
+
+void Hashjoin::clusterProbes() {
+   using runtime::partitioning::maxPassBits;
+   auto& ht = shared.ht;
+   // a single pass on the high bits, more partitions than probes do not help
+   auto bits = std::min(shared.radixBits, maxPassBits);
+   auto shift = __builtin_ctzll(ht.capacity) - bits;
+   pos_t bounds[(1 << maxPassBits) + 1] = {};
+   for (pos_t i = 0; i < cont.numProbes; ++i)
+      bounds[((probeHashes[i] & ht.mask) >> shift) + 1]++;
+   for (size_t p = 0; p < (size_t(1) << bits); ++p) bounds[p + 1] += bounds[p];
+   for (pos_t i = 0; i < cont.numProbes; ++i)
+      probeOrder[bounds[(probeHashes[i] & ht.mask) >> shift]++] = i;
+}
+
+pos_t Hashjoin::joinPartitioned() {
+   size_t found = 0;
+   auto& ht = shared.ht;
+   auto output = [&](pos_t i) { return probeSel ? probeSel[i] : i; };
+   // perform continuation of the chain of the previous probe
+   for (auto entry = cont.buildMatch; entry != ht.end(); entry = entry->next) {
+      if (entry->hash == cont.probeHash) {
+         buildMatches[found] = entry;
+         probeMatches[found++] = output(probeOrder[cont.nextProbe - 1]);
+         if (found == batchSize) {
+            cont.buildMatch = entry->next;
+            return found;
+         }
+      }
+   }
+   for (size_t j = cont.nextProbe, end = cont.numProbes; j < end; ++j) {
+      auto i = probeOrder[j];
+      auto hash = probeHashes[i];
+      for (auto entry = ht.find_chain_tagged(hash); entry != ht.end();
+           entry = entry->next) {
+         if (entry->hash == hash) {
+            buildMatches[found] = entry;
+            probeMatches[found++] = output(i);
+            if (found == batchSize) {
+               // output buffers are full, save state for continuation
+               cont.buildMatch = entry->next;
+               cont.probeHash = hash;
+               cont.nextProbe = j + 1;
+               return found;
+            }
+         }
+      }
+   }
+   cont.buildMatch = ht.end();
+   cont.nextProbe = cont.numProbes;
+   return found;
+}
+
+pos_t Hashjoin::joinSemi() {
+   using runtime::Hashmap;
+   auto& ht = shared.ht;
+   auto anti = mode == Mode::LeftAnti;
+   auto output = [&](pos_t i) { return probeSel ? probeSel[i] : i; };
+   // first entry of the chain from entry on with the hash of the probe
+   auto withHash = [&](Hashmap::EntryHeader* entry, Hashmap::hash_t hash) {
+      while (entry != ht.end() && entry->hash != hash) entry = entry->next;
+      return entry;
+   };
+   size_t found = 0;
+   size_t candidates = contCon.followupWrite;
+   if (cont.nextProbe < cont.numProbes) {
+      // one candidate entry per probe of a new vector
+      for (pos_t i = 0; i < cont.numProbes; ++i) {
+         auto hash = probeHashes[i];
+         auto entry = withHash(ht.find_chain_tagged(hash), hash);
+         if (entry != ht.end()) {
+            followupIds[candidates] = i;
+            followupEntries[candidates++] = entry;
+         } else if (anti)
+            probeMatches[found++] = output(i);
+      }
+      cont.nextProbe = cont.numProbes;
+      contCon.followupWrite = candidates;
+      if (found) return found;
+   }
+   if (!candidates) return 0;
+   for (size_t j = 0; j < candidates; ++j) {
+      buildMatches[j] = followupEntries[j];
+      probeMatches[j] = output(followupIds[j]);
+   }
+   auto n = keyEquality.evaluate(candidates);
+   // key equality keeps the order of the candidates, a probe with partner
+   // is done
+   for (size_t j = 0, k = 0; j < candidates && k < n; ++j)
+      if (probeMatches[k] == output(followupIds[j])) {
+         followupEntries[j] = ht.end();
+         ++k;
+      }
+   if (!anti) found = n;
+   // advance the remaining candidates to their next entry with equal hash
+   size_t remaining = 0;
+   for (size_t j = 0; j < candidates; ++j) {
+      if (followupEntries[j] == ht.end()) continue;
+      auto i = followupIds[j];
+      auto entry = withHash(followupEntries[j]->next, probeHashes[i]);
+      if (entry != ht.end()) {
+         followupIds[remaining] = i;
+         followupEntries[remaining++] = entry;
+      } else if (anti)
+         probeMatches[found++] = output(i);
+   }
+   contCon.followupWrite = remaining;
+   return found;
+}
+
+void Hashjoin::markMatches(pos_t n) {
+   if (mode == Mode::LeftOuter)
+      for (pos_t k = 0; k < n; ++k) probeMatched[probeMatches[k]] = 1;
+   if (mode == Mode::RightOuter)
+      for (pos_t k = 0; k < n; ++k) {
+         auto mark =
+             reinterpret_cast<uint8_t*>(buildMatches[k]) + matchedOffset;
+         // entries are shared by all workers, only write them once
+         if (!__atomic_load_n(mark, __ATOMIC_RELAXED))
+            __atomic_store_n(mark, 1, __ATOMIC_RELAXED);
+      }
+   if (matchFlags) std::fill(matchFlags, matchFlags + n, 1);
+}
+
+pos_t Hashjoin::probeOuter() {
+   size_t found = 0;
+   auto null =
+       reinterpret_cast<runtime::Hashmap::EntryHeader*>(nullEntry.data());
+   for (pos_t i = 0; i < cont.numProbes; ++i) {
+      auto probe = probeSel ? probeSel[i] : i;
+      if (probeMatched[probe])
+         probeMatched[probe] = 0;
+      else {
+         buildMatches[found] = null;
+         probeMatches[found++] = probe;
+      }
+   }
+   if (matchFlags) std::fill(matchFlags, matchFlags + found, 0);
+   return found;
+}
+
+pos_t Hashjoin::buildOuter() {
+   size_t found = 0;
+   for (; outerBlock < allocations.size(); ++outerBlock, outerEntry = 0) {
+      auto& block = allocations[outerBlock];
+      auto entries = reinterpret_cast<uint8_t*>(block.first);
+      while (outerEntry < block.second && found < batchSize) {
+         auto entry = entries + outerEntry++ * ht_entry_size;
+         if (entry[matchedOffset]) continue;
+         buildMatches[found] =
+             reinterpret_cast<runtime::Hashmap::EntryHeader*>(entry);
+         probeMatches[found++] = 0;
+      }
+      if (found == batchSize) break;
+   }
+   if (matchFlags) std::fill(matchFlags, matchFlags + found, 0);
+   return found;
+}
+
 pos_t Hashjoin::joinBoncz() {
    size_t followupWrite = contCon.followupWrite;
    size_t found = 0;
@@ -767,37 +1289,89 @@ size_t Hashjoin::next() {
          allocations.push_back(std::make_pair(alloc, n));
          scatterStart = reinterpret_cast<decltype(scatterStart)>(alloc);
          buildScatter.evaluate(n);
+         if (mode == Mode::RightOuter)
+            for (size_t i = 0; i < n; ++i)
+               reinterpret_cast<uint8_t*>(alloc)[i * ht_entry_size +
+                                                 matchedOffset] = 0;
       }
 
       // --- build phase 2: insert ht entries
       shared.found.fetch_add(found);
       barrier([&]() {
          auto globalFound = shared.found.load();
-         if (globalFound) shared.ht.setSize(globalFound);
+         // joins which return probes without partner probe an empty table
+         if (globalFound || preservesProbes()) {
+            shared.ht.setSize(std::max<size_t>(globalFound, 1));
+            shared.radixBits = radixBits(globalFound);
+            if (buildFilter) shared.filter.setSize(globalFound);
+         }
       });
       auto globalFound = shared.found.load();
-      if (globalFound == 0) {
+      if (globalFound == 0 && !preservesProbes()) {
          consumed = true;
          return EndOfStream;
       }
-      insertAllEntries(allocations, shared.ht, ht_entry_size);
+      if (mode == Mode::LeftOuter) {
+         nullEntry.assign((ht_entry_size + 7) / 8, 0);
+         probeMatched.assign(batchSize, 0);
+      }
+      if (shared.radixBits) {
+         // partition tables instead of concurrent inserts into one table
+         partitionEntries();
+         barrier();
+         insertPartitions();
+         if (join == &Hashjoin::joinAll || join == &Hashjoin::joinAllParallel ||
+             join == &Hashjoin::joinSel || join == &Hashjoin::joinSelParallel)
+            join = &Hashjoin::joinPartitioned;
+      } else
+         insertAllEntries(allocations, shared.ht, ht_entry_size);
+      if (buildFilter) fillFilter();
       consumed = true;
       barrier(); // wait for all threads to finish build phase
    }
    // --- lookup
    while (true) {
-      if (cont.nextProbe >= cont.numProbes) {
+      if (probeDone) {
+         // build entries without partner, after all workers probed
+         auto n = buildOuter();
+         if (n) buildGather.evaluate(n);
+         return n;
+      }
+      if (cont.nextProbe >= cont.numProbes && !contCon.followupWrite) {
+         if (probeOuterPending) {
+            probeOuterPending = false;
+            if (auto n = probeOuter()) {
+               buildGather.evaluate(n);
+               return n;
+            }
+         }
          cont.numProbes = right->next();
          cont.nextProbe = 0;
-         if (cont.numProbes == EndOfStream) return EndOfStream;
+         if (cont.numProbes == EndOfStream) {
+            if (mode != Mode::RightOuter) return EndOfStream;
+            barrier();
+            probeDone = true;
+            continue;
+         }
          probeHash.evaluate(cont.numProbes);
+         if (join == &Hashjoin::joinPartitioned) clusterProbes();
+         probeOuterPending = mode == Mode::LeftOuter;
       }
-      // create join pair vectors with matching hashes (Entry*, pos), where
-      // Entry* is for the build side, pos a selection index to the right side
-      auto n = (this->*join)();
-      // check key equality and remove non equal keys from join result
-      n = keyEquality.evaluate(n);
-      if (n == 0) continue;
+      pos_t n;
+      if (mode == Mode::LeftSemi || mode == Mode::LeftAnti) {
+         n = joinSemi();
+         if (n == 0) continue;
+         if (mode == Mode::LeftAnti) return n;
+      } else {
+         // create join pair vectors with matching hashes (Entry*, pos), where
+         // Entry* is for the build side, pos a selection index to the right
+         // side
+         n = (this->*join)();
+         // check key equality and remove non equal keys from join result
+         n = keyEquality.evaluate(n);
+         if (n == 0) continue;
+      }
+      markMatches(n);
       // materialize build side
       buildGather.evaluate(n);
       return n;
@@ -814,6 +1388,10 @@ HashGroup::HashGroup(Shared& s)
     : shared(s), preAggregation(*this), globalAggregation(*this) {
    maxFill = ht.setSize(initialMapSize);
 }
+void HashGroup::expectGroups(size_t groups) {
+   expectedGroups = groups;
+   maxFill = ht.setSize(runtime::grouping::preAggSize(groups));
+}
 HashGroup::~HashGroup() {
    // for (auto& alloc : preAggregation.allocations) free(alloc.first);
    // for (auto& alloc : globalAggregation.allocations) free(alloc.first);
@@ -917,4 +1495,323 @@ size_t HashGroup::next() {
    }
    return EndOfStream;
 }
+
+Sort::Sort(Shared& s) : shared(s) {}
+
+void Sort::materializeRows(size_t n, uint8_t* out) {
+   // the padding of the keys takes part in comparisons
+   for (size_t i = 0; i < n; ++i)
+      std::memset(out + i * rowSize + keySize - 8, 0, 8);
+   scatterStart = out;
+   materialize.evaluate(n);
+}
+
+void Sort::consume() {
+   for (auto n = child->next(); n != EndOfStream; n = child->next()) {
+      auto out = reinterpret_cast<uint8_t*>(
+          runtime::this_worker->allocator.allocate(n * rowSize));
+      if (!out) throw std::runtime_error("malloc failed");
+      materializeRows(n, out);
+      for (size_t i = 0; i < n; ++i) rows.push_back(out + i * rowSize);
+   }
+   std::sort(rows.begin(), rows.end(),
+             [&](const uint8_t* a, const uint8_t* b) { return less(a, b); });
+}
+
+void Sort::planMerge() {
+   auto& runs = shared.runs;
+   size_t total = 0;
+   for (auto run : runs) total += run->size();
+   shared.sorted.resize(total);
+   if (runs.empty()) return;
+   auto parts = runs.size() * partsPerRun;
+   auto order = [&](const uint8_t* a, const uint8_t* b) { return less(a, b); };
+   // splitters between the parts from evenly spaced rows of every run
+   std::vector<uint8_t*> sample;
+   for (auto run : runs)
+      for (size_t i = 1; i < parts; ++i)
+         sample.push_back((*run)[i * run->size() / parts]);
+   std::sort(sample.begin(), sample.end(), order);
+   auto& bounds = shared.partBounds;
+   bounds.assign(parts + 1, std::vector<size_t>(runs.size(), 0));
+   for (size_t r = 0; r < runs.size(); ++r) bounds[parts][r] = runs[r]->size();
+   for (size_t p = 1; p < parts; ++p) {
+      auto splitter = sample[p * sample.size() / parts];
+      for (size_t r = 0; r < runs.size(); ++r) {
+         auto& run = *runs[r];
+         bounds[p][r] =
+             std::lower_bound(run.begin(), run.end(), splitter, order) -
+             run.begin();
+      }
+   }
+   shared.partOffsets.assign(1, 0);
+   for (size_t p = 0; p < parts; ++p) {
+      auto offset = shared.partOffsets.back();
+      for (size_t r = 0; r < runs.size(); ++r)
+         offset += bounds[p + 1][r] - bounds[p][r];
+      shared.partOffsets.push_back(offset);
+   }
+}
+
+void Sort::mergePart(size_t part) {
+   auto& runs = shared.runs;
+   auto& end = shared.partBounds[part + 1];
+   auto pos = shared.partBounds[part];
+   auto out = shared.sorted.begin() + shared.partOffsets[part];
+   // next row and run of every run with rows left, the least key on top
+   using Head = std::pair<uint8_t*, size_t>;
+   auto greater = [&](const Head& a, const Head& b) {
+      return less(b.first, a.first);
+   };
+   std::vector<Head> heads;
+   for (size_t r = 0; r < runs.size(); ++r)
+      if (pos[r] < end[r]) heads.emplace_back((*runs[r])[pos[r]++], r);
+   std::make_heap(heads.begin(), heads.end(), greater);
+   while (!heads.empty()) {
+      std::pop_heap(heads.begin(), heads.end(), greater);
+      auto& head = heads.back();
+      *out++ = head.first;
+      auto r = head.second;
+      if (pos[r] < end[r]) {
+         head.first = (*runs[r])[pos[r]++];
+         std::push_heap(heads.begin(), heads.end(), greater);
+      } else
+         heads.pop_back();
+   }
+}
+
+size_t Sort::next() {
+   if (!consumed) {
+      consume();
+      {
+         std::lock_guard<std::mutex> lock(shared.runsMutex);
+         if (!rows.empty()) shared.runs.push_back(&rows);
+      }
+      barrier([&]() { planMerge(); });
+      for (size_t p; (p = shared.nextPart++) + 1 < shared.partOffsets.size();)
+         mergePart(p);
+      barrier();
+      emitter = !shared.emitting.exchange(true);
+      consumed = true;
+   }
+   if (!emitter) return EndOfStream;
+   auto n = std::min(vecSize, shared.sorted.size() - outputPos);
+   if (n == 0) return EndOfStream;
+   std::copy_n(shared.sorted.begin() + outputPos, n, rowPtrs);
+   outputPos += n;
+   gather.evaluate(n);
+   return n;
+}
+
+TopK::TopK(Shared& s, size_t l) : Sort(s), limit(l) {}
+
+void TopK::consume() {
+   auto order = [&](const uint8_t* a, const uint8_t* b) { return less(a, b); };
+   heapRows.resize(limit * rowSize);
+   // rows is a heap of the first rows seen so far, the last of them on top
+   for (auto n = child->next(); n != EndOfStream; n = child->next()) {
+      if (vectorRows.size() < n * rowSize) vectorRows.resize(n * rowSize);
+      materializeRows(n, vectorRows.data());
+      for (size_t i = 0; i < n; ++i) {
+         auto row = vectorRows.data() + i * rowSize;
+         if (rows.size() < limit) {
+            auto slot = heapRows.data() + rows.size() * rowSize;
+            std::memcpy(slot, row, rowSize);
+            rows.push_back(slot);
+            std::push_heap(rows.begin(), rows.end(), order);
+         } else if (limit && less(row, rows.front())) {
+            std::pop_heap(rows.begin(), rows.end(), order);
+            std::memcpy(rows.back(), row, rowSize);
+            std::push_heap(rows.begin(), rows.end(), order);
+         }
+      }
+   }
+   std::sort_heap(rows.begin(), rows.end(), order);
+}
+
+void TopK::planMerge() {
+   auto order = [&](const uint8_t* a, const uint8_t* b) { return less(a, b); };
+   auto& sorted = shared.sorted;
+   for (auto run : shared.runs)
+      sorted.insert(sorted.end(), run->begin(), run->end());
+   auto k = std::min(limit, sorted.size());
+   std::partial_sort(sorted.begin(), sorted.begin() + k, sorted.end(), order);
+   sorted.resize(k);
+}
+
+MergeJoin::MergeJoin(Shared& s) : shared(s) {}
+
+void MergeJoin::Side::normalizeTuple(size_t i, uint8_t* out,
+                                     size_t keySize) const {
+   std::memset(out, 0, keySize);
+   void* start = out;
+   pos_t first = 0;
+   for (auto& key : keys) {
+      auto value = const_cast<uint8_t*>(key.column + i * key.typeSize);
+      if (key.normalize)
+         key.normalize(1, value, &start, &keySize, key.offset);
+      else
+         key.normalizeSel(1, &first, value, &start, &keySize, key.offset);
+   }
+}
+
+size_t MergeJoin::lowerBound(const Side& side, size_t begin, size_t end,
+                             const uint8_t* key, uint8_t* buffer) const {
+   while (begin < end) {
+      auto mid = begin + (end - begin) / 2;
+      side.normalizeTuple(mid, buffer, keySize);
+      if (compare(buffer, key) < 0)
+         begin = mid + 1;
+      else
+         end = mid;
+   }
+   return begin;
+}
+
+void MergeJoin::planRanges() {
+   if (probe.keyBytes != build.keyBytes)
+      throw std::runtime_error("MergeJoin keys of probe and build side differ");
+   auto probeBegin = probe.scan->rangeBegin();
+   auto probeEnd = probe.scan->rangeEnd();
+   auto ranges = runtime::this_worker->group->size * rangesPerWorker;
+   std::vector<uint8_t> key(keySize), buffer(keySize);
+   shared.probeBounds.assign(1, probeBegin);
+   shared.buildBounds.assign(1, build.scan->rangeBegin());
+   for (size_t r = 1; r < ranges; ++r) {
+      auto split = probeBegin + r * (probeEnd - probeBegin) / ranges;
+      if (split == probeEnd) break;
+      // ranges start with the first tuple of a key on both sides
+      probe.normalizeTuple(split, key.data(), keySize);
+      split = lowerBound(probe, shared.probeBounds.back(), split, key.data(),
+                         buffer.data());
+      if (split == shared.probeBounds.back()) continue;
+      shared.probeBounds.push_back(split);
+      shared.buildBounds.push_back(
+          lowerBound(build, shared.buildBounds.back(), build.scan->rangeEnd(),
+                     key.data(), buffer.data()));
+   }
+   shared.probeBounds.push_back(probeEnd);
+   shared.buildBounds.push_back(
+       std::max(shared.buildBounds.back(), build.scan->rangeEnd()));
+}
+
+size_t MergeJoin::nextProbe() {
+   while (true) {
+      // the rest of the range has no partners without build rows
+      if (rangeOpen && !(buildDone && groupBegin == buildRows.size())) {
+         auto n = right->next();
+         if (n != EndOfStream) {
+            if (probeKeyBuffer.size() < n * keySize)
+               probeKeyBuffer.resize(n * keySize);
+            probeKeys = probeKeyBuffer.data();
+            probeNormalize.evaluate(n);
+            auto previous = lastProbeKey.empty() ? probeKeys
+                                                 : lastProbeKey.data();
+            for (size_t i = 0; i < n; ++i) {
+               auto key = probeKeys + i * keySize;
+               if (compare(previous, key) > 0)
+                  throw std::runtime_error(
+                      "MergeJoin probe side is not ordered by the key");
+               previous = key;
+            }
+            lastProbeKey.assign(previous, previous + keySize);
+            return n;
+         }
+      }
+      auto range = shared.nextRange++;
+      if (range + 1 >= shared.probeBounds.size()) return EndOfStream;
+      probe.scan->scanPrivately(shared.probeBounds[range],
+                                shared.probeBounds[range + 1]);
+      build.scan->scanPrivately(shared.buildBounds[range],
+                                shared.buildBounds[range + 1]);
+      rangeOpen = true;
+      lastProbeKey.clear();
+      for (auto& block : blocks) spareBlocks.push_back(move(block.first));
+      blocks.clear();
+      buildRows.clear();
+      groupBegin = 0;
+      matchPos = 0;
+      buildDone = false;
+   }
+}
+
+bool MergeJoin::nextBuild() {
+   if (buildDone) return false;
+   auto n = left->next();
+   if (n == EndOfStream) {
+      buildDone = true;
+      return false;
+   }
+   std::unique_ptr<uint8_t[]> block;
+   if (spareBlocks.empty())
+      // zeroed, the padding of the keys takes part in comparisons
+      block.reset(new uint8_t[batchSize * rowSize]());
+   else {
+      block = move(spareBlocks.back());
+      spareBlocks.pop_back();
+   }
+   scatterStart = block.get();
+   buildScatter.evaluate(n);
+   for (size_t i = 0; i < n; ++i) {
+      auto row = block.get() + i * rowSize;
+      if (!buildRows.empty() && compare(buildRows.back(), row) > 0)
+         throw std::runtime_error(
+             "MergeJoin build side is not ordered by the key");
+      buildRows.push_back(row);
+   }
+   blocks.emplace_back(move(block), n);
+   return true;
+}
+
+void MergeJoin::dropBuildRows() {
+   size_t dropped = 0;
+   // the last block is kept for the order check of the next one
+   while (blocks.size() > 1 && dropped + blocks.front().second <= groupBegin) {
+      dropped += blocks.front().second;
+      spareBlocks.push_back(move(blocks.front().first));
+      blocks.pop_front();
+   }
+   if (!dropped) return;
+   buildRows.erase(buildRows.begin(), buildRows.begin() + dropped);
+   groupBegin -= dropped;
+   matchPos -= dropped;
+}
+
+size_t MergeJoin::next() {
+   if (!planned) {
+      barrier([&]() { planRanges(); });
+      planned = true;
+   }
+   dropBuildRows();
+   size_t found = 0;
+   while (true) {
+      if (probePos == probeSize) {
+         // matches point into the current probe vector
+         if (found) break;
+         probeSize = nextProbe();
+         probePos = 0;
+         if (probeSize == EndOfStream) break;
+      }
+      auto key = probeKeys + probePos * keySize;
+      if (!matching) {
+         while ((groupBegin < buildRows.size() || nextBuild()) &&
+                compare(buildRows[groupBegin], key) < 0)
+            groupBegin++;
+         matchPos = groupBegin;
+         matching = true;
+      }
+      while (found < batchSize &&
+             (matchPos < buildRows.size() || nextBuild()) &&
+             compare(buildRows[matchPos], key) == 0) {
+         buildMatches[found] = buildRows[matchPos++];
+         probeMatches[found++] = probeSel ? probeSel[probePos] : probePos;
+      }
+      // continues with the matches of the same probe tuple next time
+      if (found == batchSize) break;
+      matching = false;
+      probePos++;
+   }
+   if (found) buildGather.evaluate(found);
+   return found;
+}
 } // namespace vectorwise
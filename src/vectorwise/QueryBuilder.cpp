@@ -51,11 +51,24 @@ QueryBuilder::ResultBuilder::addValue(std::string name, DS buffer) {
    return *this;
 }
 
-QueryBuilder::ScanBuilder QueryBuilder::Scan(std::string relation) {
+QueryBuilder::ScanBuilder
+QueryBuilder::Scan(std::string relation, const runtime::BlockFilter* filter) {
+   return Scan(relation, 0, db[relation].nrTuples, filter);
+}
+
+QueryBuilder::ScanBuilder QueryBuilder::Scan(std::string relation,
+                                             size_t begin, size_t end,
+                                             const runtime::BlockFilter* filter) {
    auto& rel = db[relation];
    auto nr = nextOpNr();
    auto& s = operatorState.get<Scan::Shared>(nr);
-   auto scan = make_unique<class Scan>(s, rel.nrTuples, vecs.getVecSize());
+   auto scan = make_unique<class Scan>(s, begin, std::min(end, rel.nrTuples),
+                                       vecs.getVecSize(), filter,
+                                       rel.nodeBounds);
+   if (tuneVectorSizes)
+      scan->tuneVectorSize(make_unique<VectorSizeTuner>(
+                               relation, vecs.getVecSize(), tuneVectorSizes > 1),
+                           vecs.getTupleBytes());
    auto res = scan.get();
    pushOperator(move(scan));
    return {*res, rel};
@@ -77,6 +90,21 @@ void QueryBuilder::Select(std::unique_ptr<class Expression>&& exp) {
    pushOperator(move(select));
 }
 
+void QueryBuilder::Select(std::unique_ptr<class Expression>&& exp,
+                          std::unique_ptr<class Expression>&& dense) {
+   Select(move(exp));
+   auto& select = static_cast<class Select&>(*operatorStack.top());
+   select.denseCondition = move(dense);
+}
+
+void QueryBuilder::Select(std::unique_ptr<class Expression>&& exp,
+                          std::unique_ptr<class Expression>&& dense,
+                          DS bitmap) {
+   Select(move(exp), move(dense));
+   denseSelect = &static_cast<class Select&>(*operatorStack.top());
+   denseSelect->bitmap = static_cast<uint64_t*>(bitmap.data);
+}
+
 QueryBuilder::ProjectionBuilder QueryBuilder::Project() {
    auto project = make_unique<class Project>();
    auto p = project.get();
@@ -92,12 +120,39 @@ void QueryBuilder::FixedAggregation(std::unique_ptr<Aggregates>&& aggrs) {
    pushOperator(move(aggregation));
 }
 
+void QueryBuilder::FixedAggregation(std::unique_ptr<Aggregates>&& aggrs,
+                                    std::unique_ptr<Aggregates>&& dense) {
+   if (!denseSelect)
+      throw runtime_error("Dense aggregates need a selection into a bitmap");
+   FixedAggregation(move(aggrs));
+   auto& aggregation = static_cast<FixedAggr&>(*operatorStack.top());
+   aggregation.denseAggregates = move(*dense);
+   aggregation.denseInput = denseSelect;
+}
+
 QueryBuilder::ProjectionBuilder& QueryBuilder::ProjectionBuilder::addExpression(
     std::unique_ptr<class Expression>&& exp) {
+   if (project.denseInput)
+      throw runtime_error("All expressions of a dense projection need a "
+                          "dense variant");
    project.expressions.push_back(move(exp));
    return *this;
 }
 
+QueryBuilder::ProjectionBuilder& QueryBuilder::ProjectionBuilder::addExpression(
+    std::unique_ptr<class Expression>&& exp,
+    std::unique_ptr<class Expression>&& dense) {
+   if (!base.denseSelect)
+      throw runtime_error("Dense expressions need a selection into a bitmap");
+   if (project.denseExpressions.size() != project.expressions.size())
+      throw runtime_error("All expressions of a dense projection need a "
+                          "dense variant");
+   project.expressions.push_back(move(exp));
+   project.denseExpressions.push_back(move(dense));
+   project.denseInput = base.denseSelect;
+   return *this;
+}
+
 QueryBuilder::ExpressionBuilder QueryBuilder::Expression() {
    QueryBuilder::ExpressionBuilder b;
    b.expression = make_unique<class Expression>();
@@ -121,6 +176,12 @@ QueryBuilder::DS QueryBuilder::Buffer(size_t nr) {
    return r;
 }
 
+QueryBuilder::DS QueryBuilder::Bitmap(size_t nr) {
+   if (buffers.find(nr) == buffers.end())
+      buffers.emplace(nr, make_pair(sizeof(uint64_t), vecs.getBitmap()));
+   return Buffer(nr);
+}
+
 QueryBuilder::DS QueryBuilder::Column(ScanBuilder& scan,
                                       std::string attribute) {
    DS r;
@@ -129,6 +190,35 @@ QueryBuilder::DS QueryBuilder::Column(ScanBuilder& scan,
    r.dataSize = attr.type->rt_size();
    r.data = attr.data();
    r.scan = &scan.scan;
+   r.packed = attr.packed.get();
+   return r;
+}
+
+QueryBuilder::DS QueryBuilder::Codes(ScanBuilder& scan,
+                                     std::string attribute) {
+   DS r;
+   r.buf = DataStorage::BufferSpec::Column;
+   auto& attr = scan.rel[attribute];
+   if (!attr.dictionary)
+      throw std::runtime_error("Attribute " + attribute +
+                               " is not dictionary encoded");
+   r.dataSize = attr.dictionary->codeSize;
+   r.data = attr.dictionary->codes();
+   r.scan = &scan.scan;
+   return r;
+}
+
+QueryBuilder::DS QueryBuilder::Narrow(ScanBuilder& scan,
+                                      std::string attribute) {
+   DS r;
+   r.buf = DataStorage::BufferSpec::Column;
+   auto& attr = scan.rel[attribute];
+   if (!attr.narrow)
+      throw std::runtime_error("Attribute " + attribute +
+                               " has no narrow physical type");
+   r.dataSize = attr.narrow->width();
+   r.data = attr.narrow->values();
+   r.scan = &scan.scan;
    return r;
 }
 
@@ -154,7 +244,10 @@ void QueryBuilder::DataStorage::registerDS(void** location) {
       assert(location);
       assert(scan);
       assert(dataSize);
-      scan->addConsumer(location, dataSize);
+      if (packed)
+         scan->addPackedConsumer(location, packed);
+      else
+         scan->addConsumer(location, dataSize);
    }
 }
 
@@ -218,6 +311,11 @@ operator std::unique_ptr<vectorwise::Aggregates>() {
 
 QueryBuilder::HashJoinBuilder::HashJoinBuilder(QueryBuilder& b) : base(b) {}
 QueryBuilder::HashJoinBuilder::~HashJoinBuilder() {
+   if (join->mode == Hashjoin::Mode::RightOuter && !join->matchedOffset) {
+      // byte which marks build entries with partner
+      join->matchedOffset = join->ht_entry_size;
+      join->ht_entry_size += sizeof(uint8_t);
+   }
    join->ht_entry_size += padding(join->ht_entry_size, 8);
 }
 
@@ -239,6 +337,7 @@ QueryBuilder::HashJoin(DS probeMatches, pos_t (Hashjoin::*joinFun)()) {
    b.join->buildMatches = static_cast<runtime::Hashmap::EntryHeader**>(
        vecs.get(sizeof(runtime::Hashmap::EntryHeader*)));
    b.join->probeMatches = probeMatches;
+   b.join->probeOrder = static_cast<pos_t*>(vecs.get(sizeof(pos_t)));
    b.buildHashBuffer = vecs.get(sizeof(runtime::Hashmap::hash_t));
    b.probeHashBuffer = vecs.get(sizeof(runtime::Hashmap::hash_t));
 
@@ -265,6 +364,7 @@ QueryBuilder::HashJoinBuilder::addBuildKey(DS col, primitives::F2 hash,
    auto hash_build = make_unique<F2_Op>(buildHashBuffer, col, hash);
    col.registerDS(&hash_build->param1);
    join->buildHash.ops.push_back(move(hash_build));
+   checkFilterKeys();
 
    // build scatter
    auto scatter_build = make_unique<FScatterOp>(
@@ -288,6 +388,7 @@ QueryBuilder::HashJoinBuilder::addBuildKey(DS col, DS sel, primitives::F3 hash,
    sel.registerDS(&hash_build->outputSelectionV);
    col.registerDS(&hash_build->param2);
    join->buildHash.ops.push_back(move(hash_build));
+   checkFilterKeys();
 
    // build scatter
    auto scatter_build = make_unique<FScatterSelOp>(
@@ -311,6 +412,7 @@ QueryBuilder::HashJoinBuilder::addProbeKey(DS col, primitives::F2 hash,
    auto hash_probe = make_unique<F2_Op>(probeHashBuffer, col, hash);
    col.registerDS(&hash_probe->param1);
    join->probeHash.ops.push_back(move(hash_probe));
+   checkFilterKeys();
    join->probeHashes =
        reinterpret_cast<runtime::Hashmap::hash_t*>(probeHashBuffer);
 
@@ -337,6 +439,7 @@ QueryBuilder::HashJoinBuilder::addProbeKey(DS col, DS sel, primitives::F3 hash,
    sel.registerDS(&hash_probe->outputSelectionV);
    col.registerDS(&hash_probe->param2);
    join->probeHash.ops.push_back(move(hash_probe));
+   checkFilterKeys();
    join->probeHashes =
        reinterpret_cast<runtime::Hashmap::hash_t*>(probeHashBuffer);
 
@@ -360,6 +463,7 @@ QueryBuilder::HashJoinBuilder::addProbeKey(DS col, DS sel, primitives::F3 hash,
    sel.registerDS(&hash_probe->outputSelectionV);
    col.registerDS(&hash_probe->param2);
    join->probeHash.ops.push_back(move(hash_probe));
+   checkFilterKeys();
    join->probeHashes =
        reinterpret_cast<runtime::Hashmap::hash_t*>(probeHashBuffer);
 
@@ -429,6 +533,11 @@ QueryBuilder::HashJoinBuilder::pushProbeSelVector(DS sel, DS target) {
    if (probeHasSelection)
       throw runtime_error("Pushing a probe selection vector is in conflict "
                           "with first setting a probe selection vector.");
+   if (join->mode != Hashjoin::Mode::Inner &&
+       join->mode != Hashjoin::Mode::LeftSemi)
+      throw runtime_error("Probe selection vectors can only be pushed through "
+                          "inner and semi joins");
+   probeSelPushed = true;
    // add lookup to keys_equal
    auto lookup = move(base.Expression().addOp(
        primitives::lookup_sel, target, base.Value(join->probeMatches), sel));
@@ -436,6 +545,52 @@ QueryBuilder::HashJoinBuilder::pushProbeSelVector(DS sel, DS target) {
    return *this;
 }
 
+QueryBuilder::HashJoinBuilder& QueryBuilder::HashJoinBuilder::setPartitioning(
+    Hashjoin::Partitioning partitioning) {
+   join->partitioning = partitioning;
+   return *this;
+}
+
+QueryBuilder::HashJoinBuilder&
+QueryBuilder::HashJoinBuilder::addProbeFilter(DS col, primitives::F2 hash) {
+   if (col.buf != DataStorage::BufferSpec::Column)
+      throw runtime_error("Join filters can only be pushed into scans");
+   if (join->mode == Hashjoin::Mode::LeftAnti ||
+       join->mode == Hashjoin::Mode::LeftOuter)
+      throw runtime_error("Join filters would drop probes without partner");
+   join->buildFilter = true;
+   checkFilterKeys();
+   col.scan->addJoinFilter(&join->filter(), col.data, col.dataSize, hash);
+   return *this;
+}
+
+void QueryBuilder::HashJoinBuilder::checkFilterKeys() {
+   // the filter holds the combined hash of all keys
+   if (join->buildFilter &&
+       (join->buildHash.ops.size() > 1 || join->probeHash.ops.size() > 1))
+      throw runtime_error("Join filters only support joins with one key");
+}
+
+QueryBuilder::HashJoinBuilder&
+QueryBuilder::HashJoinBuilder::setMode(Hashjoin::Mode mode) {
+   if (mode != Hashjoin::Mode::Inner && mode != Hashjoin::Mode::LeftSemi &&
+       probeSelPushed)
+      throw runtime_error("Probe selection vectors can only be pushed through "
+                          "inner and semi joins");
+   if ((mode == Hashjoin::Mode::LeftAnti ||
+        mode == Hashjoin::Mode::LeftOuter) &&
+       join->buildFilter)
+      throw runtime_error("Join filters would drop probes without partner");
+   join->mode = mode;
+   return *this;
+}
+
+QueryBuilder::HashJoinBuilder&
+QueryBuilder::HashJoinBuilder::setMatchFlags(DS target) {
+   join->matchFlags = reinterpret_cast<int32_t*>(target.data);
+   return *this;
+}
+
 QueryBuilder::HashGroupBuilder::HashGroupBuilder(QueryBuilder& b) : base(b) {}
 
 QueryBuilder::HashGroupBuilder QueryBuilder::HashGroup() {
@@ -534,18 +689,258 @@ QueryBuilder::HashGroupBuilder::~HashGroupBuilder() {
    global.ht_entry_size += padding(local.ht_entry_size, 8);
 
    // create spillStorage for this thread
-   // use 8 * <number of workers> partitions
+   // use 4 * <number of workers> partitions, more for many expected groups
 
    // next pointer is not copied to spillStorage
    auto rowSize =
        local.ht_entry_size - sizeof(runtime::Hashmap::EntryHeader::next);
    // TODO: this seems wrong!
    auto& spill = op.shared.spillStorage.create(
-       runtime::this_worker->group->size * 4, rowSize);
+       runtime::grouping::partitions(op.expectedGroups,
+                                     runtime::this_worker->group->size),
+       rowSize);
    op.nrPartitions = spill.getPartitions().size();
    global.rowSize = rowSize;
 }
 
+QueryBuilder::MergeJoinBuilder QueryBuilder::MergeJoin(DS probeMatches) {
+   MergeJoinBuilder b(*this);
+   auto& s = operatorState.get<MergeJoin::Shared>(nextOpNr());
+   auto join = make_unique<class MergeJoin>(s);
+   b.join = join.get();
+   join->batchSize = vecs.getVecSize();
+   join->buildMatches = static_cast<uint8_t**>(vecs.get(sizeof(uint8_t*)));
+   join->probeMatches = probeMatches;
+   join->right = popOperator();
+   join->left = popOperator();
+   pushOperator(move(join));
+   return b;
+}
+
+QueryBuilder::MergeJoinBuilder::MergeJoinBuilder(QueryBuilder& b) : base(b) {}
+QueryBuilder::MergeJoinBuilder::~MergeJoinBuilder() {
+   if (!join->rowSize) join->rowSize = join->keySize;
+   join->rowSize += padding(join->rowSize, 8);
+}
+
+void QueryBuilder::MergeJoinBuilder::addKey(vectorwise::MergeJoin::Side& side,
+                                            DS col) {
+   if (join->rowSize)
+      throw std::runtime_error("MergeJoin keys must be added before values");
+   if (col.buf != DataStorage::BufferSpec::Column || col.packed)
+      throw std::runtime_error("MergeJoin keys must be unpacked columns");
+   if (side.scan && side.scan != col.scan)
+      throw std::runtime_error("MergeJoin keys of a side must be columns of "
+                               "one scan");
+   side.scan = col.scan;
+   side.keys.push_back({nullptr, nullptr,
+                        static_cast<const uint8_t*>(col.data), col.dataSize,
+                        side.keyBytes});
+   side.keyBytes += col.dataSize;
+   join->keySize = std::max(
+       join->keySize, side.keyBytes + padding(side.keyBytes, 8));
+}
+
+QueryBuilder::MergeJoinBuilder&
+QueryBuilder::MergeJoinBuilder::addBuildKey(DS col,
+                                            primitives::FScatter normalize) {
+   addKey(join->build, col);
+   join->build.keys.back().normalize = normalize;
+
+   auto op = make_unique<FScatterOp>(
+       normalize, col, reinterpret_cast<void**>(&join->scatterStart),
+       &join->rowSize, join->build.keys.back().offset);
+   col.registerDS(&op->get<0>());
+   join->buildScatter += move(op);
+   return *this;
+}
+
+QueryBuilder::MergeJoinBuilder& QueryBuilder::MergeJoinBuilder::addBuildKey(
+    DS col, DS sel, primitives::FScatterSel normalize) {
+   addKey(join->build, col);
+   join->build.keys.back().normalizeSel = normalize;
+
+   auto op = make_unique<FScatterSelOp>(
+       normalize, sel, col, reinterpret_cast<void**>(&join->scatterStart),
+       &join->rowSize, join->build.keys.back().offset);
+   col.registerDS(&op->get<1>());
+   join->buildScatter += move(op);
+   return *this;
+}
+QueryBuilder::MergeJoinBuilder&
+QueryBuilder::MergeJoinBuilder::addProbeKey(DS col,
+                                            primitives::FScatter normalize) {
+   if (join->probeSel)
+      throw std::runtime_error("Probe key without selection vector was "
+                               "added, but join uses selection vector");
+   addKey(join->probe, col);
+   join->probe.keys.back().normalize = normalize;
+
+   auto op = make_unique<FScatterOp>(
+       normalize, col, reinterpret_cast<void**>(&join->probeKeys),
+       &join->keySize, join->probe.keys.back().offset);
+   col.registerDS(&op->get<0>());
+   join->probeNormalize += move(op);
+   return *this;
+}
+
+QueryBuilder::MergeJoinBuilder& QueryBuilder::MergeJoinBuilder::addProbeKey(
+    DS col, DS sel, primitives::FScatterSel normalize) {
+   if (!join->probeSel)
+      throw std::runtime_error("Probe key with selection vector was added, "
+                               "but join doesn't use selection vector");
+   addKey(join->probe, col);
+   join->probe.keys.back().normalizeSel = normalize;
+
+   auto op = make_unique<FScatterSelOp>(
+       normalize, sel, col, reinterpret_cast<void**>(&join->probeKeys),
+       &join->keySize, join->probe.keys.back().offset);
+   col.registerDS(&op->get<1>());
+   join->probeNormalize += move(op);
+   return *this;
+}
+
+QueryBuilder::MergeJoinBuilder& QueryBuilder::MergeJoinBuilder::addBuildValue(
+    DS source, primitives::FScatter scatter, DS target,
+    primitives::FGather gather) {
+   if (!join->rowSize) join->rowSize = join->keySize;
+   auto rowOffset = join->rowSize;
+   join->rowSize += source.dataSize;
+
+   auto scatter_build = make_unique<FScatterOp>(
+       scatter, source, reinterpret_cast<void**>(&join->scatterStart),
+       &join->rowSize, rowOffset);
+   source.registerDS(&scatter_build->get<0>());
+   join->buildScatter += move(scatter_build);
+   auto gather_build = make_unique<GatherOpCol>(
+       gather, (void**)join->buildMatches, rowOffset, target);
+   join->buildGather.ops.push_back(move(gather_build));
+   return *this;
+}
+
+QueryBuilder::MergeJoinBuilder& QueryBuilder::MergeJoinBuilder::addBuildValue(
+    DS source, DS sel, primitives::FScatterSel scatter, DS target,
+    primitives::FGather gather) {
+   if (!join->rowSize) join->rowSize = join->keySize;
+   auto rowOffset = join->rowSize;
+   join->rowSize += source.dataSize;
+
+   auto scatter_build = make_unique<FScatterSelOp>(
+       scatter, sel, source, reinterpret_cast<void**>(&join->scatterStart),
+       &join->rowSize, rowOffset);
+   source.registerDS(&scatter_build->get<1>());
+   join->buildScatter += move(scatter_build);
+   auto gather_build = make_unique<GatherOpCol>(
+       gather, (void**)join->buildMatches, rowOffset, target);
+   join->buildGather.ops.push_back(move(gather_build));
+   return *this;
+}
+
+QueryBuilder::MergeJoinBuilder&
+QueryBuilder::MergeJoinBuilder::setProbeSelVector(DS sel) {
+   if (join->probeNormalize.ops.size())
+      throw std::runtime_error("Probe selection vector was added when probe "
+                               "keys were already present");
+   join->probeSel = sel;
+   return *this;
+}
+
+QueryBuilder::SortBuilder QueryBuilder::Sort() {
+   auto& s = operatorState.get<Sort::Shared>(nextOpNr());
+   return pushSort(make_unique<class Sort>(s));
+}
+
+QueryBuilder::SortBuilder QueryBuilder::TopK(size_t limit) {
+   auto& s = operatorState.get<Sort::Shared>(nextOpNr());
+   return pushSort(make_unique<class TopK>(s, limit));
+}
+
+QueryBuilder::SortBuilder
+QueryBuilder::pushSort(std::unique_ptr<class Sort>&& sort) {
+   SortBuilder b(*this);
+   b.sort = sort.get();
+   sort->vecSize = vecs.getVecSize();
+   sort->rowPtrs = static_cast<uint8_t**>(vecs.get(sizeof(uint8_t*)));
+   sort->child = popOperator();
+   pushOperator(move(sort));
+   return b;
+}
+
+QueryBuilder::SortBuilder::SortBuilder(QueryBuilder& b) : base(b) {}
+QueryBuilder::SortBuilder::~SortBuilder() {
+   if (!sort->rowSize) sort->rowSize = sort->keySize;
+   sort->rowSize += padding(sort->rowSize, 8);
+}
+
+QueryBuilder::SortBuilder&
+QueryBuilder::SortBuilder::addKey(DS col, primitives::FScatter normalize) {
+   if (sort->rowSize)
+      throw std::runtime_error("Sort keys must be added before values");
+   auto keyOffset = keyBytes;
+   keyBytes += col.dataSize;
+   sort->keySize = std::max(size_t(8), keyBytes + padding(keyBytes, 8));
+
+   auto op = make_unique<FScatterOp>(
+       normalize, col, reinterpret_cast<void**>(&sort->scatterStart),
+       &sort->rowSize, keyOffset);
+   col.registerDS(&op->get<0>());
+   sort->materialize += move(op);
+   return *this;
+}
+
+QueryBuilder::SortBuilder&
+QueryBuilder::SortBuilder::addKey(DS col, DS sel,
+                                  primitives::FScatterSel normalize) {
+   if (sort->rowSize)
+      throw std::runtime_error("Sort keys must be added before values");
+   auto keyOffset = keyBytes;
+   keyBytes += col.dataSize;
+   sort->keySize = std::max(size_t(8), keyBytes + padding(keyBytes, 8));
+
+   auto op = make_unique<FScatterSelOp>(
+       normalize, sel, col, reinterpret_cast<void**>(&sort->scatterStart),
+       &sort->rowSize, keyOffset);
+   col.registerDS(&op->get<1>());
+   sort->materialize += move(op);
+   return *this;
+}
+
+QueryBuilder::SortBuilder& QueryBuilder::SortBuilder::addValue(
+    DS source, primitives::FScatter scatter, DS target,
+    primitives::FGather gather) {
+   if (!sort->rowSize) sort->rowSize = sort->keySize;
+   auto rowOffset = sort->rowSize;
+   sort->rowSize += source.dataSize;
+
+   auto scatter_row = make_unique<FScatterOp>(
+       scatter, source, reinterpret_cast<void**>(&sort->scatterStart),
+       &sort->rowSize, rowOffset);
+   source.registerDS(&scatter_row->get<0>());
+   sort->materialize += move(scatter_row);
+   auto gather_row = make_unique<GatherOpCol>(
+       gather, (void**)sort->rowPtrs, rowOffset, target);
+   sort->gather.ops.push_back(move(gather_row));
+   return *this;
+}
+
+QueryBuilder::SortBuilder& QueryBuilder::SortBuilder::addValue(
+    DS source, DS sel, primitives::FScatterSel scatter, DS target,
+    primitives::FGather gather) {
+   if (!sort->rowSize) sort->rowSize = sort->keySize;
+   auto rowOffset = sort->rowSize;
+   sort->rowSize += source.dataSize;
+
+   auto scatter_row = make_unique<FScatterSelOp>(
+       scatter, sel, source, reinterpret_cast<void**>(&sort->scatterStart),
+       &sort->rowSize, rowOffset);
+   source.registerDS(&scatter_row->get<1>());
+   sort->materialize += move(scatter_row);
+   auto gather_row = make_unique<GatherOpCol>(
+       gather, (void**)sort->rowPtrs, rowOffset, target);
+   sort->gather.ops.push_back(move(gather_row));
+   return *this;
+}
+
 QueryBuilder::HashGroupBuilder& QueryBuilder::HashGroupBuilder::addKey(
     DS col, primitives::F2 hash,
     /**** global aggr *****/
@@ -784,6 +1179,12 @@ QueryBuilder::HashGroupBuilder& QueryBuilder::HashGroupBuilder::addValue(
    return *this;
 }
 
+QueryBuilder::HashGroupBuilder&
+QueryBuilder::HashGroupBuilder::expectGroups(size_t groups) {
+   group->expectGroups(groups);
+   return *this;
+}
+
 QueryBuilder::HashGroupBuilder&
 QueryBuilder::HashGroupBuilder::pushKeySelVec(DS sel, DS outBuf) {
    // add lookup to keys_equal
@@ -0,0 +1,105 @@
+#include "vectorwise/VectorSizeTuner.hpp"
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <unistd.h>
+
+namespace vectorwise {
+
+unsigned tuneVectorSizes = 0;
+
+namespace {
+struct SizeStats {
+   /// Number of pipelines per initial and per final vector size
+   std::map<size_t, uint64_t> initial;
+   std::map<size_t, uint64_t> final;
+};
+std::mutex vectorSizeReportMutex;
+std::map<std::string, SizeStats> vectorSizeReport;
+
+void printSizes(std::ostream& out, const std::map<size_t, uint64_t>& sizes) {
+   for (auto& size : sizes)
+      out << " " << size.first << " (" << size.second << "x)";
+}
+} // namespace
+
+void printVectorSizeReport(std::ostream& out) {
+   std::lock_guard<std::mutex> lock(vectorSizeReportMutex);
+   for (auto& pipeline : vectorSizeReport) {
+      out << "vector size " << pipeline.first << ": initial";
+      printSizes(out, pipeline.second.initial);
+      out << ", final";
+      printSizes(out, pipeline.second.final);
+      out << std::endl;
+   }
+}
+
+VectorSizeTuner::VectorSizeTuner(std::string n, size_t c, bool o)
+    : name(std::move(n)), capacity(c), online(o) {}
+
+VectorSizeTuner::~VectorSizeTuner() {
+   if (!initial) return;
+   std::lock_guard<std::mutex> lock(vectorSizeReportMutex);
+   auto& stats = vectorSizeReport[name];
+   stats.initial[initial]++;
+   stats.final[phase == Phase::Probe ? bestSize : current]++;
+}
+
+size_t VectorSizeTuner::l2Bytes() {
+   static const size_t bytes = [] {
+      long l2 = 0;
+#ifdef _SC_LEVEL2_CACHE_SIZE
+      // glibc only, other platforms take the default
+      l2 = sysconf(_SC_LEVEL2_CACHE_SIZE);
+#endif
+      return l2 > 0 ? size_t(l2) : size_t(1) << 20;
+   }();
+   return bytes;
+}
+
+size_t VectorSizeTuner::fitting(size_t tupleBytes, size_t capacity) {
+   auto budget = l2Bytes() / 2;
+   size_t size = minSize;
+   while (size * 2 <= capacity && size * 2 * tupleBytes <= budget) size *= 2;
+   return std::min(size, capacity);
+}
+
+void VectorSizeTuner::start(size_t tupleBytes) {
+   initial = current = fitting(tupleBytes, capacity);
+   if (!online) phase = Phase::Settled;
+}
+
+bool VectorSizeTuner::probeNext() {
+   auto next = growing ? bestSize * 2 : bestSize / 2;
+   if (next < minSize || next > capacity) return false;
+   current = next;
+   phase = Phase::Probe;
+   return true;
+}
+
+void VectorSizeTuner::measured(size_t n, uint64_t c) {
+   if (phase == Phase::Settled) return;
+   tuples += n;
+   cycles += c;
+   if (++vectors < window) return;
+   auto cost = double(cycles) / std::max<uint64_t>(tuples, 1);
+   vectors = tuples = cycles = 0;
+   if (phase == Phase::Measure || cost < bestCost * 0.95) {
+      // the first improvement fixes the direction
+      if (phase == Phase::Probe) triedOtherDirection = true;
+      bestSize = current;
+      bestCost = cost;
+      if (probeNext()) return;
+   } else {
+      current = bestSize;
+   }
+   if (!triedOtherDirection) {
+      triedOtherDirection = true;
+      growing = !growing;
+      if (probeNext()) return;
+   }
+   current = bestSize;
+   phase = Phase::Settled;
+}
+} // namespace vectorwise
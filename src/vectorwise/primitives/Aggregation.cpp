@@ -14,6 +14,8 @@ namespace primitives {
 
 #define MK_AGGR_STATIC_SEL_COL(type, op)                                       \
    F3 aggr_static_sel_##op##_##type##_col = (F3)&aggr_static_sel_col<type, op>;
+#define MK_AGGR_STATIC_BM_COL(type, op)                                        \
+   F3 aggr_static_bm_##op##_##type##_col = (F3)&aggr_static_bm_col<type, op>;
 #define MK_AGGR_COL(type, op)                                                  \
    FAggr aggr_##op##_##type##_col = (FAggr)&aggr_col<type, op>;
 #define MK_AGGR_SEL_COL(type, op)                                              \
@@ -31,6 +33,15 @@ pos_t aggr_static_count_star_(pos_t n, int64_t* RES result)
 }
 F1 aggr_static_count_star = (F1)&aggr_static_count_star_;
 
+pos_t aggr_static_bm_count_star_(pos_t n, int64_t* RES result,
+                                 uint64_t* RES bitmap)
+/// count the tuples selected by bitmap
+{
+   *result += countSelected(n, bitmap);
+   return n > 0;
+}
+F2 aggr_static_bm_count_star = (F2)&aggr_static_bm_count_star_;
+
 pos_t aggr_count_star_(pos_t n, int64_t* RES entries[], void* RES /*param1*/,
                        size_t offset)
 /// update count aggregates for each entry pointed to by entries
@@ -45,6 +56,7 @@ FAggr aggr_count_star = (FAggr)&aggr_count_star_;
 
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_STATIC_COL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_STATIC_SEL_COL)
+EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_STATIC_BM_COL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_COL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_SEL_COL)
 EACH_ARITH(EACH_TYPE_FULL, MK_AGGR_ROW)
@@ -0,0 +1,108 @@
+#include "common/runtime/Cpu.hpp"
+#include "vectorwise/Primitives.hpp"
+#include <deque>
+
+namespace vectorwise {
+namespace primitives {
+
+#define ADD_SEL_FLAVORS(type, op)                                              \
+   add("sel_" #op "_" #type "_col_" #type "_col",                              \
+       {{(void*)sel_##op##_##type##_col_##type##_col, "branching"},            \
+        {(void*)sel_##op##_##type##_col_##type##_col_bf, "branch free"}});     \
+   add("sel_" #op "_" #type "_col_" #type "_val",                              \
+       {{(void*)sel_##op##_##type##_col_##type##_val, "branching"},            \
+        {(void*)sel_##op##_##type##_col_##type##_val_bf, "branch free"}});     \
+   add("selsel_" #op "_" #type "_col_" #type "_col",                           \
+       {{(void*)selsel_##op##_##type##_col_##type##_col, "branching"},         \
+        {(void*)selsel_##op##_##type##_col_##type##_col_bf, "branch free"}});  \
+   add("selsel_" #op "_" #type "_col_" #type "_val",                           \
+       {{(void*)selsel_##op##_##type##_col_##type##_val, "branching"},         \
+        {(void*)selsel_##op##_##type##_col_##type##_val_bf, "branch free"}});
+
+/// Groups by each of their implementations, built on first use, when all
+/// primitives are initialized
+static const std::unordered_map<void*, const FlavorGroup*>& flavorGroups() {
+   static std::deque<FlavorGroup> groups;
+   static const auto byPrimitive = [] {
+      std::unordered_map<void*, const FlavorGroup*> index;
+      auto add = [&](std::string name,
+                     std::vector<std::pair<void*, std::string>> flavors) {
+         groups.push_back({move(name), move(flavors)});
+         for (auto& flavor : groups.back().flavors)
+            index[flavor.first] = &groups.back();
+      };
+      // adds the SIMD flavor the cpu supports to the group of primitive
+      auto addSimd = [&](void* primitive, void* avx512, void* avx2) {
+         auto isa = runtime::cpu::isa();
+         auto simd = isa == runtime::cpu::Isa::AVX512
+                         ? avx512
+                         : isa == runtime::cpu::Isa::AVX2 ? avx2 : primitive;
+         // some primitives have no variant for AVX2
+         if (simd == primitive) return;
+         auto& group = const_cast<FlavorGroup&>(*index.at(primitive));
+         group.flavors.emplace_back(simd, runtime::cpu::name(isa));
+         index[simd] = &group;
+      };
+      EACH_COMP(EACH_TYPE, ADD_SEL_FLAVORS)
+      add("hash_int32_t_col", {{(void*)hash_int32_t_col, "scalar"}});
+      add("hash_sel_int32_t_col", {{(void*)hash_sel_int32_t_col, "scalar"}});
+      add("rehash_int32_t_col", {{(void*)rehash_int32_t_col, "scalar"}});
+      add("rehash_sel_int32_t_col",
+          {{(void*)rehash_sel_int32_t_col, "scalar"}});
+      add("proj_sel_minus_int64_t_val_int64_t_col",
+          {{(void*)proj_sel_minus_int64_t_val_int64_t_col, "scalar"}});
+      add("proj_sel_plus_int64_t_col_int64_t_val",
+          {{(void*)proj_sel_plus_int64_t_col_int64_t_val, "scalar"}});
+      add("proj_multiplies_int64_t_col_int64_t_col",
+          {{(void*)proj_multiplies_int64_t_col_int64_t_col, "scalar"}});
+      add("proj_multiplies_sel_int64_t_col_int64_t_col",
+          {{(void*)proj_multiplies_sel_int64_t_col_int64_t_col, "scalar"}});
+      addSimd((void*)hash_int32_t_col, (void*)hash4_int32_t_col,
+              (void*)hash4_int32_t_col_avx2);
+      addSimd((void*)hash_sel_int32_t_col, (void*)hash4_sel_int32_t_col,
+              (void*)hash4_sel_int32_t_col_avx2);
+      addSimd((void*)rehash_int32_t_col, (void*)rehash4_int32_t_col,
+              (void*)rehash4_int32_t_col_avx2);
+      addSimd((void*)rehash_sel_int32_t_col, (void*)rehash4_sel_int32_t_col,
+              (void*)rehash4_sel_int32_t_col_avx2);
+      addSimd((void*)proj_sel_minus_int64_t_val_int64_t_col,
+              (void*)proj_sel8_minus_int64_t_val_int64_t_col,
+              (void*)proj_sel4_minus_int64_t_val_int64_t_col_avx2);
+      addSimd((void*)proj_sel_plus_int64_t_col_int64_t_val,
+              (void*)proj_sel8_plus_int64_t_col_int64_t_val,
+              (void*)proj_sel4_plus_int64_t_col_int64_t_val_avx2);
+      addSimd((void*)proj_multiplies_int64_t_col_int64_t_col,
+              (void*)proj8_multiplies_int64_t_col_int64_t_col,
+              (void*)proj4_multiplies_int64_t_col_int64_t_col_avx2);
+      addSimd((void*)proj_multiplies_sel_int64_t_col_int64_t_col,
+              (void*)proj8_multiplies_sel_int64_t_col_int64_t_col,
+              (void*)proj4_multiplies_sel_int64_t_col_int64_t_col_avx2);
+      addSimd((void*)sel_less_int32_t_col_int32_t_val,
+              (void*)sel_less_int32_t_col_int32_t_val_avx512,
+              (void*)sel_less_int32_t_col_int32_t_val_avx2);
+      addSimd((void*)selsel_greater_equal_int32_t_col_int32_t_val,
+              (void*)selsel_greater_equal_int32_t_col_int32_t_val_avx512,
+              (void*)selsel_greater_equal_int32_t_col_int32_t_val_avx2);
+      addSimd((void*)selsel_greater_equal_int64_t_col_int64_t_val,
+              (void*)selsel_greater_equal_int64_t_col_int64_t_val_avx512,
+              (void*)selsel_greater_equal_int64_t_col_int64_t_val_avx2);
+      addSimd((void*)selsel_less_int64_t_col_int64_t_val,
+              (void*)selsel_less_int64_t_col_int64_t_val_avx512,
+              (void*)selsel_less_int64_t_col_int64_t_val_avx2);
+      addSimd((void*)selsel_less_equal_int64_t_col_int64_t_val,
+              (void*)selsel_less_equal_int64_t_col_int64_t_val_avx512,
+              (void*)selsel_less_equal_int64_t_col_int64_t_val_avx2);
+      return index;
+   }();
+   return byPrimitive;
+}
+
+const FlavorGroup* flavorsOf(void* f) {
+   auto& groups = flavorGroups();
+   auto group = groups.find(f);
+   if (group == groups.end() || group->second->flavors.size() < 2)
+      return nullptr;
+   return group->second;
+}
+} // namespace primitives
+} // namespace vectorwise
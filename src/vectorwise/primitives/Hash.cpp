@@ -30,13 +30,8 @@ EACH_TYPE(NIL, MK_REHASH)
 EACH_TYPE(NIL, MK_REHASH_SEL)
 
 // SIMD hashes
-#ifdef __AVX512F__
 #if HASH_SIZE != 32
 
-#ifndef __AVX512DQ__
-static_assert(false, "On this platform only 32-bit hashes are supported.");
-#endif
-
 F2 hash8_int64_t_col = (F2)&hash8<int64_t, DEFAULT_HASH>;
 // F3 hash8_sel_int64_t_col = (F3)&hash8_sel<int64_t, DEFAULT_HASH>;
 // F2 rehash8_int64_t_col = (F2)&rehash8<int64_t, DEFAULT_HASH>;
@@ -46,15 +41,19 @@ F2 hash8_int64_t_col = (F2)&hash8<int64_t, DEFAULT_HASH>;
  * This variant is a workaround for bad code generation of gcc. It is semantically equivalent
  * to hash4_sel<int32_t, DEFAULT_HASH>
  */
-pos_t hash4_selASM(pos_t n, pos_t* RES inSel, hash_t* RES result, int32_t* RES input)
+SIMD_AVX512 pos_t hash4_selASM(pos_t n, pos_t* RES inSel, hash_t* RES result, int32_t* RES input)
 /// compute hash for input column
 {
   size_t rest = n % 8;
   Vec8u seeds(seed);
-  asm(
+  // the loop advances the pointers and runs at least once, up to n - rest
+  auto sel = inSel;
+  auto out = result;
+  if (n >= 8)
+  asm volatile(
     "movabsq	$29875498475984, %%r8;"
     "vpbroadcastq	%%r8, %%zmm6;"
-    "leaq	64(%2,%3), %%r11;"
+    "leaq	(%1,%3), %%r11;"
     "movl	$-1, %%r8d;"
     "kmovb	%%r8d, %%k1;"
     "movabsq	$-4132994306676758123, %%r8;"
@@ -70,9 +69,9 @@ pos_t hash4_selASM(pos_t n, pos_t* RES inSel, hash_t* RES result, int32_t* RES i
     ".Hash4SelInner:;"
     "vmovdqu32	(%0), %%ymm1;"
     "kmovb	%%k1, %%k2;"
-    "addq	$64, %2;"
+    "addq	$64, %1;"
     "addq	$32, %0;"
-    "vpgatherdd	(%1,%%ymm1,4), %%ymm0%{%%k2%};"
+    "vpgatherdd	(%2,%%ymm1,4), %%ymm0%{%%k2%};"
     "vpmovzxdq	%%ymm0, %%zmm0;"
     "vpmullq	%%zmm2, %%zmm0, %%zmm1;"
     "vpsrlvq	%%zmm3, %%zmm1, %%zmm7;"
@@ -86,22 +85,21 @@ pos_t hash4_selASM(pos_t n, pos_t* RES inSel, hash_t* RES result, int32_t* RES i
     "vpmullq	%%zmm2, %%zmm14, %%zmm15;"
     "vpsrlvq	%%zmm3, %%zmm15, %%zmm16;"
     "vpxorq	%%zmm15, %%zmm16, %%zmm17;"
-    "vmovdqu64	%%zmm17, -64(%2);"
-    "cmpq	%%r11, %2;"
+    "vmovdqu64	%%zmm17, -64(%1);"
+    "cmpq	%%r11, %1;"
     "jne	.Hash4SelInner;"
-    ::
-     "r"(inSel), // pointer to selection vector
-     "r"(input), // pointer to data for gathering
-     "r"(result), // pointer to output vector
-     "r"((n-rest)*8)
-    : "k1", "k2", "r11", "r10", "r8","ymm1",
+    : "+r"(sel), // pointer to selection vector
+      "+r"(out) // pointer to output vector
+    : "r"(input), // pointer to data for gathering
+      "r"((n-rest)*8)
+    : "memory", "k1", "k2", "r11", "r10", "r8","ymm1",
       "zmm0", "zmm1","zmm2","zmm3","zmm4", "zmm5", "zmm6",
       "zmm7", "zmm8","zmm9","zmm10","zmm11", "zmm12", "zmm13",
       "zmm14", "zmm15","zmm16","zmm17");
 
   if(rest){
     __mmask16 remaining = (1 << rest) - 1;
-    auto inSels = _mm256_loadu_si256((const __m256i *)(inSel + n - rest));//ignore mask here?
+    auto inSels = _mm256_maskz_loadu_epi32(remaining, inSel + n - rest);
     Vec8u in = _mm512_cvtepu32_epi64(_mm256_mmask_i32gather_epi32(inSels, remaining, inSels, input, 4));
     auto hashes = DEFAULT_HASH().hashKey(in, seeds);
     _mm512_mask_storeu_epi64(result + n - rest, remaining, hashes);
@@ -123,6 +121,19 @@ F2 rehash4_int32_t_col = (F2)&rehash4_16<int32_t, DEFAULT_HASH>;
 F3 rehash4_sel_int32_t_col = (F3)&rehash4_16_sel<int32_t, DEFAULT_HASH>;
 
 #endif
+
+#if HASH_SIZE != 32
+F2 hash4_int32_t_col_avx2 = (F2)&hash4_avx2<int32_t, DEFAULT_HASH>;
+F3 hash4_sel_int32_t_col_avx2 = (F3)&hash4_sel_avx2<int32_t, DEFAULT_HASH>;
+F2 rehash4_int32_t_col_avx2 = (F2)&rehash4_avx2<int32_t, DEFAULT_HASH>;
+F3 rehash4_sel_int32_t_col_avx2 =
+    (F3)&rehash4_sel_avx2<int32_t, DEFAULT_HASH>;
+#else
+// no AVX2 variant of the 32 bit hash yet
+F2 hash4_int32_t_col_avx2 = (F2)&hash<int32_t, DEFAULT_HASH>;
+F3 hash4_sel_int32_t_col_avx2 = (F3)&hash_sel<int32_t, DEFAULT_HASH>;
+F2 rehash4_int32_t_col_avx2 = (F2)&rehash<int32_t, DEFAULT_HASH>;
+F3 rehash4_sel_int32_t_col_avx2 = (F3)&rehash_sel<int32_t, DEFAULT_HASH>;
 #endif
 }
 }
@@ -41,6 +41,13 @@ namespace primitives {
    F4 proj_sel_##op##_##type##_val_##type##_col =                              \
        (F4)&proj_sel_val_col<type, op>;
 
+#define MK_PROJ_BM_COLCOL(type, op)                                            \
+   F4 proj_bm_##op##_##type##_col_##type##_col =                               \
+       (F4)&proj_bm_col_col<type, op>;
+#define MK_PROJ_BM_COLVAL(type, op)                                            \
+   F4 proj_bm_##op##_##type##_col_##type##_val =                               \
+       (F4)&proj_bm_col_val<type, op>;
+
 pos_t lookup_sel_(pos_t n, pos_t* target, pos_t* sel, pos_t* source) {
    for (size_t i = 0; i < n; ++i) target[i] = source[sel[i]];
    return n;
@@ -53,6 +60,11 @@ template <typename int64_t> struct ExtractYear {
 F2 apply_extract_year_col = (F2)&apply_col<Date, Integer, ExtractYear>;
 F3 apply_extract_year_sel_col = (F3)&apply_sel_col<Date, Integer, ExtractYear>;
 
+#define MK_WIDEN(narrow, wide)                                                 \
+   F3 widen_##narrow##_col_##wide = (F3)&widen_col<narrow, wide>;              \
+   F4 widen_sel_##narrow##_col_##wide = (F4)&widen_sel_col<narrow, wide>;
+EACH_NARROW(MK_WIDEN)
+
 EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_COLCOL)
 EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_COLVAL) // with second arg const
 EACH_ARITH(EACH_TYPE_FULL,
@@ -66,11 +78,11 @@ EACH_ARITH(EACH_TYPE_FULL,
            MK_PROJ_SEL_COLVAL) // with above and second arg const
 EACH_ARITH_NON_COMM(EACH_TYPE_FULL, MK_PROJ_VALCOL)
 EACH_ARITH_NON_COMM(EACH_TYPE_FULL, MK_PROJ_SEL_VALCOL)
+EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_BM_COLCOL) // with input bitmap
+EACH_ARITH(EACH_TYPE_FULL, MK_PROJ_BM_COLVAL)
 
 
-#ifdef __AVX512F__
-
-pos_t proj_sel8_minus_int64_t_val_int64_t_col_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
+SIMD_AVX512 pos_t proj_sel8_minus_int64_t_val_int64_t_col_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
                                               int64_t* RES param2){
   size_t rest = n % 8;
   const auto constant = *param1;
@@ -87,7 +99,7 @@ pos_t proj_sel8_minus_int64_t_val_int64_t_col_impl(pos_t n, pos_t* RES inSel, in
   }
   return n;
 }
-pos_t proj_sel8_plus_int64_t_col_int64_t_val_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
+SIMD_AVX512 pos_t proj_sel8_plus_int64_t_col_int64_t_val_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
                                         int64_t* RES param2){
   size_t rest = n % 8;
   const auto constant = *param2;
@@ -107,11 +119,9 @@ pos_t proj_sel8_plus_int64_t_col_int64_t_val_impl(pos_t n, pos_t* RES inSel, int
 
 F4 proj_sel8_minus_int64_t_val_int64_t_col = (F4)&proj_sel8_minus_int64_t_val_int64_t_col_impl;
 F4 proj_sel8_plus_int64_t_col_int64_t_val = (F4)&proj_sel8_plus_int64_t_col_int64_t_val_impl;
-#endif
 
 
-#ifdef __AVX512DQ__
-pos_t proj8_multiplies_int64_t_col_int64_t_col_impl(pos_t n, int64_t* RES result,
+SIMD_AVX512 pos_t proj8_multiplies_int64_t_col_int64_t_col_impl(pos_t n, int64_t* RES result,
                                               int64_t* RES param1, int64_t* RES param2){
   size_t rest = n % 8;
   for (uint64_t i = 0; i < n - rest; i += 8){
@@ -123,7 +133,7 @@ pos_t proj8_multiplies_int64_t_col_int64_t_col_impl(pos_t n, int64_t* RES result
   for (uint64_t i = n-rest; i < n; ++i) result[i] = param1[i] * param2[i];
   return n;
 };
-pos_t proj8_multiplies_sel_int64_t_col_int64_t_col_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
+SIMD_AVX512 pos_t proj8_multiplies_sel_int64_t_col_int64_t_col_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
                                                     int64_t* RES param2){
   size_t rest = n % 8;
   for (uint64_t i = 0; i < n - rest; i += 8){
@@ -142,6 +152,74 @@ pos_t proj8_multiplies_sel_int64_t_col_int64_t_col_impl(pos_t n, pos_t* RES inSe
 
 F3 proj8_multiplies_int64_t_col_int64_t_col = (F3)&proj8_multiplies_int64_t_col_int64_t_col_impl;
 F4 proj8_multiplies_sel_int64_t_col_int64_t_col = (F4)&proj8_multiplies_sel_int64_t_col_int64_t_col_impl;
-#endif
+
+
+SIMD_AVX2 pos_t proj_sel4_minus_int64_t_val_int64_t_col_avx2_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
+                                                   int64_t* RES param2){
+  size_t rest = n % 4;
+  const auto constant = *param1;
+  Vec4u consts(constant);
+  for (uint64_t i = 0; i < n - rest; i += 4){
+    auto idxs = _mm_loadu_si128((const __m128i*)(inSel + i));
+    Vec4u in = _mm256_i32gather_epi64((const long long int*)param2, idxs, 8);
+    auto res = consts - in;
+    _mm256_storeu_si256((__m256i*)(result + i), res);
+  }
+  for (uint64_t i = n-rest; i < n; ++i) {
+    const auto idx = inSel[i];
+    result[i] = constant - param2[idx];
+  }
+  return n;
+}
+SIMD_AVX2 pos_t proj_sel4_plus_int64_t_col_int64_t_val_avx2_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
+                                                  int64_t* RES param2){
+  size_t rest = n % 4;
+  const auto constant = *param2;
+  Vec4u consts(constant);
+  for (uint64_t i = 0; i < n - rest; i += 4){
+    auto idxs = _mm_loadu_si128((const __m128i*)(inSel + i));
+    Vec4u in = _mm256_i32gather_epi64((const long long int*)param1, idxs, 8);
+    auto res = consts + in;
+    _mm256_storeu_si256((__m256i*)(result + i), res);
+  }
+  for (uint64_t i = n-rest; i < n; ++i) {
+    const auto idx = inSel[i];
+    result[i] = constant + param1[idx];
+  }
+  return n;
+}
+SIMD_AVX2 pos_t proj4_multiplies_int64_t_col_int64_t_col_avx2_impl(pos_t n, int64_t* RES result,
+                                                    int64_t* RES param1, int64_t* RES param2){
+  size_t rest = n % 4;
+  for (uint64_t i = 0; i < n - rest; i += 4){
+    Vec4u in1(param1 + i);
+    Vec4u in2(param2 + i);
+    auto res = in1 * in2;
+    _mm256_storeu_si256((__m256i*)(result + i), res);
+  }
+  for (uint64_t i = n-rest; i < n; ++i) result[i] = param1[i] * param2[i];
+  return n;
+}
+SIMD_AVX2 pos_t proj4_multiplies_sel_int64_t_col_int64_t_col_avx2_impl(pos_t n, pos_t* RES inSel, int64_t* RES result, int64_t* RES param1,
+                                                        int64_t* RES param2){
+  size_t rest = n % 4;
+  for (uint64_t i = 0; i < n - rest; i += 4){
+    auto idxs = _mm_loadu_si128((const __m128i*)(inSel + i));
+    Vec4u in1 = _mm256_i32gather_epi64((const long long int*)param1, idxs, 8);
+    Vec4u in2(param2 + i);
+    auto res = in1 * in2;
+    _mm256_storeu_si256((__m256i*)(result + i), res);
+  }
+  for (uint64_t i = n-rest; i < n; ++i) {
+    const auto idx = inSel[i];
+    result[i] = param1[idx] * param2[i];
+  }
+  return n;
+}
+
+F4 proj_sel4_minus_int64_t_val_int64_t_col_avx2 = (F4)&proj_sel4_minus_int64_t_val_int64_t_col_avx2_impl;
+F4 proj_sel4_plus_int64_t_col_int64_t_val_avx2 = (F4)&proj_sel4_plus_int64_t_col_int64_t_val_avx2_impl;
+F3 proj4_multiplies_int64_t_col_int64_t_col_avx2 = (F3)&proj4_multiplies_int64_t_col_int64_t_col_avx2_impl;
+F4 proj4_multiplies_sel_int64_t_col_int64_t_col_avx2 = (F4)&proj4_multiplies_sel_int64_t_col_int64_t_col_avx2_impl;
 }
 }
@@ -24,6 +24,13 @@ namespace primitives {
    FGatherSel gather_sel_col_##type##_col = (FGatherSel)&gather_sel_col<type>;
 #define MK_GATHER_VAL(type)                                                    \
    FGatherVal gather_val_##type##_col = (FGatherVal)&gather_val<type>;
+#define MK_NORMALIZE(type)                                                     \
+   FScatter normalize_##type##_col = (FScatter)&normalize<type, false>;        \
+   FScatter normalize_desc_##type##_col = (FScatter)&normalize<type, true>;    \
+   FScatterSel normalize_sel_##type##_col =                                    \
+       (FScatterSel)&normalize_sel<type, false>;                               \
+   FScatterSel normalize_sel_desc_##type##_col =                               \
+       (FScatterSel)&normalize_sel<type, true>;
 
 EACH_TYPE(NIL, MK_SCATTER)
 EACH_TYPE(NIL, MK_SCATTER_SEL)
@@ -32,5 +39,6 @@ EACH_TYPE(NIL, MK_SCATTER_SEL_ROW)
 EACH_TYPE(NIL, MK_GATHER_COL)
 EACH_TYPE(NIL, MK_GATHER_SEL_COL)
 EACH_TYPE(NIL, MK_GATHER_VAL)
+EACH_TYPE(NIL, MK_NORMALIZE)
 }
 }
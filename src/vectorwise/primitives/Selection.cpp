@@ -1,3 +1,4 @@
+#include "common/runtime/BloomFilter.hpp"
 #include "common/runtime/Hash.hpp"
 #include "common/runtime/SIMD.hpp"
 #include "vectorwise/Operations.hpp"
@@ -62,14 +63,32 @@ template <typename T> struct Contains {
 F3 sel_contains_Varchar_55_col_Varchar_55_val =
     (F3)&sel_col_val<Varchar_55, Contains>;
 
-#ifdef __AVX512F__
+pos_t sel_bloom_hash_t_col_(pos_t n, pos_t* RES result, hash_t* RES hashes,
+                            const runtime::BloomFilter* filter) {
+   uint64_t found = 0;
+   for (uint64_t i = 0; i < n; ++i)
+      if (filter->contains(hashes[i])) result[found++] = i;
+   return found;
+}
+F3 sel_bloom_hash_t_col = (F3)&sel_bloom_hash_t_col_;
+
+pos_t selsel_bloom_hash_t_col_(pos_t n, pos_t* RES inSel, pos_t* RES result,
+                               hash_t* RES hashes,
+                               const runtime::BloomFilter* filter) {
+   uint64_t found = 0;
+   for (uint64_t i = 0; i < n; ++i) {
+      auto idx = inSel[i];
+      if (filter->contains(hashes[idx])) result[found++] = idx;
+   }
+   return found;
+}
+F4 selsel_bloom_hash_t_col = (F4)&selsel_bloom_hash_t_col_;
 
 // #define PREFETCH(E) __builtin_prefetch(E);
 #define PREFETCH(E)
 
-pos_t sel_less_int32_t_col_int32_t_val_avx512_impl(pos_t n, pos_t* RES result,
-                                                   int32_t* RES param1,
-                                                   int32_t* RES param2) {
+SIMD_AVX512 pos_t sel_less_int32_t_col_int32_t_val_avx512_impl(
+    pos_t n, pos_t* RES result, int32_t* RES param1, int32_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
                  "This implementation only supports sizeof(pos_t) == 4");
    uint64_t found = 0;
@@ -92,7 +111,7 @@ pos_t sel_less_int32_t_col_int32_t_val_avx512_impl(pos_t n, pos_t* RES result,
 
 const size_t lead = 16;
 
-pos_t selsel_greater_equal_int32_t_col_int32_t_val_avx512_impl(
+SIMD_AVX512 pos_t selsel_greater_equal_int32_t_col_int32_t_val_avx512_impl(
     pos_t n, pos_t* RES inSel, pos_t* RES result, int32_t* RES param1,
     int32_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
@@ -117,12 +136,9 @@ pos_t selsel_greater_equal_int32_t_col_int32_t_val_avx512_impl(
    return found;
 }
 
-#ifdef __AVX512VL__
-
-pos_t selsel_less_int64_t_col_int64_t_val_avx512_impl(pos_t n, pos_t* RES inSel,
-                                                      pos_t* RES result,
-                                                      int64_t* RES param1,
-                                                      int64_t* RES param2) {
+SIMD_AVX512 pos_t selsel_less_int64_t_col_int64_t_val_avx512_impl(
+    pos_t n, pos_t* RES inSel, pos_t* RES result, int64_t* RES param1,
+    int64_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
                  "This implementation only supports sizeof(pos_t) == 4");
 
@@ -145,7 +161,7 @@ pos_t selsel_less_int64_t_col_int64_t_val_avx512_impl(pos_t n, pos_t* RES inSel,
    return found;
 }
 
-pos_t selsel_greater_equal_int64_t_col_int64_t_val_avx512_impl(
+SIMD_AVX512 pos_t selsel_greater_equal_int64_t_col_int64_t_val_avx512_impl(
     pos_t n, pos_t* RES inSel, pos_t* RES result, int64_t* RES param1,
     int64_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
@@ -170,7 +186,7 @@ pos_t selsel_greater_equal_int64_t_col_int64_t_val_avx512_impl(
    return found;
 }
 
-pos_t selsel_less_equal_int64_t_col_int64_t_val_avx512_impl(
+SIMD_AVX512 pos_t selsel_less_equal_int64_t_col_int64_t_val_avx512_impl(
     pos_t n, pos_t* RES inSel, pos_t* RES result, int64_t* RES param1,
     int64_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
@@ -195,136 +211,337 @@ pos_t selsel_less_equal_int64_t_col_int64_t_val_avx512_impl(
    return found;
 }
 
-#else
+F3 sel_less_int32_t_col_int32_t_val_avx512 =
+    (F3)&sel_less_int32_t_col_int32_t_val_avx512_impl;
+F4 selsel_greater_equal_int32_t_col_int32_t_val_avx512 =
+    (F4)&selsel_greater_equal_int32_t_col_int32_t_val_avx512_impl;
+F4 selsel_less_int64_t_col_int64_t_val_avx512 =
+    (F4)&selsel_less_int64_t_col_int64_t_val_avx512_impl;
+F4 selsel_greater_equal_int64_t_col_int64_t_val_avx512 =
+    (F4)&selsel_greater_equal_int64_t_col_int64_t_val_avx512_impl;
+F4 selsel_less_equal_int64_t_col_int64_t_val_avx512 =
+    (F4)&selsel_less_equal_int64_t_col_int64_t_val_avx512_impl;
+
+/// Stores the lanes of idxs set in mask to result, writes all 8 lanes
+SIMD_AVX2 static inline void compressStore(pos_t* result, uint32_t mask,
+                                           __m256i idxs) {
+   _mm256_storeu_si256((__m256i*)result,
+                       _mm256_permutevar8x32_epi32(idxs, compressLanes(mask)));
+}
 
-pos_t selsel_less_int64_t_col_int64_t_val_avx512_impl(pos_t n, pos_t* RES inSel,
-                                                      pos_t* RES result,
-                                                      int64_t* RES param1,
-                                                      int64_t* RES param2) {
+SIMD_AVX2 pos_t sel_less_int32_t_col_int32_t_val_avx2_impl(
+    pos_t n, pos_t* RES result, int32_t* RES param1, int32_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
                  "This implementation only supports sizeof(pos_t) == 4");
-
    uint64_t found = 0;
-   size_t rest = n % 16;
+   size_t rest = n % 8;
+   auto ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
    auto con = *param2;
-   auto consts = _mm512_set1_epi64(con);
-   for (uint64_t i = 0; i < n - rest; i += 16) {
-      __mmask16 l = 0;
-      {
-         auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i));
-         auto in =
-             _mm512_i32gather_epi64(idxs, (const long long int*)param1, 8);
-         __mmask8 less = _mm512_cmplt_epi64_mask(in, consts);
-         l = less;
-      }
-      {
-         auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i + 8));
-         auto in =
-             _mm512_i32gather_epi64(idxs, (const long long int*)param1, 8);
-         __mmask8 less = _mm512_cmplt_epi64_mask(in, consts);
-         l |= less << 8;
-      }
+   auto consts = _mm256_set1_epi32(con);
+   for (uint64_t i = 0; i < n - rest; i += 8) {
+      auto in = _mm256_loadu_si256((const __m256i*)(param1 + i));
+      uint32_t less = _mm256_movemask_ps(
+          _mm256_castsi256_ps(_mm256_cmpgt_epi32(consts, in)));
+      compressStore(result + found, less, ids);
+      found += __builtin_popcount(less);
+      ids = _mm256_add_epi32(ids, _mm256_set1_epi32(8));
+   }
+   for (uint64_t i = n - rest; i < n; ++i)
+      if (param1[i] < con) result[found++] = i;
+   return found;
+}
 
-      _mm512_mask_compressstoreu_epi32(result + found, l,
-                                       _mm512_loadu_si512(inSel + i));
-      found += __builtin_popcount(l);
+SIMD_AVX2 pos_t selsel_greater_equal_int32_t_col_int32_t_val_avx2_impl(
+    pos_t n, pos_t* RES inSel, pos_t* RES result, int32_t* RES param1,
+    int32_t* RES param2) {
+   static_assert(sizeof(pos_t) == 4,
+                 "This implementation only supports sizeof(pos_t) == 4");
+   uint64_t found = 0;
+   size_t rest = n % 8;
+   auto con = *param2;
+   auto consts = _mm256_set1_epi32(con);
+   for (uint64_t i = 0; i < n - rest; i += 8) {
+      auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i));
+      auto in = _mm256_i32gather_epi32((const int*)param1, idxs, 4);
+      uint32_t ge = ~_mm256_movemask_ps(_mm256_castsi256_ps(
+                        _mm256_cmpgt_epi32(consts, in))) &
+                    0xff;
+      compressStore(result + found, ge, idxs);
+      found += __builtin_popcount(ge);
    }
    for (uint64_t i = n - rest; i < n; ++i) {
       const auto idx = inSel[i];
-      if (param1[idx] < con) result[found++] = idx;
+      if (param1[idx] >= con) result[found++] = idx;
    }
    return found;
 }
 
-pos_t selsel_greater_equal_int64_t_col_int64_t_val_avx512_impl(
-    pos_t n, pos_t* RES inSel, pos_t* RES result, int64_t* RES param1,
-    int64_t* RES param2) {
+/// Mask of the 4 lanes of the int64 values at idxs where constant > value, or
+/// value > constant if swap
+template <bool swap>
+SIMD_AVX2 static inline uint32_t greaterLanes(const int64_t* RES param1,
+                                              __m128i idxs, __m256i consts) {
+   auto in = _mm256_i64gather_epi64((const long long int*)param1,
+                                    _mm256_cvtepu32_epi64(idxs), 8);
+   auto greater =
+       swap ? _mm256_cmpgt_epi64(in, consts) : _mm256_cmpgt_epi64(consts, in);
+   return uint32_t(_mm256_movemask_pd(_mm256_castsi256_pd(greater)));
+}
+
+/// Selection of int64 values with selection vector, 8 values at a time in two
+/// gathers. AVX2 only compares for greater: the lanes are the ones where
+/// constant > value, or value > constant if swap, negated if negate.
+template <bool swap, bool negate, template <typename> class Op>
+SIMD_AVX2 pos_t selsel_int64_t_col_int64_t_val_avx2(pos_t n, pos_t* RES inSel,
+                                                    pos_t* RES result,
+                                                    int64_t* RES param1,
+                                                    int64_t* RES param2) {
    static_assert(sizeof(pos_t) == 4,
                  "This implementation only supports sizeof(pos_t) == 4");
-
    uint64_t found = 0;
-   size_t rest = n % 16;
+   size_t rest = n % 8;
    auto con = *param2;
-   auto consts = _mm512_set1_epi64(con);
-   for (uint64_t i = 0; i < n - rest; i += 16) {
-      __mmask16 l;
-      {
-         auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i));
-         auto in =
-             _mm512_i32gather_epi64(idxs, (const long long int*)param1, 8);
-         __mmask8 less = _mm512_cmpge_epi64_mask(in, consts);
-         l = less;
-      }
-      {
-         auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i + 8));
-         auto in =
-             _mm512_i32gather_epi64(idxs, (const long long int*)param1, 8);
-         __mmask16 less = _mm512_cmpge_epi64_mask(in, consts);
-         l |= less << 8;
-      }
-      _mm512_mask_compressstoreu_epi32(result + found, l,
-                                       _mm512_loadu_si512(inSel + i));
-      found += __builtin_popcount(l);
+   auto consts = _mm256_set1_epi64x(con);
+   for (uint64_t i = 0; i < n - rest; i += 8) {
+      auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i));
+      uint32_t mask =
+          greaterLanes<swap>(param1, _mm256_castsi256_si128(idxs), consts) |
+          greaterLanes<swap>(param1, _mm256_extracti128_si256(idxs, 1), consts)
+              << 4;
+      if (negate) mask ^= 0xff;
+      compressStore(result + found, mask, idxs);
+      found += __builtin_popcount(mask);
    }
    for (uint64_t i = n - rest; i < n; ++i) {
       const auto idx = inSel[i];
-      if (param1[idx] >= con) result[found++] = idx;
+      if (Op<int64_t>()(param1[idx], con)) result[found++] = idx;
    }
    return found;
 }
 
-pos_t selsel_less_equal_int64_t_col_int64_t_val_avx512_impl(
-    pos_t n, pos_t* RES inSel, pos_t* RES result, int64_t* RES param1,
-    int64_t* RES param2) {
+F3 sel_less_int32_t_col_int32_t_val_avx2 =
+    (F3)&sel_less_int32_t_col_int32_t_val_avx2_impl;
+F4 selsel_greater_equal_int32_t_col_int32_t_val_avx2 =
+    (F4)&selsel_greater_equal_int32_t_col_int32_t_val_avx2_impl;
+F4 selsel_less_int64_t_col_int64_t_val_avx2 =
+    (F4)&selsel_int64_t_col_int64_t_val_avx2<false, false, less>;
+F4 selsel_greater_equal_int64_t_col_int64_t_val_avx2 =
+    (F4)&selsel_int64_t_col_int64_t_val_avx2<false, true, greater_equal>;
+F4 selsel_less_equal_int64_t_col_int64_t_val_avx2 =
+    (F4)&selsel_int64_t_col_int64_t_val_avx2<true, true, less_equal>;
+
+//------------------------------------------------------------------------------
+// bitmap selections
+
+/// How the SIMD compares evaluate Op: the AVX-512 predicate, for AVX2, which
+/// only compares for equality and greater, whether to compare for equality,
+/// for value > constant instead of constant > value and to negate
+template <template <typename> class Op> struct SimdCompare;
+template <> struct SimdCompare<equal_to> {
+   static constexpr int avx512 = _MM_CMPINT_EQ;
+   static constexpr bool equal = true, swap = false, negate = false;
+};
+template <> struct SimdCompare<less> {
+   static constexpr int avx512 = _MM_CMPINT_LT;
+   static constexpr bool equal = false, swap = false, negate = false;
+};
+template <> struct SimdCompare<greater> {
+   static constexpr int avx512 = _MM_CMPINT_NLE;
+   static constexpr bool equal = false, swap = true, negate = false;
+};
+template <> struct SimdCompare<less_equal> {
+   static constexpr int avx512 = _MM_CMPINT_LE;
+   static constexpr bool equal = false, swap = true, negate = true;
+};
+template <> struct SimdCompare<greater_equal> {
+   static constexpr int avx512 = _MM_CMPINT_NLT;
+   static constexpr bool equal = false, swap = false, negate = true;
+};
+
+pos_t bitmap_to_sel_(pos_t n, pos_t* RES result, uint64_t* RES bitmap) {
+   uint64_t found = 0;
+   forEachSelected(n, bitmap, [&](uint64_t i) { result[found++] = i; });
+   return found;
+}
+
+pos_t sel_to_bitmap_(pos_t n, uint64_t* RES result, pos_t* RES inSel) {
+   if (!n) return 0;
+   const pos_t tuples = inSel[n - 1] + 1;
+   memset(result, 0, bitmapWords(tuples) * sizeof(uint64_t));
+   for (uint64_t i = 0; i < n; ++i)
+      result[inSel[i] / 64] |= uint64_t(1) << (inSel[i] % 64);
+   return tuples;
+}
+F2 sel_to_bitmap = (F2)&sel_to_bitmap_;
+
+template <typename T, template <typename> class Op>
+SIMD_AVX512 static inline uint64_t selectWordAvx512(const T* RES input,
+                                                    __m512i consts) {
+   constexpr auto pred = SimdCompare<Op>::avx512;
+   uint64_t bits = 0;
+   if constexpr (sizeof(T) == 4)
+      for (unsigned k = 0; k < 4; ++k)
+         bits |= uint64_t(_mm512_cmp_epi32_mask(
+                     _mm512_loadu_si512(input + 16 * k), consts, pred))
+                 << (16 * k);
+   else
+      for (unsigned k = 0; k < 8; ++k)
+         bits |= uint64_t(_mm512_cmp_epi64_mask(
+                     _mm512_loadu_si512(input + 8 * k), consts, pred))
+                 << (8 * k);
+   return bits;
+}
+
+/// selbmbm_col_val with 64 compares per word, inBitmap may be null
+template <typename T, template <typename> class Op>
+SIMD_AVX512 pos_t selbmbm_col_val_avx512(pos_t n, uint64_t* RES inBitmap,
+                                         uint64_t* RES result, T* RES param1,
+                                         T* RES param2) {
+   static_assert(sizeof(T) == 4 || sizeof(T) == 8, "32 or 64 bit values only");
+   const auto con = *param2;
+   __m512i consts;
+   if constexpr (sizeof(T) == 4)
+      consts = _mm512_set1_epi32(con);
+   else
+      consts = _mm512_set1_epi64(con);
+   const uint64_t full = n / 64;
+   for (uint64_t w = 0; w < full; ++w) {
+      const auto in = inBitmap ? inBitmap[w] : ~uint64_t(0);
+      result[w] =
+          in ? in & selectWordAvx512<T, Op>(param1 + w * 64, consts) : 0;
+   }
+   if (full < bitmapWords(n))
+      result[full] = (inBitmap ? inBitmap[full] : ~uint64_t(0)) &
+                     selectWord<T, Op>(param1 + full * 64, con, n % 64);
+   return n;
+}
+
+template <typename T, template <typename> class Op>
+SIMD_AVX512 pos_t selbm_col_val_avx512(pos_t n, uint64_t* RES result,
+                                       T* RES param1, T* RES param2) {
+   return selbmbm_col_val_avx512<T, Op>(n, nullptr, result, param1, param2);
+}
+
+SIMD_AVX512 pos_t bitmap_to_sel_avx512(pos_t n, pos_t* RES result,
+                                       uint64_t* RES bitmap) {
    static_assert(sizeof(pos_t) == 4,
                  "This implementation only supports sizeof(pos_t) == 4");
-
    uint64_t found = 0;
-   size_t rest = n % 16;
-   auto con = *param2;
-   auto consts = _mm512_set1_epi64(con);
-   for (uint64_t i = 0; i < n - rest; i += 16) {
-      __mmask16 l = 0;
-
-      {
-         auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i));
-         auto in =
-             _mm512_i32gather_epi64(idxs, (const long long int*)param1, 8);
-         __mmask8 less = _mm512_cmple_epi64_mask(in, consts);
-         l = less;
+   auto ids = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
+                                14, 15);
+   for (uint64_t w = 0; w < bitmapWords(n); ++w) {
+      auto bits = bitmap[w];
+      for (unsigned k = 0; k < 4; ++k) {
+         __mmask16 lanes = bits >> (16 * k);
+         _mm512_mask_compressstoreu_epi32(result + found, lanes, ids);
+         found += __builtin_popcount(lanes);
+         ids = _mm512_add_epi32(ids, _mm512_set1_epi32(16));
       }
+   }
+   return found;
+}
 
-      {
-         auto idxs = _mm256_loadu_si256((const __m256i*)(inSel + i + 8));
-         auto in =
-             _mm512_i32gather_epi64(idxs, (const long long int*)param1, 8);
-         __mmask16 less = _mm512_cmple_epi64_mask(in, consts);
-         l |= less << 8;
+template <typename T, template <typename> class Op>
+SIMD_AVX2 static inline uint64_t selectWordAvx2(const T* RES input,
+                                                __m256i consts) {
+   using C = SimdCompare<Op>;
+   constexpr unsigned lanes = 32 / sizeof(T);
+   uint64_t bits = 0;
+   for (unsigned k = 0; k < 64 / lanes; ++k) {
+      auto in = _mm256_loadu_si256((const __m256i*)(input + lanes * k));
+      uint64_t mask;
+      if constexpr (sizeof(T) == 4) {
+         auto m = C::equal  ? _mm256_cmpeq_epi32(in, consts)
+                  : C::swap ? _mm256_cmpgt_epi32(in, consts)
+                            : _mm256_cmpgt_epi32(consts, in);
+         mask = _mm256_movemask_ps(_mm256_castsi256_ps(m));
+      } else {
+         auto m = C::equal  ? _mm256_cmpeq_epi64(in, consts)
+                  : C::swap ? _mm256_cmpgt_epi64(in, consts)
+                            : _mm256_cmpgt_epi64(consts, in);
+         mask = _mm256_movemask_pd(_mm256_castsi256_pd(m));
       }
+      bits |= mask << (lanes * k);
+   }
+   return C::negate ? ~bits : bits;
+}
 
-      _mm512_mask_compressstoreu_epi32(result + found, l,
-                                       _mm512_loadu_si512(inSel + i));
-      found += __builtin_popcount(l);
+/// selbmbm_col_val with 64 compares per word, inBitmap may be null
+template <typename T, template <typename> class Op>
+SIMD_AVX2 pos_t selbmbm_col_val_avx2(pos_t n, uint64_t* RES inBitmap,
+                                     uint64_t* RES result, T* RES param1,
+                                     T* RES param2) {
+   static_assert(sizeof(T) == 4 || sizeof(T) == 8, "32 or 64 bit values only");
+   const auto con = *param2;
+   __m256i consts;
+   if constexpr (sizeof(T) == 4)
+      consts = _mm256_set1_epi32(con);
+   else
+      consts = _mm256_set1_epi64x(con);
+   const uint64_t full = n / 64;
+   for (uint64_t w = 0; w < full; ++w) {
+      const auto in = inBitmap ? inBitmap[w] : ~uint64_t(0);
+      result[w] = in ? in & selectWordAvx2<T, Op>(param1 + w * 64, consts) : 0;
    }
-   for (uint64_t i = n - rest; i < n; ++i) {
-      const auto idx = inSel[i];
-      if (param1[idx] <= con) result[found++] = idx;
+   if (full < bitmapWords(n))
+      result[full] = (inBitmap ? inBitmap[full] : ~uint64_t(0)) &
+                     selectWord<T, Op>(param1 + full * 64, con, n % 64);
+   return n;
+}
+
+template <typename T, template <typename> class Op>
+SIMD_AVX2 pos_t selbm_col_val_avx2(pos_t n, uint64_t* RES result, T* RES param1,
+                                   T* RES param2) {
+   return selbmbm_col_val_avx2<T, Op>(n, nullptr, result, param1, param2);
+}
+
+SIMD_AVX2 pos_t bitmap_to_sel_avx2(pos_t n, pos_t* RES result,
+                                   uint64_t* RES bitmap) {
+   static_assert(sizeof(pos_t) == 4,
+                 "This implementation only supports sizeof(pos_t) == 4");
+   uint64_t found = 0;
+   const uint64_t full = n / 64;
+   auto ids = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+   for (uint64_t w = 0; w < full; ++w) {
+      auto bits = bitmap[w];
+      // compressStore writes 8 entries, which fit as found <= 64 * w
+      for (unsigned k = 0; k < 8; ++k) {
+         uint32_t lanes = (bits >> (8 * k)) & 0xff;
+         compressStore(result + found, lanes, ids);
+         found += __builtin_popcount(lanes);
+         ids = _mm256_add_epi32(ids, _mm256_set1_epi32(8));
+      }
    }
+   if (full < bitmapWords(n))
+      for (auto bits = bitmap[full]; bits; bits &= bits - 1)
+         result[found++] = full * 64 + __builtin_ctzll(bits);
    return found;
 }
 
-#endif
-
-F3 sel_less_int32_t_col_int32_t_val_avx512 =
-    (F3)&sel_less_int32_t_col_int32_t_val_avx512_impl;
-F4 selsel_greater_equal_int32_t_col_int32_t_val_avx512 =
-    (F4)&selsel_greater_equal_int32_t_col_int32_t_val_avx512_impl;
-F4 selsel_less_int64_t_col_int64_t_val_avx512 =
-    (F4)&selsel_less_int64_t_col_int64_t_val_avx512_impl;
-F4 selsel_greater_equal_int64_t_col_int64_t_val_avx512 =
-    (F4)&selsel_greater_equal_int64_t_col_int64_t_val_avx512_impl;
-F4 selsel_less_equal_int64_t_col_int64_t_val_avx512 =
-    (F4)&selsel_less_equal_int64_t_col_int64_t_val_avx512_impl;
-#endif
+F2 bitmap_to_sel = runtime::cpu::dispatch((F2)&bitmap_to_sel_avx512,
+                                          (F2)&bitmap_to_sel_avx2,
+                                          (F2)&bitmap_to_sel_);
+
+#define MK_SELBM_COLVAL(type, op)                                              \
+   F3 selbm_##op##_##type##_col_##type##_val = (F3)&selbm_col_val<type, op>;
+#define MK_SELBMBM_COLVAL(type, op)                                            \
+   F4 selbmbm_##op##_##type##_col_##type##_val =                               \
+       (F4)&selbmbm_col_val<type, op>;
+#define MK_SELBM_COLVAL_SIMD(type, op)                                         \
+   F3 selbm_##op##_##type##_col_##type##_val = runtime::cpu::dispatch(         \
+       (F3)&selbm_col_val_avx512<type, op>, (F3)&selbm_col_val_avx2<type, op>, \
+       (F3)&selbm_col_val<type, op>);
+#define MK_SELBMBM_COLVAL_SIMD(type, op)                                       \
+   F4 selbmbm_##op##_##type##_col_##type##_val = runtime::cpu::dispatch(       \
+       (F4)&selbmbm_col_val_avx512<type, op>,                                  \
+       (F4)&selbmbm_col_val_avx2<type, op>, (F4)&selbmbm_col_val<type, op>);
+
+#define EACH_TYPE_BM_SCALAR(m, c)                                              \
+   EACH_TYPE_BASIC(m, c) m(int8_t, c) m(int16_t, c)
+#define EACH_TYPE_BM_SIMD(m, c) m(int32_t, c) m(int64_t, c)
+EACH_COMP(EACH_TYPE_BM_SCALAR, MK_SELBM_COLVAL)
+EACH_COMP(EACH_TYPE_BM_SCALAR, MK_SELBMBM_COLVAL)
+EACH_COMP(EACH_TYPE_BM_SIMD, MK_SELBM_COLVAL_SIMD)
+EACH_COMP(EACH_TYPE_BM_SIMD, MK_SELBMBM_COLVAL_SIMD)
 }
 } // namespace vectorwise